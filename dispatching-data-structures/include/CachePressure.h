@@ -0,0 +1,54 @@
+#ifndef PROTOTYPE_CACHEPRESSURE_H
+#define PROTOTYPE_CACHEPRESSURE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "MemoryTracker.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define CACHE_PRESSURE_CLFLUSH 1
+#else
+#define CACHE_PRESSURE_CLFLUSH 0
+#endif
+
+// Working set that evicts everything else when it is touched, larger than the last level cache of current CPUs
+#define CACHE_PRESSURE_THRASH_SIZE (64 * 1024 * 1024)
+
+/**
+ * Models the memory traffic of a monitor between two lookups: analyzers, flow tables and logging evict parts of the
+ * dispatcher from the caches. A CachePressure is a working set of the given size that is written one word per cache
+ * line on every touch(), flush() instead evicts given regions from all cache levels.
+ */
+class CachePressure {
+public:
+    explicit CachePressure(size_t bytes);
+
+    /**
+     * Writes every cache line of the working set once, in the order of a fixed random permutation so the prefetchers
+     * do not hide the misses.
+     */
+    void touch();
+
+    /**
+     * Evicts every cache line of the regions, with clflush where available and otherwise by touching a working set of
+     * CACHE_PRESSURE_THRASH_SIZE.
+     */
+    static void flush(const std::vector<MemoryRegion> &regions);
+
+    [[nodiscard]] size_t getSize() const {
+        return lines.size() * MEMORY_CACHE_LINE_SIZE;
+    }
+
+private:
+    struct alignas(MEMORY_CACHE_LINE_SIZE) Line {
+        uint64_t value;
+    };
+
+    std::unique_ptr<Line[]> buffer;
+    std::vector<uint32_t> lines;
+};
+
+#endif //PROTOTYPE_CACHEPRESSURE_H
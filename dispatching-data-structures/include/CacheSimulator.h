@@ -0,0 +1,126 @@
+#ifndef PROTOTYPE_CACHESIMULATOR_H
+#define PROTOTYPE_CACHESIMULATOR_H
+
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "LatencyHistogram.h"
+#include "MemoryTracker.h"
+#include "dispatchers/LookupTrace.h"
+
+/**
+ * Geometry of one cache or TLB level. Caches hold lines of MEMORY_CACHE_LINE_SIZE, TLBs translations of pages of
+ * MEMORY_PAGE_SIZE.
+ */
+struct CacheLevelConfig {
+    std::string name;
+    size_t entries;
+    size_t associativity;
+
+    /**
+     * Parses "<size>:<ways>", the size is in KiB for caches and in entries for TLBs. Throws std::invalid_argument if
+     * the entries cannot be split into sets of the given ways.
+     */
+    static CacheLevelConfig parse(const std::string &name, const std::string &description, size_t bytesPerUnit);
+};
+
+// Defaults of a current server core: 48 KiB L1D, 2 MiB L2, a 32 MiB slice of L3, 64 entry dTLB and 1536 entry STLB
+struct CacheSimulatorConfig {
+    std::vector<CacheLevelConfig> caches = {
+            {"l1", 48 * 1024 / MEMORY_CACHE_LINE_SIZE, 12},
+            {"l2", 2 * 1024 * 1024 / MEMORY_CACHE_LINE_SIZE, 16},
+            {"l3", 32 * 1024 * 1024 / MEMORY_CACHE_LINE_SIZE, 16}
+    };
+    std::vector<CacheLevelConfig> tlbs = {
+            {"dtlb", 64, 4},
+            {"stlb", 1536, 12}
+    };
+};
+
+/**
+ * Set associative cache with LRU replacement over block numbers, a line or a page.
+ */
+class SetAssociativeCache {
+public:
+    explicit SetAssociativeCache(const CacheLevelConfig &config);
+
+    // Returns whether the block was cached, a missing block replaces the least recently used one of its set
+    bool access(uint64_t block);
+
+private:
+    size_t sets;
+    size_t associativity;
+    uint64_t time = 0;
+    // Block and time of its last access per way, sets are consecutive
+    std::vector<uint64_t> blocks;
+    std::vector<uint64_t> lastUse;
+};
+
+/**
+ * Deterministic replacement for hardware counters: replays the loads of traced lookups (see IDispatcher::traceLookup)
+ * through a hierarchy of set associative caches and TLBs. Every line is looked up level by level and filled into
+ * every level it missed, every page in the dTLB and then the STLB. Pages are numbered in the order of their first
+ * access, so address space randomization does not change the sets and the results are the same on every run.
+ *
+ * Per lookup, it reports the loads, the distinct lines, the dependent load depth (the longest chain of loads that
+ * each need the value of the previous one), the misses of every level and the reuse distance of the lines (the
+ * distinct lines accessed since the last access to the same line, the LRU stack distance).
+ */
+class CacheSimulator {
+public:
+    explicit CacheSimulator(const CacheSimulatorConfig &config = CacheSimulatorConfig());
+
+    // Replays the loads of one lookup
+    void simulate(const LookupTrace &trace);
+
+    // Clears the statistics but keeps the caches, e.g. after warming them up
+    void resetStatistics();
+
+    [[nodiscard]] uint64_t getLookups() const {
+        return lookups;
+    }
+
+    // Names of the values, the miss columns are named after the levels
+    [[nodiscard]] std::vector<std::string> getNames() const;
+
+    // Averages per lookup in the order of getNames(), except for the reuse distance percentiles
+    [[nodiscard]] std::vector<double> getValues() const;
+
+private:
+    std::vector<std::string> cacheNames;
+    std::vector<std::string> tlbNames;
+    std::vector<SetAssociativeCache> caches;
+    std::vector<SetAssociativeCache> tlbs;
+    std::unordered_map<uint64_t, uint64_t> pages;
+
+    // Reuse distances: the time of the last access of every line and a Fenwick tree over the times that marks the
+    // last access of each line, the distinct lines between two times are the marks in between. The times are
+    // renumbered when the tree is full, it holds about twice the distinct lines
+    std::unordered_map<uint64_t, uint64_t> lastAccess;
+    std::vector<uint32_t> tree;
+    uint64_t time = 0;
+
+    uint64_t lookups = 0;
+    uint64_t accesses = 0;
+    uint64_t lines = 0;
+    uint64_t depth = 0;
+    uint64_t coldLines = 0;
+    std::vector<uint64_t> cacheMisses;
+    std::vector<uint64_t> tlbMisses;
+    LatencyHistogram reuseDistances;
+    double reuseDistanceSum = 0;
+
+    // Line number in the address space of the renumbered pages
+    uint64_t lineOf(uintptr_t address);
+    void accessLine(uint64_t line);
+    void accessPage(uint64_t page);
+    uint64_t reuseDistance(uint64_t line);
+    void compactTimes();
+
+    void mark(uint64_t index, int delta);
+    [[nodiscard]] uint64_t marksUntil(uint64_t index) const;
+};
+
+#endif //PROTOTYPE_CACHESIMULATOR_H
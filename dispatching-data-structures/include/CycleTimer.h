@@ -0,0 +1,88 @@
+#ifndef PROTOTYPE_CYCLETIMER_H
+#define PROTOTYPE_CYCLETIMER_H
+
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define CYCLE_TIMER_TSC 1
+#else
+#define CYCLE_TIMER_TSC 0
+#endif
+
+/**
+ * Timestamps for intervals as short as a single lookup, read from the time stamp counter. start() waits for all earlier
+ * instructions before it reads the counter, stop() reads it with rdtscp after the timed instructions and keeps later
+ * ones from starting early (Paoloni, "How to Benchmark Code Execution Times on Intel IA-32 and IA-64", 2010). Without a
+ * TSC, the steady clock is read instead and a tick is a nanosecond.
+ *
+ * calibrate() has to be called once before ticks are converted or corrected for the overhead of the timer itself.
+ */
+class CycleTimer {
+public:
+    static inline uint64_t start() {
+#if CYCLE_TIMER_TSC
+        _mm_lfence();
+        uint64_t ticks = __rdtsc();
+        _mm_lfence();
+        return ticks;
+#else
+        return steadyNanoseconds();
+#endif
+    }
+
+    static inline uint64_t stop() {
+#if CYCLE_TIMER_TSC
+        unsigned int processor;
+        uint64_t ticks = __rdtscp(&processor);
+        _mm_lfence();
+        return ticks;
+#else
+        return steadyNanoseconds();
+#endif
+    }
+
+    // Unserialized read for instrumentation that stays enabled, neighbouring instructions may move across it
+    static inline uint64_t now() {
+#if CYCLE_TIMER_TSC
+        return __rdtsc();
+#else
+        return steadyNanoseconds();
+#endif
+    }
+
+    // Ticks between start() and stop() without the overhead of an empty interval
+    static inline uint64_t elapsed(uint64_t startTicks, uint64_t stopTicks) {
+        uint64_t ticks = stopTicks - startTicks;
+        return ticks > overhead ? ticks - overhead : 0;
+    }
+
+    /**
+     * Measures the overhead as the smallest empty interval, and the ticks per nanosecond against the steady clock.
+     */
+    static void calibrate();
+
+    static double toNanoseconds(uint64_t ticks) {
+        return ticks / ticksPerNanosecond;
+    }
+
+    [[nodiscard]] static uint64_t getOverhead() {
+        return overhead;
+    }
+
+    [[nodiscard]] static double getTicksPerNanosecond() {
+        return ticksPerNanosecond;
+    }
+
+private:
+    static uint64_t overhead;
+    static double ticksPerNanosecond;
+
+    static inline uint64_t steadyNanoseconds() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+};
+
+#endif //PROTOTYPE_CYCLETIMER_H
@@ -16,6 +16,11 @@
 
 using Value = std::pair<identifier_t, IAnalyzer*>;
 
+// Returns the analyzer if the condition holds and nullptr otherwise, with a mask instead of a branch
+inline IAnalyzer *maskAnalyzer(bool condition, IAnalyzer *analyzer) {
+    return reinterpret_cast<IAnalyzer *>(reinterpret_cast<uintptr_t>(analyzer) & -static_cast<uintptr_t>(condition));
+}
+
 #if DEBUG > 0
 #include <iostream>
 #include <iomanip>
@@ -0,0 +1,25 @@
+#ifndef PROTOTYPE_FLOWHASH_H
+#define PROTOTYPE_FLOWHASH_H
+
+#include "PacketBatch.h"
+
+/**
+ * Receive side scaling (RSS) hash of raw frames, used to distribute packets to workers by flow. It is the Toeplitz
+ * hash of NICs over the IP addresses and, for TCP and UDP, the ports, computed with the key 0x6d5a repeated. That key
+ * makes the hash symmetric, both directions of a connection end up at the same worker.
+ */
+class FlowHash {
+public:
+    /**
+     * Hashes the flow of an Ethernet frame. Fragments of IP packets are hashed by their addresses only, frames that
+     * are not IP over Ethernet hash to 0, like on NICs.
+     *
+     * @param linkLayer Identifier of the link layer of the frame
+     */
+    [[nodiscard]] static uint32_t hash(const ArrayView<uint8_t> &frame, identifier_t linkLayer);
+
+    // Toeplitz hash of an arbitrary input with the repeated key
+    [[nodiscard]] static uint32_t toeplitz(const uint8_t *input, size_t length);
+};
+
+#endif //PROTOTYPE_FLOWHASH_H
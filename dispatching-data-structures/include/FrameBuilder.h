@@ -0,0 +1,48 @@
+#ifndef PROTOTYPE_FRAMEBUILDER_H
+#define PROTOTYPE_FRAMEBUILDER_H
+
+#include <vector>
+
+#include "PacketBatch.h"
+
+/**
+ * Turns the precomputed identifier chains of a trace back into raw frames, so analyzers can find the next identifier
+ * by parsing headers (see IAnalyzer::parse). The identifiers are encoded as the fields that name the next layer:
+ * Ethernet carries the ethertype, IPv4 and IPv6 the protocol, TCP and UDP end the chain. The source address and port
+ * are derived from the packet number, so every packet is a flow of its own and the frames spread over the workers of
+ * a Pipeline, unless the flows of the packets are given. Every other header field is filled with plausible constants.
+ */
+class FrameBuilder {
+public:
+    /**
+     * Builds the frames of all packets. Each packet of the result has the identifier of its link layer as the only
+     * identifier and the frame as payload. A chain is only encoded up to the first identifier that is no supported
+     * protocol, and chains that do not start with Ethernet are not encoded at all.
+     */
+    [[nodiscard]] static PacketBatch build(const PacketBatch &packets);
+
+    /**
+     * Builds the frames of all packets like build(packets), but derives the source address and port from the given
+     * flow of every packet instead of its number.
+     */
+    [[nodiscard]] static PacketBatch build(const PacketBatch &packets, const std::vector<uint32_t> &flows);
+
+    /**
+     * Builds the frame of a single packet: the headers of its chain followed by its payload.
+     *
+     * @return Number of identifiers that are encoded in the frame
+     */
+    static size_t build(const PacketView &packet, std::vector<uint8_t> &frame);
+    static size_t build(const PacketView &packet, std::vector<uint8_t> &frame, uint32_t flow);
+
+private:
+    static void appendEthernet(std::vector<uint8_t> &frame, uint16_t ethertype);
+    static void appendIPv4(std::vector<uint8_t> &frame, uint8_t protocol, uint32_t flow);
+    static void appendIPv6(std::vector<uint8_t> &frame, uint8_t nextHeader, uint32_t flow);
+    static void appendTCP(std::vector<uint8_t> &frame, uint32_t flow);
+    static void appendUDP(std::vector<uint8_t> &frame, uint32_t flow);
+    static uint16_t sourcePort(uint32_t flow);
+    static void storeBigEndian16(std::vector<uint8_t> &frame, size_t position, size_t value);
+};
+
+#endif //PROTOTYPE_FRAMEBUILDER_H
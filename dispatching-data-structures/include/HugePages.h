@@ -0,0 +1,110 @@
+#ifndef PROTOTYPE_HUGEPAGES_H
+#define PROTOTYPE_HUGEPAGES_H
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <vector>
+
+#define HUGE_PAGE_SIZE (2 * 1024 * 1024)
+
+// Allocations from this size on follow the page policy, smaller ones always stay on the heap
+#define HUGE_PAGES_MIN_BYTES (64 * 1024)
+
+enum class PagePolicy {
+    SMALL,       // The heap, i.e. 4 KiB pages unless the kernel backs the heap with transparent huge pages by itself
+    TRANSPARENT, // 2 MiB aligned mappings advised with MADV_HUGEPAGE, the kernel backs them with huge pages if it can
+    EXPLICIT     // MAP_HUGETLB mappings from the reserved huge pages, falling back to TRANSPARENT if there are none
+};
+
+// Bytes of a group of mappings of HugePages by backing
+struct HugePageUsage {
+    size_t explicitBytes = 0;
+    size_t transparentBytes = 0;
+    // Of the transparent bytes, the ones the kernel actually backs with huge pages
+    size_t transparentHugeBytes = 0;
+    // Mappings the kernel refused to advise, on small pages
+    size_t smallBytes = 0;
+};
+
+/**
+ * Allocation policy for large tables and trace columns: with a huge page policy, every allocation of at least
+ * HUGE_PAGES_MIN_BYTES gets its own mapping backed by 2 MiB pages, so a random lookup into it needs one TLB entry
+ * instead of one per 4 KiB. The policy only applies to allocations made while it is set, the backing of every mapping
+ * and the fallbacks are kept for report().
+ */
+class HugePages {
+public:
+    static void setPolicy(PagePolicy policy);
+    static PagePolicy getPolicy();
+
+    // Parses "small", "thp" or "explicit", throws std::invalid_argument otherwise
+    static PagePolicy parsePolicy(const std::string &name);
+
+    /**
+     * Allocates with the current policy, on the heap for small allocations. Throws std::bad_alloc if neither the
+     * policy nor its fallbacks get memory.
+     */
+    static void *allocate(size_t bytes);
+
+    // Frees memory of allocate() of the same size, whatever the policy was at the time
+    static void deallocate(void *address, size_t bytes);
+
+    // Checks if the memory is a mapping of allocate() instead of a heap allocation
+    static bool owns(const void *address);
+
+    // Number of mappings made so far, for usage() of the ones made from now on
+    static uint64_t serial();
+
+    /**
+     * The live mappings made from the given serial on and the one that starts at the given address (e.g. an object
+     * allocated before by a class-level operator new), with the huge pages from /proc/self/smaps.
+     */
+    static HugePageUsage usage(uint64_t since, const void *address = nullptr);
+
+    /**
+     * Prints the live mappings per backing with the bytes the kernel actually backs with huge pages (AnonHugePages of
+     * /proc/self/smaps for transparent ones) and the fallbacks so far.
+     */
+    static void report(std::ostream &os);
+};
+
+/**
+ * std::allocator that allocates through HugePages, see huge_vector.
+ */
+template<class T>
+class HugePageAllocator {
+public:
+    using value_type = T;
+
+    HugePageAllocator() = default;
+
+    template<class U>
+    HugePageAllocator(const HugePageAllocator<U> &) {
+    }
+
+    T *allocate(size_t count) {
+        return static_cast<T *>(HugePages::allocate(count * sizeof(T)));
+    }
+
+    void deallocate(T *pointer, size_t count) {
+        HugePages::deallocate(pointer, count * sizeof(T));
+    }
+
+    template<class U>
+    bool operator==(const HugePageAllocator<U> &) const {
+        return true;
+    }
+
+    template<class U>
+    bool operator!=(const HugePageAllocator<U> &) const {
+        return false;
+    }
+};
+
+template<class T>
+using huge_vector = std::vector<T, HugePageAllocator<T>>;
+
+#endif //PROTOTYPE_HUGEPAGES_H
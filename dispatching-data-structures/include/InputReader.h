@@ -3,22 +3,29 @@
 
 #include "Defines.h"
 #include "MyPacket.h"
+#include "PacketBatch.h"
+#include "PcapReader.h"
 #include "analyzers/IAnalyzer.h"
+#include "analyzers/AnalyzerArena.h"
 
 #include <string>
 #include <map>
 
-#define ANALYZER_EMPLACE(identifier, analyzer, target) \
-    target.emplace(std::make_pair(identifier, MAKE_ANALYZER_BUILDER(analyzer)));
+#define ANALYZER_EMPLACE(identifier, analyzer, target, arena) \
+    if (arena == nullptr) { \
+        target.emplace(std::make_pair(identifier, MAKE_ANALYZER_BUILDER(analyzer))); \
+    } else { \
+        target.emplace(std::make_pair(identifier, MAKE_ARENA_ANALYZER_BUILDER(arena, analyzer))); \
+    }
 
-#define ANALYZER_IF(identifier, input, analyzer, target) \
+#define ANALYZER_IF(identifier, input, analyzer, target, arena) \
     if (input == #analyzer) { \
-        ANALYZER_EMPLACE(identifier, analyzer, target) \
+        ANALYZER_EMPLACE(identifier, analyzer, target, arena) \
     }
 
-#define ANALYZER_ELIF(identifier, input, analyzer, target)  \
+#define ANALYZER_ELIF(identifier, input, analyzer, target, arena)  \
     else if (input == #analyzer) { \
-        ANALYZER_EMPLACE(identifier, analyzer, target) \
+        ANALYZER_EMPLACE(identifier, analyzer, target, arena) \
     }
 
 #define ANALYZER_ELSE(input, line) \
@@ -29,22 +36,45 @@
 enum FileType {
     PCAP,
     CUSTOM_PACKET_FORMAT,
+    BINARY_TRACE,
     ANALYZER,
     UNKNOWN
 };
 
 class InputReader {
 public:
-    [[nodiscard]] static std::vector<MyPacket> readPacketFile(const std::string &path);
+    /**
+     * Reads a packet file into a columnar PacketBatch. Binary trace files (see TraceFile) are mapped instead of parsed.
+     * Paths of the form "generate:<description>" generate a synthetic trace (see TraceGeneratorConfig).
+     */
+    [[nodiscard]] static PacketBatch readPacketFile(const std::string &path);
     [[nodiscard]] static std::map<identifier_t, analyzer_builder> readAnalyzerFile(const std::string &path);
 
+    /**
+     * Reads a packet file as raw frames for IAnalyzer::parse. Every packet has the identifier of its link layer as the
+     * only identifier and the whole frame as payload. Captures keep their frames, the chains of traces are encoded
+     * with FrameBuilder.
+     */
+    [[nodiscard]] static PacketBatch readFrames(const std::string &path);
+
+    /**
+     * Reads an analyzer file like readAnalyzerFile(path), but the builders place the analyzers into the given arena
+     * instead of allocating each of them on the heap. The arena has to outlive all dispatchers using the builders.
+     */
+    [[nodiscard]] static std::map<identifier_t, analyzer_builder> readAnalyzerFile(const std::string &path, AnalyzerArena &arena);
+
 private:
+    friend class TraceStream;
+
     static FileType getFileType(const std::string &path);
     template <class T>
     static identifier_t extractWiFiTypeSubtypeIdentifier(T* pdu);
-    [[nodiscard]] static std::vector<MyPacket> readPCAP(const std::string &path, const std::string &writeToFile="");
-    [[nodiscard]] static std::vector<MyPacket> readCustomFileFormat(const std::string &path);
+    [[nodiscard]] static PacketBatch readPCAP(const std::string &path);
+    static void addPcapRecord(PacketBatch &packets, const PcapRecord &record, std::vector<identifier_t> &identifiers);
+    static size_t dissect(uint32_t linkType, const uint8_t *data, size_t length, std::vector<identifier_t> &identifiers);
+    [[nodiscard]] static PacketBatch readCustomFileFormat(const std::string &path);
     [[nodiscard]] static identifier_t parseIdentifier(const std::string &field, size_t currentLineNum);
+    [[nodiscard]] static std::map<identifier_t, analyzer_builder> readAnalyzerFile(const std::string &path, AnalyzerArena *arena);
 };
 
 
@@ -0,0 +1,53 @@
+#ifndef PROTOTYPE_LATENCYHISTOGRAM_H
+#define PROTOTYPE_LATENCYHISTOGRAM_H
+
+#include <cstdint>
+#include <vector>
+
+// Every power of two is split into 2^LATENCY_HISTOGRAM_SUB_BITS buckets, a relative error of at most 1/32
+#define LATENCY_HISTOGRAM_SUB_BITS 5
+#define LATENCY_HISTOGRAM_SUB_COUNT (uint64_t(1u) << LATENCY_HISTOGRAM_SUB_BITS)
+
+/**
+ * Log-linear histogram of latencies like HdrHistogram: values below LATENCY_HISTOGRAM_SUB_COUNT are counted exactly,
+ * larger ones in buckets whose width grows with the power of two they fall into. Recording is a few instructions, so
+ * it can run between timed lookups, and the memory is fixed for the whole 64 bit range.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+
+    void record(uint64_t value) {
+        counts[indexOf(value)]++;
+        count++;
+        max = value > max ? value : max;
+    }
+
+    void merge(const LatencyHistogram &other);
+
+    /**
+     * Smallest value that at least the given fraction of all values does not exceed, as the highest value of its
+     * bucket. Returns 0 for an empty histogram.
+     *
+     * @param fraction Fraction in [0, 1], e.g. 0.99 for the 99th percentile
+     */
+    [[nodiscard]] uint64_t percentile(double fraction) const;
+
+    [[nodiscard]] uint64_t getCount() const {
+        return count;
+    }
+
+    [[nodiscard]] uint64_t getMax() const {
+        return max;
+    }
+
+private:
+    std::vector<uint64_t> counts;
+    uint64_t count = 0;
+    uint64_t max = 0;
+
+    static size_t indexOf(uint64_t value);
+    static uint64_t highestOf(size_t index);
+};
+
+#endif //PROTOTYPE_LATENCYHISTOGRAM_H
@@ -0,0 +1,44 @@
+#ifndef PROTOTYPE_MAPPEDFILE_H
+#define PROTOTYPE_MAPPEDFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Size of the largest folio the kernel maps for a file at once
+#define MAPPED_FILE_RELEASE_OVERLAP (2u << 20u)
+
+/**
+ * Maps a whole file read-only into memory. Pages are only loaded when they are touched for the first time.
+ */
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    [[nodiscard]] const uint8_t *data() const {
+        return address;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return length;
+    }
+
+    /**
+     * Drops the pages of a range that was consumed from memory. They are read from the file again if touched later,
+     * the page that contains the end of the range is kept.
+     *
+     * @param first Start of the consumed data the range belongs to (e.g. a column of a trace file), pages that also
+     *              hold bytes in front of it are kept
+     */
+    void release(size_t offset, size_t size, size_t first = 0) const;
+
+private:
+    const uint8_t *address = nullptr;
+    size_t length = 0;
+};
+
+#endif //PROTOTYPE_MAPPEDFILE_H
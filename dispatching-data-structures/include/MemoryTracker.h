@@ -0,0 +1,131 @@
+#ifndef PROTOTYPE_MEMORYTRACKER_H
+#define PROTOTYPE_MEMORYTRACKER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <unordered_map>
+#include <vector>
+
+// Granularities for the distinct cache lines and pages a data structure occupies
+#define MEMORY_CACHE_LINE_SIZE 64
+#define MEMORY_PAGE_SIZE 4096
+
+enum class MemoryCategory : uint8_t {
+    TABLE,     // Arrays of slots or buckets the lookups index into
+    METADATA,  // Auxiliary arrays and keys that are not slots
+    NODES,     // Single element nodes of node based containers
+    ANALYZERS  // Analyzer objects created by the builders
+};
+
+// Memory the tracker does not allocate itself, e.g. tables inside the dispatcher object or of a C library
+struct MemoryRegion {
+    MemoryCategory category;
+    const void *address;
+    size_t bytes;
+    // The region was returned by malloc, so its allocator overhead is counted
+    bool heap;
+};
+
+/**
+ * Bytes of one data structure by category. Everything except allocatorOverhead is the size that was requested; the
+ * overhead is what malloc adds per allocation (header and rounding up), which dominates for small nodes.
+ */
+struct MemoryUsage {
+    size_t table = 0;
+    size_t metadata = 0;
+    size_t nodes = 0;
+    size_t allocatorOverhead = 0;
+    size_t analyzers = 0;
+    size_t allocations = 0;
+    // Distinct cache lines and pages that contain at least one byte of the structure or its analyzers
+    size_t cacheLines = 0;
+    size_t pages = 0;
+
+    [[nodiscard]] size_t total() const {
+        return table + metadata + nodes + allocatorOverhead + analyzers;
+    }
+
+    friend std::ostream &operator<<(std::ostream &os, const MemoryUsage &usage);
+};
+
+/**
+ * Records the live allocations of one data structure, see TrackingAllocator for containers and trackAnalyzer for
+ * analyzer builders. Only used while building a structure, lookups never touch it. Tracking is off unless enabled
+ * before the structure is created (see setEnabled), so it does not skew the startup times.
+ */
+class MemoryTracker {
+public:
+    MemoryTracker() = default;
+    MemoryTracker(const MemoryTracker &) = delete;
+    MemoryTracker &operator=(const MemoryTracker &) = delete;
+
+    /**
+     * Whether dispatchers created from now on attach their tracker to their containers and analyzer builders. Off by
+     * default; the memory report, the cache simulation and eviction need it and turn it on before creating them.
+     */
+    static void setEnabled(bool enabled);
+    static bool isEnabled();
+
+    void allocate(MemoryCategory category, const void *address, size_t bytes, bool heap = true) {
+        allocations[address] = MemoryRegion{category, address, bytes, heap};
+    }
+
+    // Unknown addresses are ignored, e.g. analyzers that were built without an active tracker
+    void deallocate(const void *address) {
+        allocations.erase(address);
+    }
+
+    /**
+     * Sums the live allocations and the given regions.
+     */
+    [[nodiscard]] MemoryUsage usage(const std::vector<MemoryRegion> &regions = {}) const;
+
+    /**
+     * The largest live allocation of the category, nullptr if there is none.
+     */
+    [[nodiscard]] const MemoryRegion *find(MemoryCategory category) const;
+
+    /**
+     * The live allocations followed by the given regions.
+     */
+    [[nodiscard]] std::vector<MemoryRegion> regions(const std::vector<MemoryRegion> &regions = {}) const;
+
+    /**
+     * Makes the tracker the target of trackAnalyzer on the current thread while the scope lives. Dispatchers open a
+     * scope around every analyzer builder they call.
+     */
+    class Scope {
+    public:
+        explicit Scope(MemoryTracker &tracker) : previous(active) {
+            active = &tracker;
+        }
+
+        ~Scope() {
+            active = previous;
+        }
+
+        Scope(const Scope &) = delete;
+        Scope &operator=(const Scope &) = delete;
+
+    private:
+        MemoryTracker *previous;
+    };
+
+    // Records an analyzer created by a builder in the tracker of the current scope, if there is one
+    template<class T>
+    static T *trackAnalyzer(T *analyzer, size_t bytes, bool heap = true) {
+        if (active != nullptr) {
+            active->allocate(MemoryCategory::ANALYZERS, analyzer, bytes, heap);
+        }
+        return analyzer;
+    }
+
+private:
+    static bool enabled;
+    static thread_local MemoryTracker *active;
+
+    std::unordered_map<const void *, MemoryRegion> allocations;
+};
+
+#endif //PROTOTYPE_MEMORYTRACKER_H
@@ -1,6 +1,7 @@
 #ifndef PROTOTYPE_MYPACKET_H
 #define PROTOTYPE_MYPACKET_H
 
+#include <atomic>
 #include <cstdint>
 #include <utility>
 #include <vector>
@@ -12,10 +13,10 @@ using identifier_t = uint16_t;
 
 class MyPacket {
 public:
-    MyPacket() : number(++objCount) {
+    MyPacket() : number(nextNumber()) {
     }
 
-    explicit MyPacket(std::vector<uint8_t> payload) : number(++objCount), payload(std::move(payload)) {
+    explicit MyPacket(std::vector<uint8_t> payload) : number(nextNumber()), payload(std::move(payload)) {
     }
 
     [[nodiscard]] static size_t getMaxIdentifierSize();
@@ -35,10 +36,15 @@ public:
     friend std::ostream& operator<<(std::ostream &os, const MyPacket &packet);
 
 private:
-    static size_t objCount;
+    // Packets may be created by several threads at once (see scalingBenchmarkMain.cpp)
+    static std::atomic<size_t> objCount;
     size_t number;
     std::vector<identifier_t> identifiers;
     std::vector<uint8_t> payload;
+
+    static size_t nextNumber() {
+        return objCount.fetch_add(1, std::memory_order_relaxed) + 1;
+    }
 };
 
 
@@ -0,0 +1,266 @@
+#ifndef PROTOTYPE_PACKETBATCH_H
+#define PROTOTYPE_PACKETBATCH_H
+
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <vector>
+
+#include "HugePages.h"
+#include "MyPacket.h"
+
+class MappedFile;
+
+/**
+ * Read-only view of a contiguous range of elements, used to hand out parts of a PacketBatch without copying.
+ */
+template<class T>
+class ArrayView {
+public:
+    ArrayView() = default;
+    ArrayView(const T *data, size_t size) : begin_(data), size_(size) {
+    }
+
+    [[nodiscard]] const T *data() const {
+        return begin_;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return size_;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size_ == 0;
+    }
+
+    const T &operator[](size_t index) const {
+        return begin_[index];
+    }
+
+    [[nodiscard]] const T *begin() const {
+        return begin_;
+    }
+
+    [[nodiscard]] const T *end() const {
+        return begin_ + size_;
+    }
+
+private:
+    const T *begin_ = nullptr;
+    size_t size_ = 0;
+};
+
+/**
+ * A single packet inside a PacketBatch. Only valid as long as the batch is neither modified nor destroyed.
+ */
+class PacketView {
+public:
+    PacketView(uint32_t number, ArrayView<identifier_t> identifiers, ArrayView<uint8_t> payload)
+            : number(number), identifiers(identifiers), payload(payload) {
+    }
+
+    [[nodiscard]] uint32_t getNumber() const {
+        return number;
+    }
+
+    [[nodiscard]] const ArrayView<identifier_t> &getIdentifiers() const {
+        return identifiers;
+    }
+
+    [[nodiscard]] const ArrayView<uint8_t> &getPayload() const {
+        return payload;
+    }
+
+private:
+    uint32_t number;
+    ArrayView<identifier_t> identifiers;
+    ArrayView<uint8_t> payload;
+};
+
+/**
+ * Structure-of-arrays representation of a trace. The identifiers of all packets are stored in one flat array and all
+ * payloads in one contiguous arena, a packet is only described by its offsets into both. Compared to a
+ * std::vector<MyPacket>, this needs two allocations in total instead of two per packet and lets the benchmarks walk
+ * the trace linearly. A batch is either built with add() or maps the columns of a binary trace file (see TraceFile)
+ * without copying them.
+ */
+class PacketBatch {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = PacketView;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = PacketView;
+
+        const_iterator(const PacketBatch *batch, size_t index) : batch(batch), index(index) {
+        }
+
+        PacketView operator*() const {
+            return (*batch)[index];
+        }
+
+        const_iterator &operator++() {
+            index++;
+            return *this;
+        }
+
+        bool operator==(const const_iterator &other) const {
+            return index == other.index;
+        }
+
+        bool operator!=(const const_iterator &other) const {
+            return index != other.index;
+        }
+
+    private:
+        const PacketBatch *batch;
+        size_t index;
+    };
+
+    PacketBatch() : identifierOffsets{0}, payloadOffsets{0} {
+        updateColumns();
+    }
+
+    PacketBatch(const PacketBatch &other);
+    PacketBatch(PacketBatch &&other) noexcept;
+    PacketBatch &operator=(const PacketBatch &other);
+    PacketBatch &operator=(PacketBatch &&other) noexcept;
+
+    void reserve(size_t packetCount, size_t identifierCount, size_t payloadSize);
+
+    // Releases the capacity reserved for further packets
+    void shrinkToFit();
+
+    /**
+     * Appends a packet. Not possible for a batch that maps a trace file.
+     */
+    void add(const identifier_t *packetIdentifiers, size_t identifierCount, const uint8_t *payload, size_t payloadSize);
+    void add(const MyPacket &packet);
+
+    // Appends all packets of another batch
+    void append(const PacketBatch &other);
+
+    void clear();
+
+    // Number of packets in the batch
+    [[nodiscard]] size_t size() const {
+        return packetCount;
+    }
+
+    [[nodiscard]] bool empty() const {
+        return size() == 0;
+    }
+
+    // Number of identifiers of all packets
+    [[nodiscard]] size_t identifierCount() const {
+        return columns.identifierOffsets[packetCount];
+    }
+
+    // Number of payload bytes of all packets
+    [[nodiscard]] size_t payloadSize() const {
+        return columns.payloadOffsets[packetCount];
+    }
+
+    // Identifiers of all packets in trace order
+    [[nodiscard]] ArrayView<identifier_t> getIdentifiers() const {
+        return {columns.identifiers, identifierCount()};
+    }
+
+    // Number of bytes allocated (or mapped) by the batch
+    [[nodiscard]] size_t bytes() const;
+
+    /**
+     * Drops the parts of a mapped trace file that only hold the packets [begin, end) from memory, for reading a trace
+     * that does not fit into memory front to back. Nothing happens for a batch that owns its columns.
+     */
+    void release(size_t begin, size_t end) const;
+
+    // Checks if the batch maps a trace file instead of owning its columns
+    [[nodiscard]] bool isMapped() const {
+        return mapping != nullptr;
+    }
+
+    // Checks if the batch has a dictionary of the distinct protocol stacks, only binary trace files can contain one
+    [[nodiscard]] bool hasStacks() const {
+        return columns.packetStacks != nullptr;
+    }
+
+    // Number of distinct protocol stacks in the dictionary
+    [[nodiscard]] size_t stackCount() const {
+        return stackTotal;
+    }
+
+    // Identifiers of a protocol stack from the dictionary
+    [[nodiscard]] ArrayView<identifier_t> getStack(size_t stack) const {
+        return {
+                columns.stackIdentifiers + columns.stackOffsets[stack],
+                columns.stackOffsets[stack + 1] - columns.stackOffsets[stack]
+        };
+    }
+
+    // Index of the protocol stack of a packet in the dictionary
+    [[nodiscard]] uint32_t getStackIndex(size_t index) const {
+        return columns.packetStacks[index];
+    }
+
+    PacketView operator[](size_t index) const {
+        return {
+                static_cast<uint32_t>(index + 1),
+                {
+                        columns.identifiers + columns.identifierOffsets[index],
+                        columns.identifierOffsets[index + 1] - columns.identifierOffsets[index]
+                },
+                {
+                        columns.payloads + columns.payloadOffsets[index],
+                        static_cast<size_t>(columns.payloadOffsets[index + 1] - columns.payloadOffsets[index])
+                }
+        };
+    }
+
+    [[nodiscard]] const_iterator begin() const {
+        return {this, 0};
+    }
+
+    [[nodiscard]] const_iterator end() const {
+        return {this, size()};
+    }
+
+private:
+    friend class TraceFile;
+
+    // Read-only columns, either pointing into the vectors below or into a mapped trace file
+    struct Columns {
+        // Both offset arrays hold one more entry than packets, packet i spans [offsets[i], offsets[i + 1])
+        const uint32_t *identifierOffsets;
+        const uint64_t *payloadOffsets;
+        const identifier_t *identifiers;
+        const uint8_t *payloads;
+
+        // Optional stack dictionary, same layout as the packets, plus the stack index of every packet
+        const uint32_t *stackOffsets;
+        const identifier_t *stackIdentifiers;
+        const uint32_t *packetStacks;
+    };
+
+    Columns columns{};
+    size_t packetCount = 0;
+    size_t stackTotal = 0;
+
+    // Owned storage of a batch that was built with add(), large columns follow the page policy of HugePages
+    huge_vector<uint32_t> identifierOffsets;
+    huge_vector<uint64_t> payloadOffsets;
+    huge_vector<identifier_t> identifiers;
+    huge_vector<uint8_t> payloads;
+
+    // Keeps the trace file mapped as long as any copy of the batch uses it
+    std::shared_ptr<const MappedFile> mapping;
+
+    PacketBatch(std::shared_ptr<const MappedFile> mapping, const Columns &columns, size_t packetCount, size_t stackCount);
+
+    void updateColumns();
+};
+
+#endif //PROTOTYPE_PACKETBATCH_H
@@ -0,0 +1,61 @@
+#ifndef PROTOTYPE_PCAPREADER_H
+#define PROTOTYPE_PCAPREADER_H
+
+#include <string>
+#include <vector>
+
+#include "MappedFile.h"
+
+#define PCAP_MAGIC 0xA1B2C3D4
+#define PCAP_MAGIC_NANOSECONDS 0xA1B23C4D
+#define PCAPNG_SECTION_HEADER 0x0A0D0D0A
+#define PCAPNG_BYTE_ORDER_MAGIC 0x1A2B3C4D
+
+struct PcapRecord {
+    uint32_t linkType;
+    const uint8_t *data;
+    uint32_t capturedLength;
+};
+
+/**
+ * Iterates over the packets of a pcap or pcapng file without copying them. The file is mapped, every record points
+ * into the mapping and stays valid as long as the reader. A truncated record at the end of the file ends the iteration.
+ */
+class PcapReader {
+public:
+    explicit PcapReader(const std::string &path);
+
+    /**
+     * Moves to the next packet.
+     *
+     * @return false, iff there are no more packets
+     */
+    bool next(PcapRecord &record);
+
+    // Drops the records before the current position from memory
+    void release();
+
+    // Checks if the file starts with the magic of a pcap or pcapng file
+    [[nodiscard]] static bool isPcapFile(const std::string &path);
+
+private:
+    MappedFile file;
+    size_t position = 0;
+    size_t released = 0;
+    bool pcapng = false;
+
+    // Both formats may be written in either byte order
+    bool swapped = false;
+
+    // pcap has one link type per file, pcapng one per interface of the current section
+    uint32_t linkType = 0;
+    std::vector<uint32_t> interfaceLinkTypes;
+
+    bool nextPcap(PcapRecord &record);
+    bool nextPcapng(PcapRecord &record);
+
+    [[nodiscard]] uint16_t load16(size_t offset) const;
+    [[nodiscard]] uint32_t load32(size_t offset) const;
+};
+
+#endif //PROTOTYPE_PCAPREADER_H
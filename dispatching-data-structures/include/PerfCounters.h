@@ -0,0 +1,74 @@
+#ifndef PROTOTYPE_PERFCOUNTERS_H
+#define PROTOTYPE_PERFCOUNTERS_H
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * Performance counters of the calling thread on top of perf_event_open, read as one group so all values cover the same
+ * instructions. Counts cycles, instructions, branch misses, L1D, LLC and dTLB read misses. Hardware events the CPU or
+ * the hypervisor does not provide are left out; if none is available, the software events task clock, page faults and
+ * context switches are counted instead. If the kernel schedules the group only part of the time, the values are
+ * scaled up to the whole time.
+ */
+class PerfCounters {
+public:
+    /**
+     * Opens the events, throws std::runtime_error if not even the software events can be opened (see
+     * /proc/sys/kernel/perf_event_paranoid).
+     */
+    PerfCounters();
+    ~PerfCounters();
+
+    PerfCounters(const PerfCounters &) = delete;
+    PerfCounters &operator=(const PerfCounters &) = delete;
+
+    // Resets and enables all counters
+    void start();
+
+    // Disables all counters and reads them into getValues()
+    void stop();
+
+    // Disables and re-enables all counters without resetting or reading them, to leave out work between start and stop
+    void pause();
+    void resume();
+
+    [[nodiscard]] const std::vector<std::string> &getNames() const {
+        return names;
+    }
+
+    // Values of the last start() and stop(), in the order of getNames()
+    [[nodiscard]] const std::vector<uint64_t> &getValues() const {
+        return values;
+    }
+
+    [[nodiscard]] bool hasHardwareEvents() const {
+        return hardware;
+    }
+
+private:
+    struct Event {
+        const char *name;
+        uint32_t type;
+        uint64_t config;
+    };
+
+    std::vector<int> descriptors;
+    std::vector<std::string> names;
+    std::vector<uint64_t> values;
+    bool hardware = false;
+
+    // Opens the events that are available as one group, returns the number of opened events
+    size_t openGroup(const std::vector<Event> &events);
+
+    // Drops events from the end until the kernel can schedule the group at all
+    void shrinkToSchedulable();
+
+    void closeAll();
+
+    // Reads the group and scales the values to the time the group was enabled, returns false if it never ran
+    bool readGroup();
+};
+
+#endif //PROTOTYPE_PERFCOUNTERS_H
@@ -0,0 +1,129 @@
+#ifndef PROTOTYPE_PIPELINE_H
+#define PROTOTYPE_PIPELINE_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "dispatchers/IDispatcher.h"
+#include "PacketBatch.h"
+#include "SpscRing.h"
+#include "WorkStealingDeque.h"
+
+// Size of the RSS indirection table that maps flow hashes to workers
+#define PIPELINE_INDIRECTION_SIZE 128
+
+struct PipelineConfig {
+    size_t workerCount = 1;
+    size_t ringSize = 1024;  // Frames per ring
+    size_t batchSize = 32;   // Frames per enqueue and dequeue
+    bool drop = false;       // Drop frames when a ring is full instead of waiting for the worker
+    bool pin = false;        // Pin the reader to core 0 and worker i to core i + 1
+    bool steal = false;      // Let idle workers steal batches from busy ones
+    bool ordered = true;     // Steal mode only: keep the frames of a flow in order
+};
+
+// Counters of one pipeline stage. Times are in nanoseconds.
+struct alignas(SpscRing<uint32_t>::CACHE_LINE_SIZE) StageStatistics {
+    uint64_t frames = 0;
+    uint64_t lookups = 0;
+    uint64_t time = 0;       // Time from the start of the pipeline until the stage finished
+    uint64_t busyTime = 0;   // Reader: time spent hashing and enqueuing, worker: time spent dispatching
+    uint64_t stallTime = 0;  // Reader only: time spent waiting for full rings
+    uint64_t drops = 0;      // Reader only: frames dropped because of full rings
+    uint64_t stolen = 0;     // Worker only: frames of batches stolen from other workers
+
+    // Worker only: ring occupancy sampled at every dequeue, in batches in steal mode
+    uint64_t occupancySum = 0;
+    uint64_t occupancySamples = 0;
+    uint64_t maxOccupancy = 0;
+};
+
+/**
+ * Packet pipeline like a deployed monitor: one reader stage distributes raw frames by their symmetric flow hash (see
+ * FlowHash) to the workers, each of which dispatches the frames with its own dispatcher and analyzers like
+ * BM_parse. The stages are connected by one SpscRing per worker that carries the indices of the frames.
+ *
+ * In steal mode the reader groups the frames by their entry of the indirection table and enqueues whole batches.
+ * Every worker moves the batches of its ring into a WorkStealingDeque, from which idle workers steal. A stolen batch
+ * is dispatched with the dispatcher and analyzers of the thief. If the pipeline is ordered, every batch carries a
+ * sequence number within its indirection entry, and a batch is only dispatched after its predecessor, so the frames
+ * of a flow stay in order.
+ */
+class Pipeline {
+public:
+    using dispatcher_factory = std::function<std::unique_ptr<IDispatcher>()>;
+
+    Pipeline(const PipelineConfig &config, const dispatcher_factory &makeDispatcher,
+             const std::map<identifier_t, analyzer_builder> &analyzerBuilders);
+    ~Pipeline();
+
+    Pipeline(const Pipeline &) = delete;
+    Pipeline &operator=(const Pipeline &) = delete;
+
+    /**
+     * Runs all frames through the pipeline and waits until every worker is done. The statistics are reset first.
+     *
+     * @return Time from the start of the reader until the last worker finished in nanoseconds
+     */
+    uint64_t run(const PacketBatch &frames);
+
+    [[nodiscard]] const StageStatistics &getReaderStatistics() const {
+        return readerStatistics;
+    }
+
+    [[nodiscard]] const std::vector<StageStatistics> &getWorkerStatistics() const {
+        return workerStatistics;
+    }
+
+private:
+    const PipelineConfig config;
+    std::vector<std::unique_ptr<IDispatcher>> dispatchers;
+    std::vector<std::unique_ptr<SpscRing<uint32_t>>> rings;
+    size_t indirection[PIPELINE_INDIRECTION_SIZE];
+
+    // Steal mode: frames of a batch are stored at slots[firstSlot, firstSlot + count)
+    struct Batch {
+        uint32_t bucket;
+        uint32_t sequence;
+        uint32_t count;
+        size_t firstSlot;
+    };
+
+    // Steal mode: number of dispatched batches of an indirection entry
+    struct alignas(SpscRing<uint32_t>::CACHE_LINE_SIZE) BucketState {
+        std::atomic<uint32_t> completed{0};
+    };
+
+    std::vector<std::unique_ptr<WorkStealingDeque<uint32_t>>> deques;
+    std::vector<Batch> batches;
+    std::vector<uint32_t> slots;
+    std::unique_ptr<BucketState[]> buckets;
+
+    // Steal mode: batches enqueued by the reader, valid once it finished, and batches dispatched by the workers
+    size_t batchCount = 0;
+    std::atomic<size_t> completedBatches{0};
+
+    StageStatistics readerStatistics;
+    std::vector<StageStatistics> workerStatistics;
+
+    std::chrono::steady_clock::time_point start;
+
+    // Set by the reader after it enqueued the last frame
+    std::atomic<bool> finished{false};
+
+    void read(const PacketBatch &frames);
+    void work(size_t worker, const PacketBatch &frames);
+    void readBatches(const PacketBatch &frames);
+    void workStealing(size_t worker, const PacketBatch &frames);
+    size_t bucketOf(const PacketView &frame) const;
+
+    // Dispatches a frame starting with its link layer, returns the number of lookups
+    static size_t dispatch(IDispatcher &dispatcher, const PacketView &frame);
+    static void pin(size_t core);
+};
+
+#endif //PROTOTYPE_PIPELINE_H
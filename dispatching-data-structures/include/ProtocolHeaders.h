@@ -0,0 +1,135 @@
+#ifndef PROTOTYPE_PROTOCOLHEADERS_H
+#define PROTOTYPE_PROTOCOLHEADERS_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Link types of pcap and pcapng files
+#define LINKTYPE_ETHERNET 1
+#define LINKTYPE_IEEE802_11 105
+#define LINKTYPE_IEEE802_11_RADIOTAP 127
+
+// Identifiers of the link layers, these are not contained in the packets themselves
+#define IDENTIFIER_ETHERNET 0x1
+#define IDENTIFIER_IEEE802_11 0x69
+#define IDENTIFIER_RADIOTAP 0x7f
+
+#define ETHERTYPE_MIN 0x0600 // Smaller values are an 802.3 length field
+#define ETHERTYPE_IPV4 0x0800
+#define ETHERTYPE_VLAN 0x8100
+#define ETHERTYPE_IPV6 0x86DD
+#define ETHERTYPE_PPPOE_SESSION 0x8864
+#define ETHERTYPE_QINQ 0x88A8
+
+#define PPP_IPV4 0x0021
+#define PPP_IPV6 0x0057
+
+#define IP_PROTOCOL_HOP_BY_HOP 0
+#define IP_PROTOCOL_IPV4 4
+#define IP_PROTOCOL_TCP 6
+#define IP_PROTOCOL_UDP 17
+#define IP_PROTOCOL_IPV6 41
+#define IP_PROTOCOL_ROUTING 43
+#define IP_PROTOCOL_FRAGMENT 44
+#define IP_PROTOCOL_AUTHENTICATION 51
+#define IP_PROTOCOL_NO_NEXT_HEADER 59
+#define IP_PROTOCOL_DESTINATION_OPTIONS 60
+#define IP_PROTOCOL_MOBILITY 135
+#define IP_PROTOCOL_HIP 139
+#define IP_PROTOCOL_SHIM6 140
+
+#define ETHERNET_HEADER_SIZE 14
+#define VLAN_HEADER_SIZE 4
+#define PPPOE_HEADER_SIZE 6
+#define PPP_HEADER_SIZE 2
+#define IPV4_MIN_HEADER_SIZE 20
+#define IPV6_HEADER_SIZE 40
+#define IPV6_EXTENSION_MIN_SIZE 8
+#define TCP_MIN_HEADER_SIZE 20
+#define UDP_HEADER_SIZE 8
+#define RADIOTAP_MIN_HEADER_SIZE 8
+#define DOT11_DATA_HEADER_SIZE 24
+#define LLC_SNAP_HEADER_SIZE 8
+
+#define DOT11_TYPE_MANAGEMENT 0
+#define DOT11_TYPE_DATA 2
+
+// Data subtypes without a frame body, which libtins did not report
+#define DOT11_DATA_NULL 0x24
+#define DOT11_QOS_DATA_NULL 0x2c
+
+// Protocol fields are in network byte order and might not be aligned
+inline uint16_t loadBigEndian16(const uint8_t *data) {
+    return static_cast<uint16_t>(data[0] << 8u | data[1]);
+}
+
+inline uint16_t loadLittleEndian16(const uint8_t *data) {
+    return static_cast<uint16_t>(data[1] << 8u | data[0]);
+}
+
+inline bool isIPv6ExtensionHeader(uint8_t protocol) {
+    switch (protocol) {
+        case IP_PROTOCOL_HOP_BY_HOP:
+        case IP_PROTOCOL_ROUTING:
+        case IP_PROTOCOL_FRAGMENT:
+        case IP_PROTOCOL_AUTHENTICATION:
+        case IP_PROTOCOL_DESTINATION_OPTIONS:
+        case IP_PROTOCOL_MOBILITY:
+        case IP_PROTOCOL_HIP:
+        case IP_PROTOCOL_SHIM6:
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Length of an IPv6 extension header, the length field is counted in different units by the fragment and AH headers
+inline size_t ipv6ExtensionHeaderLength(uint8_t protocol, const uint8_t *header) {
+    switch (protocol) {
+        case IP_PROTOCOL_FRAGMENT:
+            return IPV6_EXTENSION_MIN_SIZE;
+        case IP_PROTOCOL_AUTHENTICATION:
+            return (header[1] + 2) * 4;
+        default:
+            return (header[1] + 1) * 8;
+    }
+}
+
+/**
+ * Frame control field of an 802.11 frame.
+ */
+class Dot11FrameControl {
+public:
+    explicit Dot11FrameControl(const uint8_t *frame) : first(frame[0]), flags(frame[1]) {
+    }
+
+    [[nodiscard]] uint8_t type() const {
+        return (first >> 2u) & 0x3u;
+    }
+
+    [[nodiscard]] uint8_t subtype() const {
+        return first >> 4u;
+    }
+
+    [[nodiscard]] bool toDS() const {
+        return flags & 0x01u;
+    }
+
+    [[nodiscard]] bool fromDS() const {
+        return flags & 0x02u;
+    }
+
+    [[nodiscard]] bool isProtected() const {
+        return flags & 0x40u;
+    }
+
+    [[nodiscard]] bool order() const {
+        return flags & 0x80u;
+    }
+
+private:
+    uint8_t first;
+    uint8_t flags;
+};
+
+#endif //PROTOTYPE_PROTOCOLHEADERS_H
@@ -0,0 +1,96 @@
+#ifndef PROTOTYPE_SPSCRING_H
+#define PROTOTYPE_SPSCRING_H
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+/**
+ * Lock-free ring buffer between exactly one producer and one consumer thread. Items are enqueued and dequeued in
+ * batches, so the indices are only published once per batch. The producer and the consumer index live in separate
+ * cache lines, each next to the cached copy of the other index, so both threads only touch the line of the other
+ * side when their cached copy says that the ring is full or empty.
+ */
+template<class T>
+class SpscRing {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // The capacity is rounded up to the next power of two
+    explicit SpscRing(size_t capacity) : mask(roundUp(capacity) - 1), slots(mask + 1) {
+    }
+
+    SpscRing(const SpscRing &) = delete;
+    SpscRing &operator=(const SpscRing &) = delete;
+
+    /**
+     * Enqueues up to count items, only called by the producer.
+     *
+     * @return Number of enqueued items, less than count if the ring is full
+     */
+    size_t push(const T *items, size_t count) {
+        size_t tail = producer.index.load(std::memory_order_relaxed);
+        if (capacity() - (tail - producer.cachedOther) < count) {
+            producer.cachedOther = consumer.index.load(std::memory_order_acquire);
+        }
+
+        count = std::min(count, capacity() - (tail - producer.cachedOther));
+        for (size_t i = 0; i < count; i++) {
+            slots[(tail + i) & mask] = items[i];
+        }
+        producer.index.store(tail + count, std::memory_order_release);
+        return count;
+    }
+
+    /**
+     * Dequeues up to count items, only called by the consumer.
+     *
+     * @return Number of dequeued items, 0 if the ring is empty
+     */
+    size_t pop(T *items, size_t count) {
+        size_t head = consumer.index.load(std::memory_order_relaxed);
+        if (consumer.cachedOther - head < count) {
+            consumer.cachedOther = producer.index.load(std::memory_order_acquire);
+        }
+
+        count = std::min(count, consumer.cachedOther - head);
+        for (size_t i = 0; i < count; i++) {
+            items[i] = slots[(head + i) & mask];
+        }
+        consumer.index.store(head + count, std::memory_order_release);
+        return count;
+    }
+
+    // Number of items in the ring, only a snapshot if the other side is running
+    [[nodiscard]] size_t size() const {
+        size_t head = consumer.index.load(std::memory_order_acquire);
+        return producer.index.load(std::memory_order_acquire) - head;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    // Index of one side and its cached copy of the index of the other side
+    struct alignas(CACHE_LINE_SIZE) Side {
+        std::atomic<size_t> index{0};
+        size_t cachedOther = 0;
+    };
+
+    Side producer;
+    Side consumer;
+    alignas(CACHE_LINE_SIZE) const size_t mask;
+    std::vector<T> slots;
+
+    static size_t roundUp(size_t capacity) {
+        size_t result = 1;
+        while (result < capacity) {
+            result <<= 1u;
+        }
+        return result;
+    }
+};
+
+#endif //PROTOTYPE_SPSCRING_H
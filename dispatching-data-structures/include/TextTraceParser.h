@@ -0,0 +1,53 @@
+#ifndef PROTOTYPE_TEXTTRACEPARSER_H
+#define PROTOTYPE_TEXTTRACEPARSER_H
+
+#include <string>
+#include <vector>
+
+#include "PacketBatch.h"
+
+// Chunks smaller than this are not worth an additional thread
+#define TEXT_TRACE_MIN_CHUNK_SIZE (1u << 20u)
+
+/**
+ * Parser for the custom text trace format ("# PACKETS", then one packet per line: hex identifiers followed by the hex
+ * payload). The file is mapped and split into chunks at line boundaries, which are parsed in parallel without
+ * allocating per token. Errors report the line number in the file, like the sequential parser did.
+ */
+class TextTraceParser {
+public:
+    /**
+     * Parses a text trace.
+     *
+     * @param threadCount Maximum number of threads, 0 uses all available cores
+     */
+    [[nodiscard]] static PacketBatch parse(const std::string &path, size_t threadCount = 0);
+
+    /**
+     * Decodes a string of hex digits into bytes. An odd trailing digit is decoded as its own byte.
+     *
+     * @return false, iff the string contains something other than hex digits
+     */
+    static bool decodeHex(const char *begin, const char *end, std::vector<uint8_t> &target);
+
+private:
+    friend class TraceStream;
+
+    struct Chunk {
+        const char *begin;
+        const char *end;
+        PacketBatch packets;
+        size_t lineCount = 0;
+
+        // Only set if parsing the chunk failed, the line is relative to the start of the chunk
+        bool failed = false;
+        size_t errorLine = 0;
+        std::string error;
+    };
+
+    static void parseChunk(Chunk &chunk);
+    static bool parseLine(const char *begin, const char *end, std::vector<std::pair<const char *, const char *>> &fields,
+                          std::vector<identifier_t> &identifiers, std::vector<uint8_t> &payload, std::string &error);
+};
+
+#endif //PROTOTYPE_TEXTTRACEPARSER_H
@@ -1,28 +1,139 @@
 #ifndef PROTOTYPE_TIMING_H
 #define PROTOTYPE_TIMING_H
 
+#include <atomic>
+#include <cstdint>
+#include <ostream>
 #include <string>
+#include <vector>
 
+#include "CycleTimer.h"
+
+// Number of distinct timers, every thread that records has one slot per timer
+#define TIMING_MAX_TIMERS 64
+
+#define TIMING_CONCAT_(a, b) a##b
+#define TIMING_CONCAT(a, b) TIMING_CONCAT_(a, b)
+
+// Times the rest of the enclosing scope under the given name, the timer is registered on the first pass only
+#define TIMING_SCOPE(name) \
+    static const Timing::TimerId TIMING_CONCAT(timingId, __LINE__) = Timing::registerTimer(name); \
+    Timing::ScopedTimer TIMING_CONCAT(timingScope, __LINE__)(TIMING_CONCAT(timingId, __LINE__))
+
+/**
+ * Instrumentation that is cheap enough to run around a dispatch. Timers are registered once by name and referred to by
+ * their id afterwards. The scoped timers only measure while enabled (see setEnabled), otherwise they cost a branch. Every thread accumulates its measurements in its own slots, so recording takes
+ * a TSC read and a few stores without locks or shared cache lines. Reports sum the slots of all threads, including
+ * the ones that already exited, while the timers keep running.
+ */
 namespace Timing {
-    std::string fmtTime(uint64_t time);
+    using TimerId = uint32_t;
+
+    struct TimerSlot {
+        // Only the owning thread writes, so relaxed loads and stores suffice and readers never see torn values
+        std::atomic<uint64_t> count{0};
+        std::atomic<uint64_t> ticks{0};
+        std::atomic<uint64_t> minTicks{UINT64_MAX};
+        std::atomic<uint64_t> maxTicks{0};
+        std::atomic<double> squares{0};
+    };
+
+    struct alignas(64) ThreadTimers {
+        TimerSlot slots[TIMING_MAX_TIMERS];
+    };
+
+    struct TimerSummary {
+        std::string name;
+        uint64_t count = 0;
+        // All times in nanoseconds
+        double total = 0;
+        double mean = 0;
+        double stddev = 0;
+        double min = 0;
+        double max = 0;
+    };
+
+    /**
+     * Returns the id of the timer with the given name, registering it first if there is none yet.
+     *
+     * @throws std::runtime_error if TIMING_MAX_TIMERS timers are registered already
+     */
+    TimerId registerTimer(const std::string &name);
 
-    void startTM(const std::string &identifier);
+    // Slots of the calling thread, attached to the registry on first use
+    ThreadTimers &attachThread();
 
-    void endTM(const std::string &identifier);
+    // Off by default, set before the threads that record start
+    inline bool enabled = false;
 
-    void printAllTM();
+    inline void setEnabled(bool value) {
+        enabled = value;
+    }
 
-    void printAllTMRelative(const std::string &identifier);
+    inline bool isEnabled() {
+        return enabled;
+    }
 
-    void printAllTMAvg();
+    // Constant initialized in the header, so accesses need no TLS wrapper call
+    inline thread_local ThreadTimers *localTimers = nullptr;
 
-    void printAllTMAvgRelative(const std::string &identifier);
+    inline void record(TimerId id, uint64_t ticks) {
+        ThreadTimers *timers = localTimers != nullptr ? localTimers : &attachThread();
+        TimerSlot &slot = timers->slots[id];
+        slot.count.store(slot.count.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        slot.ticks.store(slot.ticks.load(std::memory_order_relaxed) + ticks, std::memory_order_relaxed);
+        if (ticks < slot.minTicks.load(std::memory_order_relaxed)) {
+            slot.minTicks.store(ticks, std::memory_order_relaxed);
+        }
+        if (ticks > slot.maxTicks.load(std::memory_order_relaxed)) {
+            slot.maxTicks.store(ticks, std::memory_order_relaxed);
+        }
+        auto value = static_cast<double>(ticks);
+        slot.squares.store(slot.squares.load(std::memory_order_relaxed) + value * value, std::memory_order_relaxed);
+    }
 
-    void printAllTMOPS();
+    class ScopedTimer {
+    public:
+        explicit ScopedTimer(TimerId id) : id(id), active(enabled), startTicks(active ? CycleTimer::now() : 0) {
+        }
 
-    void printAllTMOPSRelative(const std::string &identifier);
+        ~ScopedTimer() {
+            if (active) {
+                record(id, CycleTimer::now() - startTicks);
+            }
+        }
 
+        ScopedTimer(const ScopedTimer &) = delete;
+        ScopedTimer &operator=(const ScopedTimer &) = delete;
+
+    private:
+        TimerId id;
+        bool active;
+        uint64_t startTicks;
+    };
+
+    /**
+     * Sums the slots of all threads per timer. Timers without measurements are left out.
+     */
+    std::vector<TimerSummary> snapshot();
+
+    /**
+     * Clears all measurements and drops the slots of exited threads. Measurements that run concurrently may survive.
+     */
+    void reset();
+
+    std::string fmtTime(uint64_t time);
+    // Keeps the fraction of times below 10 µs, e.g. the mean of a timer
+    std::string fmtTime(double time);
+
+    // Total time, time per operation and operations per second of every timer
+    void print(std::ostream &os);
+
+    // Writes benchmark_<name>.csv with one row per timer
     void toCSV(const std::string &name);
+
+    // Writes benchmark_<name>.json with one object per timer
+    void toJSON(const std::string &name);
 }
 
 #endif //PROTOTYPE_TIMING_H
@@ -0,0 +1,72 @@
+#ifndef PROTOTYPE_TRACEFILE_H
+#define PROTOTYPE_TRACEFILE_H
+
+#include <string>
+
+#include "PacketBatch.h"
+
+#define TRACE_FILE_MAGIC "DDSTRACE"
+#define TRACE_FILE_MAGIC_SIZE 8
+#define TRACE_FILE_VERSION 1
+
+// Every section starts at a multiple of this, so the mapped columns are properly aligned
+#define TRACE_FILE_ALIGNMENT 64
+
+// Set in TraceFileHeader::flags if the file contains the stack dictionary
+#define TRACE_FILE_FLAG_STACKS 0x1
+
+/**
+ * Header at the start of a binary trace file. All values are stored in host byte order. Packet i spans
+ * [identifierOffsets[i], identifierOffsets[i + 1]) of the identifiers and [payloadOffsets[i], payloadOffsets[i + 1])
+ * of the payloads. The optional dictionary stores every distinct protocol stack once, in the same layout, plus the
+ * index of the stack of every packet.
+ */
+struct TraceFileHeader {
+    char magic[TRACE_FILE_MAGIC_SIZE];
+    uint32_t version;
+    uint16_t identifierSize;
+    uint16_t flags;
+
+    uint64_t packetCount;
+    uint64_t identifierCount;
+    uint64_t payloadSize;
+    uint64_t stackCount;
+    uint64_t stackIdentifierCount;
+
+    // Position of every section in bytes from the start of the file
+    uint64_t identifierOffsetsPosition; // uint32_t[packetCount + 1]
+    uint64_t payloadOffsetsPosition;    // uint64_t[packetCount + 1]
+    uint64_t identifiersPosition;       // identifier_t[identifierCount]
+    uint64_t payloadsPosition;          // uint8_t[payloadSize]
+    uint64_t stackOffsetsPosition;      // uint32_t[stackCount + 1]
+    uint64_t stackIdentifiersPosition;  // identifier_t[stackIdentifierCount]
+    uint64_t packetStacksPosition;      // uint32_t[packetCount]
+};
+
+/**
+ * Versioned binary trace format. Reading maps the file and hands out its columns without copying or parsing them,
+ * so loading a trace only costs the page faults of the parts that are actually touched.
+ */
+class TraceFile {
+public:
+    /**
+     * Writes the batch to a binary trace file.
+     *
+     * @param withStacks Also writes the dictionary of the distinct protocol stacks
+     */
+    static void write(const std::string &path, const PacketBatch &batch, bool withStacks);
+
+    /**
+     * Maps a binary trace file. Only the header and the section bounds are validated, the content is trusted.
+     */
+    [[nodiscard]] static PacketBatch read(const std::string &path);
+
+    // Checks if the file starts with the magic of a binary trace file
+    [[nodiscard]] static bool isTraceFile(const std::string &path);
+
+private:
+    static uint64_t align(uint64_t position);
+    static void checkSection(uint64_t position, uint64_t length, uint64_t fileSize, const std::string &name);
+};
+
+#endif //PROTOTYPE_TRACEFILE_H
@@ -0,0 +1,126 @@
+#ifndef PROTOTYPE_TRACEGENERATOR_H
+#define PROTOTYPE_TRACEGENERATOR_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include "PacketBatch.h"
+
+// Packet files with this prefix are generated by TraceGenerator instead of being read (see InputReader)
+#define TRACE_GENERATOR_PREFIX "generate:"
+
+// Protocol stacks are cut at this depth when the Markov model learns them
+#define TRACE_GENERATOR_MAX_DEPTH 32
+
+enum class TraceModel {
+    UNIFORM, // Every layer is an identifier drawn uniformly
+    ZIPF,    // Every layer is an identifier drawn from a Zipf distribution
+    MARKOV   // Stacks are walks of a Markov chain learned from a trace
+};
+
+/**
+ * Parameters of a synthetic trace. Described as "<model>:<key>=<value>,...", e.g. "zipf:pdus=1000000,s=1.2,burst=4".
+ * Keys (defaults in brackets):
+ *   pdus      Number of PDUs, the last packet may exceed it [10000000]
+ *   layers    PDUs per packet for uniform and zipf [3]
+ *   ids       Number of distinct identifiers for uniform and zipf [10000]
+ *   max       Identifiers are drawn from [0, max) [0x10000]
+ *   from      Analyzer file, its identifiers are used instead of random ones
+ *   hits      Fraction of the PDUs for uniform and zipf that use these identifiers, the others are uniformly drawn
+ *             identifiers in [0, max) outside of them [1]
+ *   s         Exponent of the Zipf distribution [1.0]
+ *   learn     Packet file the Markov model learns the transitions between identifiers from
+ *   burst     Mean number of consecutive packets with the same stack [1]
+ *   locality  Probability that a burst reuses the stack of one of the last bursts [0]
+ *   window    Number of last bursts considered for locality [64]
+ *   payload   Payload bytes per packet [1]
+ *   flows     Number of flows, every flow keeps the stack of its first burst [0, every packet is a flow of its own]
+ *   elephants Number of heavy hitter flows among them [0]
+ *   share     Fraction of the bursts that belong to the heavy hitters [0.5]
+ *   seed      Seed of the generator [0x3183b0361f7d45ab]
+ */
+struct TraceGeneratorConfig {
+    TraceModel model = TraceModel::ZIPF;
+    size_t pduCount = 10000000;
+    size_t layerCount = 3;
+    size_t identifierCount = 10000;
+    size_t maxIdentifier = 0x10000;
+    std::string analyzerFile;
+    // Identifiers used instead of random ones or the ones of analyzerFile, can only be set in code
+    std::vector<identifier_t> fromIdentifiers;
+    double hitRatio = 1.0;
+    double exponent = 1.0;
+    std::string learnFile;
+    double burstLength = 1.0;
+    double locality = 0.0;
+    size_t window = 64;
+    size_t payloadSize = 1;
+    size_t flowCount = 0;
+    size_t elephantCount = 0;
+    double elephantShare = 0.5;
+    uint64_t seed = 0x3183b0361f7d45abull;
+
+    static TraceGeneratorConfig parse(const std::string &description);
+};
+
+/**
+ * Generates synthetic traces with skewed identifier popularity, realistic protocol stacks and temporal locality.
+ * Uses its own random number generator and distributions instead of the ones of the standard library, so equal
+ * configurations generate equal traces.
+ */
+class TraceGenerator {
+public:
+    explicit TraceGenerator(const TraceGeneratorConfig &config);
+
+    /**
+     * Generates a trace.
+     *
+     * @param flows If given, receives the flow of every packet (see FrameBuilder)
+     */
+    [[nodiscard]] PacketBatch generate(std::vector<uint32_t> *flows = nullptr);
+
+    /**
+     * Learns the transitions between consecutive identifiers of all packets. A state is an identifier together with
+     * its depth in the stack, so an identifier that is used by protocols on different layers does not mix their
+     * successors. Every chain starts in MARKOV_START and ends with MARKOV_END.
+     */
+    void learn(const PacketBatch &packets);
+
+private:
+    static constexpr int32_t MARKOV_START = -1;
+    static constexpr int32_t MARKOV_END = -2;
+
+    // Depth in the stack and the identifier on it
+    using MarkovState = std::pair<size_t, int32_t>;
+
+    // Possible successors of a state with their cumulative counts
+    struct Transitions {
+        std::vector<int32_t> next;
+        std::vector<uint64_t> cumulativeCounts;
+    };
+
+    const TraceGeneratorConfig config;
+
+    // Identifier of every popularity rank and the cumulative distribution over the ranks
+    std::vector<identifier_t> identifiers;
+    std::vector<double> cumulativeProbabilities;
+
+    // Identifiers in [0, max) that are not selected, drawn for the PDUs that should miss
+    std::vector<identifier_t> missIdentifiers;
+
+    std::map<MarkovState, Transitions> transitions;
+
+    // xoshiro256** state
+    uint64_t state[4];
+
+    void selectIdentifiers();
+    void drawStack(std::vector<identifier_t> &stack);
+    uint32_t drawFlow();
+
+    uint64_t nextRandom();
+    double nextDouble();
+    uint64_t nextBelow(uint64_t bound);
+};
+
+#endif //PROTOTYPE_TRACEGENERATOR_H
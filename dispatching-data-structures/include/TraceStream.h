@@ -0,0 +1,104 @@
+#ifndef PROTOTYPE_TRACESTREAM_H
+#define PROTOTYPE_TRACESTREAM_H
+
+#include <condition_variable>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "PacketBatch.h"
+
+// Packets per chunk if no chunk size is given
+#define TRACE_STREAM_DEFAULT_CHUNK_SIZE (1u << 16u)
+
+class MappedFile;
+class PcapReader;
+
+/**
+ * Reads a packet file in chunks of a fixed number of packets instead of loading it completely. A background thread
+ * fills one of two buffers while the caller processes the other one, so reading the file overlaps with dispatching.
+ * Consumed parts of the file are dropped from memory, so the memory usage is bounded by the two chunks no matter how
+ * large the file is. All packet file types of InputReader are supported.
+ */
+class TraceStream {
+public:
+    explicit TraceStream(const std::string &path, size_t chunkSize = TRACE_STREAM_DEFAULT_CHUNK_SIZE);
+    ~TraceStream();
+
+    TraceStream(const TraceStream &) = delete;
+    TraceStream &operator=(const TraceStream &) = delete;
+
+    /**
+     * Waits for the next chunk. The previous chunk is handed back to the reader and must not be used anymore.
+     * Errors of the reader are rethrown here.
+     *
+     * @return nullptr, iff the file is exhausted
+     */
+    const PacketBatch *next();
+
+    // Nanoseconds the reader needed to fill the current chunk
+    [[nodiscard]] uint64_t getReadTime() const {
+        return buffers[current].readTime;
+    }
+
+    // Nanoseconds next() waited for the current chunk, 0 if reading was completely hidden behind processing
+    [[nodiscard]] uint64_t getWaitTime() const {
+        return waitTime;
+    }
+
+private:
+    struct Buffer {
+        PacketBatch packets;
+        uint64_t readTime = 0;
+        bool ready = false;
+    };
+
+    enum class Source {
+        TEXT,
+        BINARY,
+        PCAP
+    };
+
+    const size_t chunkSize;
+    Source source;
+
+    // State of the source, only used by the reader thread
+    std::unique_ptr<MappedFile> textFile;
+    size_t textPosition = 0;
+    size_t textReleased = 0;
+    size_t lineNumber = 1;
+    PacketBatch binaryTrace;
+    size_t binaryPosition = 0;
+    std::unique_ptr<PcapReader> pcapReader;
+
+    // Reused for every packet, so reading does not allocate per packet
+    std::vector<std::pair<const char *, const char *>> fields;
+    std::vector<identifier_t> identifiers;
+    std::vector<uint8_t> payload;
+
+    // Protected by the mutex
+    Buffer buffers[2];
+    bool finished = false;
+    bool stopped = false;
+    std::exception_ptr error;
+    std::mutex mutex;
+    std::condition_variable changed;
+
+    // Buffer handed out by next(), the reader fills the other one
+    size_t current = 1;
+    bool started = false;
+    uint64_t waitTime = 0;
+
+    std::thread reader;
+
+    void read();
+    void fill(PacketBatch &packets);
+    void fillText(PacketBatch &packets);
+    void fillBinary(PacketBatch &packets);
+    void fillPcap(PacketBatch &packets);
+};
+
+#endif //PROTOTYPE_TRACESTREAM_H
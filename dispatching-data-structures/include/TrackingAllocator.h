@@ -0,0 +1,76 @@
+#ifndef PROTOTYPE_TRACKINGALLOCATOR_H
+#define PROTOTYPE_TRACKINGALLOCATOR_H
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+#include "HugePages.h"
+#include "MemoryTracker.h"
+
+/**
+ * Allocator for the containers of a dispatcher that records every allocation in the dispatcher's MemoryTracker under
+ * the given category. Node based containers use NODES: their single element allocations are the nodes, arrays (the
+ * buckets of an unordered_map) are counted as TABLE. Without a tracker, it only allocates. Large allocations follow the
+ * page policy of HugePages.
+ */
+template<class T>
+class TrackingAllocator {
+public:
+    using value_type = T;
+
+    TrackingAllocator() = default;
+
+    TrackingAllocator(MemoryTracker *tracker, MemoryCategory category) : tracker(tracker), category(category) {
+    }
+
+    template<class U>
+    TrackingAllocator(const TrackingAllocator<U> &other) : tracker(other.tracker), category(other.category) {
+    }
+
+    T *allocate(size_t count) {
+        auto *pointer = static_cast<T *>(HugePages::allocate(count * sizeof(T)));
+        if (tracker != nullptr) {
+            MemoryCategory actual = category == MemoryCategory::NODES && count > 1 ? MemoryCategory::TABLE : category;
+            bool heap = count * sizeof(T) < HUGE_PAGES_MIN_BYTES || !HugePages::owns(pointer);
+            tracker->allocate(actual, pointer, count * sizeof(T), heap);
+        }
+        return pointer;
+    }
+
+    void deallocate(T *pointer, size_t count) {
+        if (tracker != nullptr) {
+            tracker->deallocate(pointer);
+        }
+        HugePages::deallocate(pointer, count * sizeof(T));
+    }
+
+    template<class U>
+    bool operator==(const TrackingAllocator<U> &other) const {
+        return tracker == other.tracker;
+    }
+
+    template<class U>
+    bool operator!=(const TrackingAllocator<U> &other) const {
+        return tracker != other.tracker;
+    }
+
+private:
+    template<class U>
+    friend class TrackingAllocator;
+
+    MemoryTracker *tracker = nullptr;
+    MemoryCategory category = MemoryCategory::TABLE;
+};
+
+template<class T>
+using tracked_vector = std::vector<T, TrackingAllocator<T>>;
+
+template<class K, class V>
+using tracked_map = std::map<K, V, std::less<K>, TrackingAllocator<std::pair<const K, V>>>;
+
+template<class K, class V>
+using tracked_unordered_map = std::unordered_map<K, V, std::hash<K>, std::equal_to<K>, TrackingAllocator<std::pair<const K, V>>>;
+
+#endif //PROTOTYPE_TRACKINGALLOCATOR_H
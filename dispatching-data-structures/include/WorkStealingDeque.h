@@ -0,0 +1,121 @@
+#ifndef PROTOTYPE_WORKSTEALINGDEQUE_H
+#define PROTOTYPE_WORKSTEALINGDEQUE_H
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+
+enum class StealResult {
+    SUCCESS,
+    EMPTY,    // The deque was empty
+    ABORT,    // Another thread took the item first, retrying may succeed
+    BLOCKED   // The oldest item was rejected by the predicate
+};
+
+/**
+ * Chase-Lev work-stealing deque of a fixed capacity, with the memory orderings of Lê et al., "Correct and Efficient
+ * Work-Stealing for Weak Memory Models" (2013). The owner pushes and pops at the bottom, any other thread steals the
+ * oldest item at the top. T has to be trivially copyable.
+ */
+template<class T>
+class WorkStealingDeque {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    // The capacity is rounded up to the next power of two
+    explicit WorkStealingDeque(size_t capacity) {
+        if (capacity == 0 || capacity > (size_t(1) << 31u)) {
+            throw std::invalid_argument("The capacity of a deque has to be in [1, 2^31].");
+        }
+        size_t size = 1;
+        while (size < capacity) {
+            size <<= 1u;
+        }
+        mask = size - 1;
+        buffer = std::make_unique<std::atomic<T>[]>(size);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque &) = delete;
+    WorkStealingDeque &operator=(const WorkStealingDeque &) = delete;
+
+    // Owner only, returns false if the deque is full
+    bool push(T item) {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask)) {
+            return false;
+        }
+        buffer[b & mask].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Owner only, takes the newest item. Returns false if the deque is empty.
+    bool pop(T &item) {
+        int64_t b = bottom.load(std::memory_order_relaxed) - 1;
+        bottom.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top.load(std::memory_order_relaxed);
+
+        if (t > b) {
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return false;
+        }
+        item = buffer[b & mask].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Last item, race the thieves for it
+            bool won = top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed);
+            bottom.store(b + 1, std::memory_order_relaxed);
+            return won;
+        }
+        return true;
+    }
+
+    // Takes the oldest item if the predicate accepts it
+    template<class Predicate>
+    StealResult steal(T &item, Predicate accept) {
+        int64_t t = top.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t b = bottom.load(std::memory_order_acquire);
+        if (t >= b) {
+            return StealResult::EMPTY;
+        }
+
+        // The slot cannot be reused before top moves past it, so the item is valid if the exchange succeeds
+        T candidate = buffer[t & mask].load(std::memory_order_relaxed);
+        if (!accept(candidate)) {
+            return StealResult::BLOCKED;
+        }
+        if (!top.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return StealResult::ABORT;
+        }
+        item = candidate;
+        return StealResult::SUCCESS;
+    }
+
+    StealResult steal(T &item) {
+        return steal(item, [](const T &) { return true; });
+    }
+
+    // Approximate while other threads modify the deque
+    [[nodiscard]] size_t size() const {
+        int64_t b = bottom.load(std::memory_order_relaxed);
+        int64_t t = top.load(std::memory_order_relaxed);
+        return b > t ? b - t : 0;
+    }
+
+    [[nodiscard]] size_t capacity() const {
+        return mask + 1;
+    }
+
+private:
+    // Thieves only write top, the owner mostly bottom
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> top{0};
+    alignas(CACHE_LINE_SIZE) std::atomic<int64_t> bottom{0};
+    alignas(CACHE_LINE_SIZE) std::unique_ptr<std::atomic<T>[]> buffer;
+    size_t mask;
+};
+
+#endif //PROTOTYPE_WORKSTEALINGDEQUE_H
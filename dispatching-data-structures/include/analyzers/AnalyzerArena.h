@@ -0,0 +1,90 @@
+#ifndef PROTOTYPE_ANALYZERARENA_H
+#define PROTOTYPE_ANALYZERARENA_H
+
+#include <new>
+#include <typeindex>
+#include <vector>
+
+#include "analyzers/IAnalyzer.h"
+
+#define MAKE_ARENA_ANALYZER_BUILDER(arena, analyzer) \
+    [arena]() { return MemoryTracker::trackAnalyzer(arena->create<analyzer>(), sizeof(analyzer), false); }
+
+/**
+ * Places analyzer instances into contiguous, cache line aligned storage instead of scattering them across the heap.
+ * Analyzers of the same type are grouped into the same pool, so a lookup followed by analyze() touches densely packed
+ * objects. All analyzers are destroyed in bulk by clear(), dispatchers must not delete them (see IDispatcher::freeAnalyzer).
+ */
+class AnalyzerArena {
+public:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+    static constexpr size_t DEFAULT_BLOCK_SIZE = 64 * 1024;
+
+    explicit AnalyzerArena(size_t blockSize = DEFAULT_BLOCK_SIZE) : blockSize(blockSize) {
+    }
+    ~AnalyzerArena();
+
+    AnalyzerArena(const AnalyzerArena &) = delete;
+    AnalyzerArena &operator=(const AnalyzerArena &) = delete;
+
+    template<class T>
+    IAnalyzer *create() {
+        static_assert(std::is_base_of<IAnalyzer, T>::value, "Only analyzers can be placed in an analyzer arena.");
+        Pool &pool = getPool(typeid(T), sizeof(T), alignof(T), [](void *object) {
+            static_cast<T *>(object)->~T();
+        });
+        return new(allocate(pool)) T;
+    }
+
+    /**
+     * Ensures that the next count analyzers of type T end up in one contiguous block.
+     */
+    template<class T>
+    void reserve(size_t count) {
+        Pool &pool = getPool(typeid(T), sizeof(T), alignof(T), [](void *object) {
+            static_cast<T *>(object)->~T();
+        });
+        reserve(pool, count);
+    }
+
+    // Destroys all analyzers in the arena. The storage is kept for reuse.
+    void clear();
+
+    // Number of analyzers currently living in the arena
+    [[nodiscard]] size_t size() const;
+
+    // Number of bytes reserved by the arena
+    [[nodiscard]] size_t bytes() const;
+
+    /**
+     * Checks if the analyzer was placed in any arena. Only meant for teardown, not for the hot path.
+     *
+     * @return true, iff the analyzer is owned by an arena.
+     */
+    [[nodiscard]] static bool owns(const IAnalyzer *analyzer);
+
+private:
+    struct Block {
+        uint8_t *data;
+        size_t capacity; // in objects
+        size_t used;     // in objects
+    };
+
+    struct Pool {
+        std::type_index type;
+        size_t stride;
+        void (*destroy)(void *object);
+        std::vector<Block> blocks;
+        size_t current;
+    };
+
+    size_t blockSize;
+    std::vector<Pool> pools;
+
+    Pool &getPool(const std::type_info &type, size_t size, size_t alignment, void (*destroy)(void *object));
+    void *allocate(Pool &pool);
+    void reserve(Pool &pool, size_t count);
+    void addBlock(Pool &pool, size_t capacity);
+};
+
+#endif //PROTOTYPE_ANALYZERARENA_H
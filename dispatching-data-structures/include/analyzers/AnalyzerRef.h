@@ -0,0 +1,85 @@
+#ifndef PROTOTYPE_ANALYZERREF_H
+#define PROTOTYPE_ANALYZERREF_H
+
+#include "analyzers/All.h"
+
+/**
+ * Compact descriptor of a dispatched analyzer: the concrete type as a tag and a pointer to its state. Invoking an
+ * analyzer through a descriptor resolves the type with a switch or a static function table instead of the vtable,
+ * so the compiler calls the final analyzer classes directly.
+ */
+struct AnalyzerRef {
+    AnalyzerKind kind = AnalyzerKind::UNKNOWN;
+    IAnalyzer *analyzer = nullptr;
+
+    AnalyzerRef() = default;
+
+    // Reads the tag from the analyzer object, a load that depends on the pointer
+    explicit AnalyzerRef(IAnalyzer *analyzer) : kind(kindOf(analyzer)), analyzer(analyzer) {
+    }
+
+    // With the tag a dispatcher stored next to the pointer
+    AnalyzerRef(AnalyzerKind kind, IAnalyzer *analyzer) : kind(kind), analyzer(analyzer) {
+    }
+
+    // The tag to store for an analyzer, UNKNOWN for nullptr
+    static AnalyzerKind kindOf(const IAnalyzer *analyzer) {
+        return analyzer != nullptr ? analyzer->getKind() : AnalyzerKind::UNKNOWN;
+    }
+
+    explicit operator bool() const {
+        return analyzer != nullptr;
+    }
+};
+
+/**
+ * Invokes the analyzer with a switch over the type tag.
+ */
+inline void invokeSwitch(const AnalyzerRef &ref, const PacketView &packet) {
+    switch (ref.kind) {
+        case AnalyzerKind::ETH:
+            static_cast<ETHAnalyzer *>(ref.analyzer)->analyze(packet);
+            break;
+        case AnalyzerKind::IPV4:
+            static_cast<IPv4Analyzer *>(ref.analyzer)->analyze(packet);
+            break;
+        case AnalyzerKind::IPV6:
+            static_cast<IPv6Analyzer *>(ref.analyzer)->analyze(packet);
+            break;
+        case AnalyzerKind::TCP:
+            static_cast<TCPAnalyzer *>(ref.analyzer)->analyze(packet);
+            break;
+        case AnalyzerKind::UDP:
+            static_cast<UDPAnalyzer *>(ref.analyzer)->analyze(packet);
+            break;
+        case AnalyzerKind::UNKNOWN:
+            static_cast<UnknownAnalyzer *>(ref.analyzer)->analyze(packet);
+            break;
+    }
+}
+
+template<class T>
+void invokeAs(IAnalyzer *analyzer, const PacketView &packet) {
+    static_cast<T *>(analyzer)->analyze(packet);
+}
+
+using analyzer_invoker = void (*)(IAnalyzer *, const PacketView &);
+
+// Indexed by AnalyzerKind, the order has to match the enum
+inline constexpr analyzer_invoker ANALYZER_INVOKERS[ANALYZER_KIND_COUNT] = {
+        invokeAs<ETHAnalyzer>,
+        invokeAs<IPv4Analyzer>,
+        invokeAs<IPv6Analyzer>,
+        invokeAs<TCPAnalyzer>,
+        invokeAs<UDPAnalyzer>,
+        invokeAs<UnknownAnalyzer>
+};
+
+/**
+ * Invokes the analyzer through the static function table.
+ */
+inline void invokeTable(const AnalyzerRef &ref, const PacketView &packet) {
+    ANALYZER_INVOKERS[static_cast<size_t>(ref.kind)](ref.analyzer, packet);
+}
+
+#endif //PROTOTYPE_ANALYZERREF_H
@@ -0,0 +1,66 @@
+#ifndef PROTOTYPE_ANALYZERREPLICAS_H
+#define PROTOTYPE_ANALYZERREPLICAS_H
+
+#include <map>
+#include <memory>
+#include <vector>
+
+#include "analyzers/AnalyzerArena.h"
+#include "analyzers/IAnalyzer.h"
+
+class IDispatcher;
+
+/**
+ * Per worker copies of the analyzers of a dispatcher. The workers keep sharing the dispatcher and its identifier
+ * mapping, but replace the analyzer of every lookup with their own replica (see get()), so they never write to the
+ * same analyzer. The replicas of each worker are placed in an AnalyzerArena of their own, which keeps the replicas of
+ * different workers in different cache lines.
+ *
+ * The analyzers of the dispatcher only serve as prototypes that name the replicas, they are not updated by the
+ * workers. An analyzer can only be replicated by one AnalyzerReplicas at a time.
+ */
+class AnalyzerReplicas {
+public:
+    /**
+     * Replicates every analyzer that is registered in the dispatcher for one of the identifiers.
+     */
+    AnalyzerReplicas(IDispatcher &dispatcher, const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+                     size_t workerCount);
+
+    AnalyzerReplicas(const AnalyzerReplicas &) = delete;
+    AnalyzerReplicas &operator=(const AnalyzerReplicas &) = delete;
+
+    // Replica of the worker for an analyzer that was returned by the dispatcher
+    IAnalyzer *get(size_t worker, const IAnalyzer *prototype) const {
+        return workers[worker]->analyzers[prototype->getReplicaIndex()];
+    }
+
+    /**
+     * Merges the replicas of all workers into one new analyzer per prototype, while the workers keep running. The
+     * result is in the order of getPrototypes().
+     */
+    [[nodiscard]] std::vector<std::unique_ptr<IAnalyzer>> snapshot() const;
+
+    // Analyzers of the dispatcher in the order of their replica index
+    [[nodiscard]] const std::vector<IAnalyzer *> &getPrototypes() const {
+        return prototypes;
+    }
+
+    [[nodiscard]] size_t workerCount() const {
+        return workers.size();
+    }
+
+private:
+    struct Worker {
+        AnalyzerArena arena;
+        std::vector<IAnalyzer *> analyzers;
+    };
+
+    std::vector<IAnalyzer *> prototypes;
+    std::vector<std::unique_ptr<Worker>> workers;
+
+    // Creates an analyzer of the kind in the arena, or on the heap without one
+    static IAnalyzer *create(AnalyzerKind kind, AnalyzerArena *arena);
+};
+
+#endif //PROTOTYPE_ANALYZERREPLICAS_H
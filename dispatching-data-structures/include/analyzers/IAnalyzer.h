@@ -1,25 +1,186 @@
 #ifndef PROTOTYPE_IANALYZER_H
 #define PROTOTYPE_IANALYZER_H
 
+#include <algorithm>
+#include <atomic>
 #include <ostream>
 #include <memory>
 #include <functional>
-#include "MyPacket.h"
+#include <cstring>
+#include <stdexcept>
+#include "MemoryTracker.h"
+#include "PacketBatch.h"
 
-#define MAKE_ANALYZER_BUILDER(analyzer) []() { return new analyzer; }
+#define MAKE_ANALYZER_BUILDER(analyzer) []() { return MemoryTracker::trackAnalyzer(new analyzer, sizeof(analyzer)); }
+
+// Bytes read from the payload by the HEADER workload
+#define WORKLOAD_HEADER_SIZE 8
+
+enum class AnalyzerWork : uint8_t {
+    COUNTER, // Only count the PDU
+    HEADER,  // Additionally read a fixed size header from the payload
+    BYTES    // Additionally touch a configurable number of payload bytes
+};
+
+/**
+ * The amount of work every analyzer does per PDU on top of counting it. Used to make the cost of following the
+ * dispatched pointer into the analyzer visible in the benchmarks.
+ */
+struct AnalyzerWorkload {
+    AnalyzerWork type = AnalyzerWork::COUNTER;
+    size_t bytes = 0;
+
+    /**
+     * Parses a workload description, which is either "counter", "header" or "bytes:<N>".
+     */
+    static AnalyzerWorkload parse(const std::string &description);
+};
+
+/**
+ * Outcome of parsing a header: the identifier of the next layer and the offset of its header in the frame. A parse
+ * without a next layer ends the chain, either because the protocol has none or because the header is invalid.
+ */
+struct ParseResult {
+    bool hasNext = false;
+    identifier_t next = 0;
+    size_t offset = 0;
+
+    static ParseResult end() {
+        return {};
+    }
+
+    static ParseResult nextLayer(identifier_t next, size_t offset) {
+        return {true, next, offset};
+    }
+};
+
+/**
+ * Statistic of an analyzer. Only the thread that runs the analyzer writes it, but other threads may read it at any
+ * time (see AnalyzerReplicas::snapshot). Relaxed atomics make this well-defined and still compile to plain loads and
+ * stores. If several threads run the same analyzer, their increments get lost instead of being undefined behavior.
+ */
+class AnalyzerCounter {
+public:
+    void increment() {
+        add(1);
+    }
+
+    void add(size_t amount) {
+        value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+    }
+
+    [[nodiscard]] size_t get() const {
+        return value.load(std::memory_order_relaxed);
+    }
+
+private:
+    std::atomic<size_t> value{0};
+};
+
+// Concrete type of an analyzer, used to invoke it without a virtual call (see AnalyzerRef.h)
+enum class AnalyzerKind : uint8_t {
+    ETH,
+    IPV4,
+    IPV6,
+    TCP,
+    UDP,
+    UNKNOWN
+};
+
+#define ANALYZER_KIND_COUNT 6
 
 class IAnalyzer {
 public:
+    explicit IAnalyzer(AnalyzerKind kind) : kind(kind) {
+    }
     virtual ~IAnalyzer() = default;
-    virtual void analyze(const MyPacket &packet) = 0;
+    virtual void analyze(const PacketView &packet) = 0;
+
+    /**
+     * Parses the header of the analyzer's protocol, which starts at the offset of a raw frame, and determines the
+     * layer behind it. The frame is only read within its length.
+     */
+    virtual ParseResult parse(const ArrayView<uint8_t> &frame, size_t offset) = 0;
+
+    // Number of PDUs the analyzer has analyzed or parsed
+    [[nodiscard]] virtual size_t getCounter() const = 0;
+
+    [[nodiscard]] AnalyzerKind getKind() const {
+        return kind;
+    }
+
+    /**
+     * Adds the state of another analyzer of the same kind to this one, e.g. to aggregate the replicas of an analyzer.
+     * The other analyzer may be running at the same time.
+     */
+    void merge(const IAnalyzer &other) {
+        if (other.kind != kind) {
+            throw std::invalid_argument("Only analyzers of the same kind can be merged.");
+        }
+        mergeState(other);
+    }
+
+    // Index of the analyzer's replicas, only valid while it is replicated (see AnalyzerReplicas)
+    [[nodiscard]] uint32_t getReplicaIndex() const {
+        return replicaIndex;
+    }
+
+    // Sets the workload for all analyzers. Must not be changed while analyzers are running.
+    static void setWorkload(const AnalyzerWorkload &newWorkload) {
+        workload = newWorkload;
+    }
 
     friend std::ostream &operator<<(std::ostream &os, const IAnalyzer &analyzer) {
         analyzer.print(os);
         return os;
     }
 
+protected:
+    inline static AnalyzerWorkload workload;
+
+    // Does the configured work on the payload. Called by the analyzers in analyze().
+    static inline void work(const PacketView &packet) {
+        if (workload.type == AnalyzerWork::COUNTER) {
+            return;
+        }
+
+        const ArrayView<uint8_t> &payload = packet.getPayload();
+        if (payload.empty()) {
+            return;
+        }
+
+        uint64_t digest = 0;
+        if (workload.type == AnalyzerWork::HEADER) {
+            static_assert(WORKLOAD_HEADER_SIZE <= sizeof(digest), "Header does not fit into the digest.");
+            memcpy(&digest, payload.data(), std::min<size_t>(payload.size(), WORKLOAD_HEADER_SIZE));
+        } else {
+            // Always touch the configured amount of bytes, wrap around if the payload is shorter
+            size_t position = 0;
+            for (size_t i = 0; i < workload.bytes; i++) {
+                digest += payload[position];
+                if (++position == payload.size()) {
+                    position = 0;
+                }
+            }
+        }
+
+        // Keep the compiler from dropping the reads
+        asm volatile("" : : "r"(digest));
+    }
+
+    // Checks if a header of the given size starting at the offset lies within the frame
+    static inline bool fits(const ArrayView<uint8_t> &frame, size_t offset, size_t size) {
+        return offset <= frame.size() && frame.size() - offset >= size;
+    }
+
 private:
+    friend class AnalyzerReplicas;
+
+    const AnalyzerKind kind;
+    uint32_t replicaIndex = 0;
+
     virtual void print(std::ostream& os) const = 0;
+    virtual void mergeState(const IAnalyzer &other) = 0;
 };
 
 using analyzer_builder = std::function<IAnalyzer*()>;
@@ -3,14 +3,24 @@
 
 #include "IAnalyzer.h"
 
-class UDPAnalyzer : public IAnalyzer {
+class UDPAnalyzer final : public IAnalyzer {
 public:
-    void analyze(const MyPacket &packet) override;
+    UDPAnalyzer() : IAnalyzer(AnalyzerKind::UDP) {
+    }
+
+    void analyze(const PacketView &packet) override;
+    ParseResult parse(const ArrayView<uint8_t> &frame, size_t offset) override;
+
+    [[nodiscard]] size_t getCounter() const override {
+        return counter.get();
+    }
 
 private:
-    size_t counter = 0;
+    AnalyzerCounter counter;
+    AnalyzerCounter validHeaders;
 
     void print(std::ostream &os) const override;
+    void mergeState(const IAnalyzer &other) override;
 };
 
 
@@ -3,14 +3,23 @@
 
 #include "IAnalyzer.h"
 
-class UnknownAnalyzer : public IAnalyzer {
+class UnknownAnalyzer final : public IAnalyzer {
 public:
-    void analyze(const MyPacket &packet) override;
+    UnknownAnalyzer() : IAnalyzer(AnalyzerKind::UNKNOWN) {
+    }
+
+    void analyze(const PacketView &packet) override;
+    ParseResult parse(const ArrayView<uint8_t> &frame, size_t offset) override;
+
+    [[nodiscard]] size_t getCounter() const override {
+        return counter.get();
+    }
 
 private:
-    size_t counter = 0;
+    AnalyzerCounter counter;
 
     void print(std::ostream &os) const override;
+    void mergeState(const IAnalyzer &other) override;
 };
 
 
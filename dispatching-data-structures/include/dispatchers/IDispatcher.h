@@ -5,6 +5,12 @@
 
 #include "Defines.h"
 #include "analyzers/IAnalyzer.h"
+#include "analyzers/AnalyzerArena.h"
+#include "analyzers/AnalyzerRef.h"
+#include "dispatchers/InterleavedLookup.h"
+#include "dispatchers/LookupTrace.h"
+#include "MemoryTracker.h"
+#include "TrackingAllocator.h"
 
 class IDispatcher {
 public:
@@ -19,6 +25,46 @@ public:
     }
     virtual IAnalyzer * lookup(identifier_t identifier) = 0;
 
+    /**
+     * Looks up the analyzer like lookup(), but without branches that depend on the identifier where the structure
+     * allows it: range and key checks select the result with masks and conditional moves, so traces with unpredictable
+     * identifiers cause no branch misses. Dispatchers without such a variant use lookup().
+     */
+    virtual IAnalyzer *lookupBranchless(identifier_t identifier) {
+        return lookup(identifier);
+    }
+
+    /**
+     * Looks up the analyzer like lookup(), but returns a descriptor that can be invoked without a virtual call
+     * (see invokeSwitch and invokeTable). Array, Vector, Hanov and Universal store the type tag next to the pointer,
+     * so the descriptor is complete without touching the analyzer. Other dispatchers read the tag from the analyzer
+     * object, which costs the same dependent load as the vtable, the devirtualized benchmarks leave them out.
+     *
+     * @return The descriptor of the analyzer, empty if no analyzer is registered for the identifier
+     */
+    virtual AnalyzerRef lookupRef(identifier_t identifier) {
+        return AnalyzerRef(lookup(identifier));
+    }
+
+    /**
+     * Looks up a batch of identifiers with up to groupSize lookups in flight at the same time (see
+     * interleavedLookup). Dispatchers that do not expose their probe steps look the identifiers up one by one.
+     *
+     * @param results Receives the analyzer of every identifier, nullptr if none is registered
+     */
+    virtual void lookupInterleaved(const identifier_t *identifiers, size_t count, IAnalyzer **results,
+                                   size_t groupSize) {
+        for (size_t i = 0; i < count; i++) {
+            results[i] = lookup(identifiers[i]);
+        }
+    }
+
+    /**
+     * Looks up the analyzer like lookup() and records the loads of the data structure it performs, for the cache
+     * simulator (see CacheSimulator). Much slower than lookup(), only used for instrumentation.
+     */
+    virtual IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) = 0;
+
     /**
      * This function reports how many analyzers are currently registered in the dispatcher.
      *
@@ -27,6 +73,20 @@ public:
     virtual size_t size() = 0;
     virtual size_t real_size() = 0;
 
+    /**
+     * Reports the memory of the dispatcher by category, measured by tracking the allocations of its containers and
+     * analyzer builders instead of estimating it like real_size(). Analyzers placed in an AnalyzerArena are counted
+     * with their size, but without allocator overhead.
+     */
+    MemoryUsage memoryUsage() const {
+        return memoryTracker.usage(inlineRegions());
+    }
+
+    // Every block of memory of the dispatcher and its analyzers, e.g. to evict them from the caches
+    std::vector<MemoryRegion> memoryRegions() const {
+        return memoryTracker.regions(inlineRegions());
+    }
+
     virtual void clear() = 0;
 
     friend std::ostream &operator<<(std::ostream &os, const IDispatcher &dispatcher) {
@@ -34,6 +94,42 @@ public:
         return os;
     };
 
+protected:
+    MemoryTracker memoryTracker;
+    // The tracker if tracking was enabled when the dispatcher was created, nullptr otherwise (see
+    // MemoryTracker::setEnabled). Containers and builders only record their allocations through it.
+    MemoryTracker *const tracker = MemoryTracker::isEnabled() ? &memoryTracker : nullptr;
+
+    // Allocator for a container of the dispatcher, counted in memoryUsage() under the category if tracking is enabled
+    template<class T>
+    TrackingAllocator<T> trackedAllocator(MemoryCategory category) {
+        return TrackingAllocator<T>(tracker, category);
+    }
+
+    // Memory outside of the tracked containers, e.g. tables that are members of the dispatcher
+    virtual std::vector<MemoryRegion> inlineRegions() const {
+        return {};
+    }
+
+    // Calls the builder with the tracker of the dispatcher active, so the new analyzer is counted
+    IAnalyzer *buildAnalyzer(const analyzer_builder &make_analyzer) {
+        if (tracker == nullptr) {
+            return make_analyzer();
+        }
+        MemoryTracker::Scope scope(*tracker);
+        return make_analyzer();
+    }
+
+    // Analyzers placed in an AnalyzerArena are destroyed in bulk by the arena, all others belong to the dispatcher.
+    inline void freeAnalyzer(IAnalyzer *analyzer) {
+        if (tracker != nullptr) {
+            tracker->deallocate(analyzer);
+        }
+        if (!AnalyzerArena::owns(analyzer)) {
+            delete analyzer;
+        }
+    }
+
 private:
     virtual void stringifyAnalyzersState(std::ostream& os) const = 0;
 };
@@ -0,0 +1,82 @@
+#ifndef PROTOTYPE_INTERLEAVEDLOOKUP_H
+#define PROTOTYPE_INTERLEAVEDLOOKUP_H
+
+#include <algorithm>
+#include <cstddef>
+
+#include "analyzers/IAnalyzer.h"
+
+// Maximum number of lookups that are in flight at the same time
+#define INTERLEAVED_MAX_GROUP 64
+
+/**
+ * State of one lookup that is split into probe steps. A dispatcher that supports interleaved lookups implements
+ *
+ *     bool probe(LookupProbe &probe, IAnalyzer *&result) const;
+ *
+ * The first call (stage 0) only computes the address of the first memory access. Every further call performs the
+ * access the previous call announced. probe() returns true once the result is set, or stores the address of its next
+ * access and returns false, so the engine can prefetch it and continue with other lookups in the meantime.
+ */
+struct LookupProbe {
+    identifier_t identifier = 0;
+    uint32_t stage = 0;
+    const void *address = nullptr;
+    uint64_t scratch = 0;
+};
+
+/**
+ * Asynchronous memory access chaining (Kocberber et al., "Asynchronous Memory Access Chaining", VLDB 2015): keeps up
+ * to groupSize lookups in flight and switches to the next one whenever a lookup waits for memory, so the cache misses
+ * of independent lookups overlap instead of adding up. The probe steps are called without a virtual call.
+ *
+ * @param results Receives the analyzer of every identifier, nullptr if none is registered
+ */
+template<class Dispatcher>
+void interleavedLookup(const Dispatcher &dispatcher, const identifier_t *identifiers, size_t count,
+                       IAnalyzer **results, size_t groupSize) {
+    struct Slot {
+        LookupProbe probe;
+        size_t index;
+    };
+    Slot slots[INTERLEAVED_MAX_GROUP];
+    groupSize = std::max<size_t>(1, std::min<size_t>(groupSize, INTERLEAVED_MAX_GROUP));
+
+    // Starts the next lookup in a slot, lookups that need no memory access are finished right away
+    size_t next = 0;
+    auto start = [&](Slot &slot) {
+        while (next < count) {
+            slot.probe = LookupProbe();
+            slot.probe.identifier = identifiers[next];
+            slot.index = next++;
+            if (!dispatcher.probe(slot.probe, results[slot.index])) {
+                __builtin_prefetch(slot.probe.address);
+                return true;
+            }
+        }
+        return false;
+    };
+
+    size_t active = 0;
+    for (size_t i = 0; i < groupSize && start(slots[active]); i++) {
+        active++;
+    }
+
+    // Round robin over the slots, a finished slot is refilled or replaced by the last active one
+    size_t current = 0;
+    while (active > 0) {
+        Slot &slot = slots[current];
+        if (!dispatcher.probe(slot.probe, results[slot.index])) {
+            __builtin_prefetch(slot.probe.address);
+        } else if (!start(slot)) {
+            slot = slots[--active];
+            if (current == active) {
+                current = 0;
+            }
+            continue;
+        }
+        current = current + 1 == active ? 0 : current + 1;
+    }
+}
+
+#endif //PROTOTYPE_INTERLEAVEDLOOKUP_H
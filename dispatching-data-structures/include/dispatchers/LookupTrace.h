@@ -0,0 +1,102 @@
+#ifndef PROTOTYPE_LOOKUPTRACE_H
+#define PROTOTYPE_LOOKUPTRACE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <map>
+#include <vector>
+
+#include "dispatchers/InterleavedLookup.h"
+
+// One load of an instrumented lookup
+struct MemoryAccess {
+    const void *address;
+    uint32_t bytes;
+    // Loads whose address only depends on the identifier have depth 0, a load that needs the value of another load is
+    // one deeper than it
+    uint32_t depth;
+};
+
+/**
+ * Receives the loads of the data structure that one lookup performs, see IDispatcher::traceLookup. Fields of the
+ * dispatcher object itself (sizes, hash seeds, the pointer to the table) are assumed to be in registers and are not
+ * recorded, neither are the instructions.
+ */
+class LookupTrace {
+public:
+    void load(const void *address, size_t bytes, uint32_t depth) {
+        accesses.push_back(MemoryAccess{address, static_cast<uint32_t>(bytes), depth});
+    }
+
+    // Depth of a load that needs the value of the last recorded one
+    [[nodiscard]] uint32_t nextDepth() const {
+        return accesses.empty() ? 0 : accesses.back().depth + 1;
+    }
+
+    void clear() {
+        accesses.clear();
+    }
+
+    [[nodiscard]] const std::vector<MemoryAccess> &getAccesses() const {
+        return accesses;
+    }
+
+private:
+    std::vector<MemoryAccess> accesses;
+};
+
+/**
+ * Traces a lookup of a dispatcher that exposes its probe steps (see LookupProbe): every announced address is one load,
+ * each depending on the previous one. The recorded size is a word, the probes do not announce sizes.
+ */
+template<class Dispatcher>
+IAnalyzer *traceProbes(const Dispatcher &dispatcher, identifier_t identifier, LookupTrace &trace) {
+    LookupProbe probe;
+    probe.identifier = identifier;
+    IAnalyzer *result = nullptr;
+    uint32_t depth = 0;
+    while (!dispatcher.probe(probe, result)) {
+        trace.load(probe.address, sizeof(void *), depth++);
+    }
+    return result;
+}
+
+/**
+ * Traces map.lower_bound(key), or map.upper_bound(key) with upper: the nodes on the path from the root of the
+ * red-black tree. With libstdc++, the tree is walked like the standard library does, other standard libraries only
+ * record the node that is found.
+ *
+ * @param depth The depth of the load of the root
+ */
+template<class Map>
+typename Map::const_iterator traceBound(const Map &map, const typename Map::key_type &key, LookupTrace &trace,
+                                        bool upper = false, uint32_t depth = 0) {
+#if defined(__GLIBCXX__)
+    using node_t = std::_Rb_tree_node<typename Map::value_type>;
+    const std::_Rb_tree_node_base *header = map.end()._M_node;
+    const std::_Rb_tree_node_base *bound = header;
+    const std::_Rb_tree_node_base *node = header->_M_parent;
+    while (node != nullptr) {
+        // A search reads the child pointers and the key at the start of the node, not the rest of the value
+        const auto *current = static_cast<const node_t *>(node);
+        const auto &nodeKey = current->_M_valptr()->first;
+        auto keyEnd = reinterpret_cast<const char *>(&nodeKey + 1);
+        trace.load(current, keyEnd - reinterpret_cast<const char *>(current), depth++);
+        if (upper ? !map.key_comp()(key, nodeKey) : map.key_comp()(nodeKey, key)) {
+            node = node->_M_right;
+        } else {
+            bound = node;
+            node = node->_M_left;
+        }
+    }
+    return typename Map::const_iterator(bound);
+#else
+    auto bound = upper ? map.upper_bound(key) : map.lower_bound(key);
+    if (bound != map.end()) {
+        trace.load(&bound->first, sizeof(bound->first), depth);
+    }
+    return bound;
+#endif
+}
+
+#endif //PROTOTYPE_LOOKUPTRACE_H
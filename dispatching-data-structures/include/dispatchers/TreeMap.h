@@ -11,13 +11,15 @@ public:
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override;
     size_t size() override;
     void clear() override;
 
     size_t real_size() override;
 
 private:
-    std::map<identifier_t, IAnalyzer*> table;
+    tracked_map<identifier_t, IAnalyzer*> table{
+            trackedAllocator<std::pair<const identifier_t, IAnalyzer*>>(MemoryCategory::NODES)};
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
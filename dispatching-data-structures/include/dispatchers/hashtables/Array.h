@@ -2,14 +2,47 @@
 
 #include "Defines.h"
 #include "dispatchers/IDispatcher.h"
+#include "HugePages.h"
 
 class Array : public IDispatcher {
 public:
     Array();
     ~Array() override;
 
+    // The table is a member, so the whole object follows the page policy (see HugePages), without an indirection
+    static void *operator new(size_t bytes) {
+        return HugePages::allocate(bytes);
+    }
+
+    static void operator delete(void *address, size_t bytes) {
+        HugePages::deallocate(address, bytes);
+    }
+
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *lookupBranchless(identifier_t identifier) override;
+
+    // The tag comes from its own table, independent of the analyzer
+    AnalyzerRef lookupRef(identifier_t identifier) override {
+        return AnalyzerRef(kinds[identifier], table[identifier]);
+    }
+    void lookupInterleaved(const identifier_t *identifiers, size_t count, IAnalyzer **results,
+                           size_t groupSize) override {
+        interleavedLookup(*this, identifiers, count, results, groupSize);
+    }
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override {
+        return traceProbes(*this, identifier, trace);
+    }
+
+    // One access: the slot of the identifier
+    bool probe(LookupProbe &probe, IAnalyzer *&result) const {
+        if (probe.stage++ == 0) {
+            probe.address = &table[probe.identifier];
+            return false;
+        }
+        result = table[probe.identifier];
+        return true;
+    }
     size_t size() override;
 
     size_t real_size() override;
@@ -18,6 +51,13 @@ public:
 
 private:
     IAnalyzer* table[MAX_IDENTIFIERS]{};
+    // Type tag of every slot for lookupRef(), behind the table so lookup() does not see it
+    AnalyzerKind kinds[MAX_IDENTIFIERS]{};
+
+    std::vector<MemoryRegion> inlineRegions() const override {
+        return {MemoryRegion{MemoryCategory::TABLE, table, sizeof(table), false},
+                MemoryRegion{MemoryCategory::METADATA, kinds, sizeof(kinds), false}};
+    }
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
@@ -12,6 +12,7 @@ public:
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override;
     size_t size() override;
     void clear() override;
 
@@ -19,8 +20,13 @@ public:
 
 private:
     cuckoo_hash table;
-    std::vector<std::unique_ptr<identifier_t>> keys;
+    // The library stores pointers to the keys, so every key lives in its own allocation
+    tracked_vector<std::unique_ptr<identifier_t>> keys{
+            trackedAllocator<std::unique_ptr<identifier_t>>(MemoryCategory::METADATA)};
+
+    std::vector<MemoryRegion> inlineRegions() const override;
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
+    void freeKeys();
 };
\ No newline at end of file
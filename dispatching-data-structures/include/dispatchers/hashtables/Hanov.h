@@ -6,16 +6,61 @@
 
 #include "Defines.h"
 #include "dispatchers/IDispatcher.h"
+#include "dispatchers/hashtables/SlotLayout.h"
 
 #define HASH_CONST 0x01000193
 
-class Hanov : public IDispatcher {
+/**
+ * Minimal perfect hash table after Steve Hanov: an intermediate table of hash seeds selects the slot of every key. The
+ * layout of the slots is a template parameter (see SlotLayout.h), Hanov is the pair layout.
+ */
+template<class Layout>
+class BasicHanov : public IDispatcher {
 public:
-    Hanov() : empty(true), first_d(0), _size(0) {}
-    ~Hanov() override;
+    BasicHanov() : empty(true), first_d(0), _size(0) {}
+    ~BasicHanov() override;
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     void registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *lookupBranchless(identifier_t identifier) override;
+    AnalyzerRef lookupRef(identifier_t identifier) override {
+        if (empty) {
+            return AnalyzerRef();
+        }
+        uint32_t d = intermediate[hash(first_d, identifier) % _size];
+        return table.ref(hash(d, identifier) % _size, identifier);
+    }
+    void lookupInterleaved(const identifier_t *identifiers, size_t count, IAnalyzer **results,
+                           size_t groupSize) override {
+        interleavedLookup(*this, identifiers, count, results, groupSize);
+    }
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override {
+        if (empty) {
+            return nullptr;
+        }
+        const uint32_t &d = intermediate[hash(first_d, identifier) % _size];
+        trace.load(&d, sizeof(d), 0);
+        return table.trace(hash(d, identifier) % _size, identifier, trace, 1);
+    }
+
+    // Dependent accesses: the intermediate value, then the slot it selects, one or two depending on the layout
+    bool probe(LookupProbe &probe, IAnalyzer *&result) const {
+        switch (probe.stage++) {
+            case 0:
+                if (empty) {
+                    result = nullptr;
+                    return true;
+                }
+                probe.scratch = hash(first_d, probe.identifier) % _size;
+                probe.address = &intermediate[probe.scratch];
+                return false;
+            case 1:
+                probe.scratch = hash(intermediate[probe.scratch], probe.identifier) % _size;
+                return table.probe(probe, probe.scratch, 0, result);
+            default:
+                return table.probe(probe, probe.scratch, probe.stage - 2, result);
+        }
+    }
     size_t size() override;
     void clear() override;
 
@@ -24,8 +69,8 @@ public:
 private:
     bool empty;
     uint32_t first_d;
-    std::vector<uint32_t> intermediate;
-    std::vector<Value> values;
+    tracked_vector<uint32_t> intermediate{trackedAllocator<uint32_t>(MemoryCategory::METADATA)};
+    Layout table{tracker};
     size_t _size;
 
     void createMPH(std::unordered_map<identifier_t, IAnalyzer*> &&analyzers);
@@ -64,4 +109,8 @@ private:
     #endif
 };
 
+using Hanov = BasicHanov<PairSlots>;
+using HanovSplit = BasicHanov<SplitSlots>;
+using HanovPacked = BasicHanov<PackedSlots>;
+
 #endif //PROTOTYPE_HANOV_H
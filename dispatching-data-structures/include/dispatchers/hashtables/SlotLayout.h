@@ -0,0 +1,390 @@
+#ifndef PROTOTYPE_SLOTLAYOUT_H
+#define PROTOTYPE_SLOTLAYOUT_H
+
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "Defines.h"
+#include "analyzers/AnalyzerRef.h"
+#include "dispatchers/InterleavedLookup.h"
+#include "dispatchers/LookupTrace.h"
+#include "TrackingAllocator.h"
+
+/*
+ * Slot layouts of the flat hash tables (BasicUniversal, BasicUniversalSim, BasicHanov): how the key and the analyzer of
+ * every slot are stored. The tables take the layout as template parameter, all layouts have the same interface:
+ *
+ *     assign(count) / assign(slots)     Empty slots, or the slots of a table built as Values (nullptr is empty)
+ *     set(slot, key, analyzer)          Fills one slot, a nullptr analyzer only stores the key (dummies of Hanov)
+ *     key(slot), analyzer(slot)         The content of a slot, empty slots hold key 0 and nullptr
+ *     find(slot, identifier)            The analyzer of the slot if its key is the identifier, nullptr otherwise
+ *     findBranchless(slot, identifier)  The same with masks instead of branches
+ *     ref(slot, identifier)             find() as a descriptor with the type tag stored in the slot (see AnalyzerRef)
+ *     probe(probe, slot, step, result)  The probe steps of find() for interleaved lookups, step 0 is the first access
+ *     trace(slot, identifier, trace, d) find() recording its loads, the first one at depth d
+ *     forEach(f), release(free)         Visits the occupied slots, releases all analyzers but keeps the keys
+ *     MAX_ANALYZERS                     The most analyzers the layout holds, tables check it before building any
+ */
+
+/**
+ * An array of key and analyzer pairs: 2 bytes of key padded to 16 bytes per slot, so a cache line holds 4 slots and
+ * every probe loads the analyzer pointer, whether the key matches or not. The layout the tables always had, the type
+ * tag lives in the padding.
+ */
+class PairSlots {
+public:
+    static constexpr size_t MAX_ANALYZERS = SIZE_MAX;
+
+    explicit PairSlots(MemoryTracker *tracker) : slots(TrackingAllocator<Slot>(tracker, MemoryCategory::TABLE)) {}
+
+    void assign(size_t count) {
+        slots.assign(count, Slot());
+    }
+
+    void assign(const std::vector<Value> &values) {
+        assign(values.size());
+        for (size_t slot = 0; slot < values.size(); slot++) {
+            set(slot, values[slot].first, values[slot].second);
+        }
+    }
+
+    void set(size_t slot, identifier_t key, IAnalyzer *analyzer) {
+        slots[slot] = Slot{key, AnalyzerRef::kindOf(analyzer), analyzer};
+    }
+
+    [[nodiscard]] size_t size() const {
+        return slots.size();
+    }
+
+    [[nodiscard]] identifier_t key(size_t slot) const {
+        return slots[slot].key;
+    }
+
+    [[nodiscard]] IAnalyzer *analyzer(size_t slot) const {
+        return slots[slot].analyzer;
+    }
+
+    // Empty slots hold nullptr, so only the key has to match
+    [[nodiscard]] IAnalyzer *find(size_t slot, identifier_t identifier) const {
+        const Slot &entry = slots[slot];
+        return entry.key == identifier ? entry.analyzer : nullptr;
+    }
+
+    [[nodiscard]] IAnalyzer *findBranchless(size_t slot, identifier_t identifier) const {
+        const Slot &entry = slots[slot];
+        return maskAnalyzer(entry.key == identifier, entry.analyzer);
+    }
+
+    [[nodiscard]] AnalyzerRef ref(size_t slot, identifier_t identifier) const {
+        const Slot &entry = slots[slot];
+        return entry.key == identifier ? AnalyzerRef(entry.kind, entry.analyzer) : AnalyzerRef();
+    }
+
+    // One access: the slot
+    bool probe(LookupProbe &probe, size_t slot, uint32_t step, IAnalyzer *&result) const {
+        if (step == 0) {
+            probe.address = &slots[slot];
+            return false;
+        }
+        result = find(slot, probe.identifier);
+        return true;
+    }
+
+    IAnalyzer *trace(size_t slot, identifier_t identifier, LookupTrace &trace, uint32_t depth) const {
+        trace.load(&slots[slot], sizeof(Slot), depth);
+        return find(slot, identifier);
+    }
+
+    template<class Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto &current : slots) {
+            if (current.analyzer != nullptr) {
+                visit(current.key, current.analyzer);
+            }
+        }
+    }
+
+    template<class Free>
+    void release(Free free) {
+        for (auto &current : slots) {
+            if (current.analyzer != nullptr) {
+                free(current.analyzer);
+                current.analyzer = nullptr;
+            }
+        }
+    }
+
+    // 2 byte key and 8 byte analyzer pointer per slot, without the padding
+    [[nodiscard]] size_t realSize() const {
+        return slots.size() * (sizeof(identifier_t) + sizeof(IAnalyzer *));
+    }
+
+private:
+    // Same size as Value
+    struct Slot {
+        identifier_t key = 0;
+        AnalyzerKind kind = AnalyzerKind::UNKNOWN;
+        IAnalyzer *analyzer = nullptr;
+    };
+    static_assert(sizeof(Slot) == sizeof(Value), "The type tag has to fit into the padding of a slot.");
+
+    tracked_vector<Slot> slots;
+};
+
+/**
+ * Structure of arrays: the keys are probed first, 32 to a cache line, the parallel array of analyzers is only read if
+ * the key matches. A miss touches one line of keys, a hit a second line of analyzers (and one of type tags for ref()).
+ */
+class SplitSlots {
+public:
+    static constexpr size_t MAX_ANALYZERS = SIZE_MAX;
+
+    explicit SplitSlots(MemoryTracker *tracker)
+            : keys(TrackingAllocator<identifier_t>(tracker, MemoryCategory::TABLE)),
+              analyzers(TrackingAllocator<IAnalyzer *>(tracker, MemoryCategory::TABLE)),
+              kinds(TrackingAllocator<AnalyzerKind>(tracker, MemoryCategory::METADATA)) {}
+
+    void assign(size_t count) {
+        keys.assign(count, 0);
+        analyzers.assign(count, nullptr);
+        kinds.assign(count, AnalyzerKind::UNKNOWN);
+    }
+
+    void assign(const std::vector<Value> &values) {
+        assign(values.size());
+        for (size_t slot = 0; slot < values.size(); slot++) {
+            set(slot, values[slot].first, values[slot].second);
+        }
+    }
+
+    void set(size_t slot, identifier_t key, IAnalyzer *analyzer) {
+        keys[slot] = key;
+        analyzers[slot] = analyzer;
+        kinds[slot] = AnalyzerRef::kindOf(analyzer);
+    }
+
+    [[nodiscard]] size_t size() const {
+        return keys.size();
+    }
+
+    [[nodiscard]] identifier_t key(size_t slot) const {
+        return keys[slot];
+    }
+
+    [[nodiscard]] IAnalyzer *analyzer(size_t slot) const {
+        return analyzers[slot];
+    }
+
+    // Empty slots hold key 0 and nullptr, a lookup of identifier 0 reads the nullptr
+    [[nodiscard]] IAnalyzer *find(size_t slot, identifier_t identifier) const {
+        return keys[slot] == identifier ? analyzers[slot] : nullptr;
+    }
+
+    // Loads the analyzer of every probed slot, the slot is valid whether the key matches or not
+    [[nodiscard]] IAnalyzer *findBranchless(size_t slot, identifier_t identifier) const {
+        return maskAnalyzer(keys[slot] == identifier, analyzers[slot]);
+    }
+
+    [[nodiscard]] AnalyzerRef ref(size_t slot, identifier_t identifier) const {
+        return keys[slot] == identifier ? AnalyzerRef(kinds[slot], analyzers[slot]) : AnalyzerRef();
+    }
+
+    // Up to two accesses: the key, then the analyzer if the key matches
+    bool probe(LookupProbe &probe, size_t slot, uint32_t step, IAnalyzer *&result) const {
+        switch (step) {
+            case 0:
+                probe.address = &keys[slot];
+                return false;
+            case 1:
+                if (keys[slot] != probe.identifier) {
+                    result = nullptr;
+                    return true;
+                }
+                probe.address = &analyzers[slot];
+                return false;
+            default:
+                result = analyzers[slot];
+                return true;
+        }
+    }
+
+    IAnalyzer *trace(size_t slot, identifier_t identifier, LookupTrace &trace, uint32_t depth) const {
+        trace.load(&keys[slot], sizeof(identifier_t), depth);
+        if (keys[slot] != identifier) {
+            return nullptr;
+        }
+        trace.load(&analyzers[slot], sizeof(IAnalyzer *), depth + 1);
+        return analyzers[slot];
+    }
+
+    template<class Visitor>
+    void forEach(Visitor visit) const {
+        for (size_t slot = 0; slot < keys.size(); slot++) {
+            if (analyzers[slot] != nullptr) {
+                visit(keys[slot], analyzers[slot]);
+            }
+        }
+    }
+
+    template<class Free>
+    void release(Free free) {
+        for (auto &current : analyzers) {
+            if (current != nullptr) {
+                free(current);
+                current = nullptr;
+            }
+        }
+    }
+
+    [[nodiscard]] size_t realSize() const {
+        return keys.size() * (sizeof(identifier_t) + sizeof(IAnalyzer *));
+    }
+
+private:
+    tracked_vector<identifier_t> keys;
+    tracked_vector<IAnalyzer *> analyzers;
+    tracked_vector<AnalyzerKind> kinds;
+};
+
+/**
+ * Key and handle packed into 4 bytes, 16 slots to a cache line: the low half is the key, the high half the index of
+ * the analyzer in a dense array in slot order. Handle 0 is a nullptr, so empty slots and key mismatches end in the same
+ * load without a branch. Holds at most PACKED_SLOTS_MAX_ANALYZERS analyzers.
+ */
+#define PACKED_SLOTS_MAX_ANALYZERS 0xFFFF
+
+class PackedSlots {
+public:
+    static_assert(sizeof(identifier_t) <= 2, "Packed slots need identifiers of at most 16 bits.");
+    static constexpr size_t MAX_ANALYZERS = PACKED_SLOTS_MAX_ANALYZERS;
+
+    explicit PackedSlots(MemoryTracker *tracker)
+            : slots(TrackingAllocator<uint32_t>(tracker, MemoryCategory::TABLE)),
+              analyzers(1, nullptr, TrackingAllocator<IAnalyzer *>(tracker, MemoryCategory::TABLE)),
+              kinds(1, AnalyzerKind::UNKNOWN, TrackingAllocator<AnalyzerKind>(tracker, MemoryCategory::METADATA)) {}
+
+    void assign(size_t count) {
+        slots.assign(count, 0);
+        analyzers.assign(1, nullptr);
+        kinds.assign(1, AnalyzerKind::UNKNOWN);
+    }
+
+    void assign(const std::vector<Value> &values) {
+        assign(values.size());
+        for (size_t slot = 0; slot < values.size(); slot++) {
+            set(slot, values[slot].first, values[slot].second);
+        }
+    }
+
+    // Throws std::length_error if there is no handle left, tables check MAX_ANALYZERS before
+    void set(size_t slot, identifier_t key, IAnalyzer *analyzer) {
+        uint32_t handle = slots[slot] >> 16;
+        if (handle == 0 && analyzer != nullptr) {
+            if (analyzers.size() > PACKED_SLOTS_MAX_ANALYZERS) {
+                throw std::length_error("Packed slots hold at most " + std::to_string(PACKED_SLOTS_MAX_ANALYZERS) +
+                                        " analyzers.");
+            }
+            handle = analyzers.size();
+            analyzers.push_back(nullptr);
+            kinds.push_back(AnalyzerKind::UNKNOWN);
+        }
+        analyzers[handle] = handle == 0 ? nullptr : analyzer;
+        kinds[handle] = AnalyzerRef::kindOf(analyzers[handle]);
+        slots[slot] = handle << 16 | key;
+    }
+
+    [[nodiscard]] size_t size() const {
+        return slots.size();
+    }
+
+    [[nodiscard]] identifier_t key(size_t slot) const {
+        return static_cast<identifier_t>(slots[slot]);
+    }
+
+    [[nodiscard]] IAnalyzer *analyzer(size_t slot) const {
+        return analyzers[slots[slot] >> 16];
+    }
+
+    [[nodiscard]] IAnalyzer *find(size_t slot, identifier_t identifier) const {
+        uint32_t entry = slots[slot];
+        return static_cast<identifier_t>(entry) == identifier ? analyzers[entry >> 16] : nullptr;
+    }
+
+    // A mismatch selects handle 0
+    [[nodiscard]] IAnalyzer *findBranchless(size_t slot, identifier_t identifier) const {
+        uint32_t entry = slots[slot];
+        uint32_t match = static_cast<identifier_t>(entry) == identifier;
+        return analyzers[(entry >> 16) & -match];
+    }
+
+    // The tags are indexed by the handle like the analyzers
+    [[nodiscard]] AnalyzerRef ref(size_t slot, identifier_t identifier) const {
+        uint32_t entry = slots[slot];
+        if (static_cast<identifier_t>(entry) != identifier) {
+            return AnalyzerRef();
+        }
+        return AnalyzerRef(kinds[entry >> 16], analyzers[entry >> 16]);
+    }
+
+    // Up to two dependent accesses: the slot, then the analyzer its handle selects if the key matches
+    bool probe(LookupProbe &probe, size_t slot, uint32_t step, IAnalyzer *&result) const {
+        switch (step) {
+            case 0:
+                probe.address = &slots[slot];
+                return false;
+            case 1:
+                if (static_cast<identifier_t>(slots[slot]) != probe.identifier) {
+                    result = nullptr;
+                    return true;
+                }
+                probe.address = &analyzers[slots[slot] >> 16];
+                return false;
+            default:
+                result = analyzers[slots[slot] >> 16];
+                return true;
+        }
+    }
+
+    IAnalyzer *trace(size_t slot, identifier_t identifier, LookupTrace &trace, uint32_t depth) const {
+        trace.load(&slots[slot], sizeof(uint32_t), depth);
+        if (static_cast<identifier_t>(slots[slot]) != identifier) {
+            return nullptr;
+        }
+        trace.load(&analyzers[slots[slot] >> 16], sizeof(IAnalyzer *), depth + 1);
+        return analyzers[slots[slot] >> 16];
+    }
+
+    template<class Visitor>
+    void forEach(Visitor visit) const {
+        for (const auto &current : slots) {
+            if (analyzers[current >> 16] != nullptr) {
+                visit(static_cast<identifier_t>(current), analyzers[current >> 16]);
+            }
+        }
+    }
+
+    // Keeps the keys, the handles are dropped with the analyzers
+    template<class Free>
+    void release(Free free) {
+        for (auto &current : slots) {
+            if (analyzers[current >> 16] != nullptr) {
+                free(analyzers[current >> 16]);
+            }
+            current &= 0xFFFF;
+        }
+        analyzers.assign(1, nullptr);
+        kinds.assign(1, AnalyzerKind::UNKNOWN);
+    }
+
+    [[nodiscard]] size_t realSize() const {
+        return slots.size() * sizeof(uint32_t) + (analyzers.size() - 1) * sizeof(IAnalyzer *);
+    }
+
+private:
+    tracked_vector<uint32_t> slots;
+    tracked_vector<IAnalyzer *> analyzers;
+    tracked_vector<AnalyzerKind> kinds;
+};
+
+#endif //PROTOTYPE_SLOTLAYOUT_H
@@ -13,30 +13,32 @@ public:
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
 //    void registerAnalyzers(const std::unordered_map<identifier_t, analyzer_builder> &analyzer_builders) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override;
     size_t size() override;
     void clear() override;
 
     size_t real_size() override;
 
 protected:
-    using table_t = std::vector<IAnalyzer*>;
+    using table_t = tracked_vector<IAnalyzer*>;
+    using fragment_map = tracked_map<identifier_t, table_t>;
 
     uint32_t maxGap;
     // Maps the range as "lowest-identifier" (e.g. range 6-10 is 6) to the vector that contains the range
-    std::map<identifier_t, table_t> map;
+    fragment_map map{trackedAllocator<fragment_map::value_type>(MemoryCategory::NODES)};
 
     inline void createFragment(identifier_t identifier, const analyzer_builder &make_analyzer) {
         // Insert the new element as first element in the fragment.
-        table_t newFragment;
-        newFragment.push_back(make_analyzer());
+        table_t newFragment(trackedAllocator<IAnalyzer*>(MemoryCategory::TABLE));
+        newFragment.push_back(buildAnalyzer(make_analyzer));
         map.emplace(identifier, std::move(newFragment));
     }
 
-    inline void mergeFragments(std::map<identifier_t, table_t>::iterator firstFragment,
-            std::map<identifier_t, table_t>::iterator secondFragment,
+    inline void mergeFragments(fragment_map::iterator firstFragment,
+            fragment_map::iterator secondFragment,
             identifier_t interFragmentSpaceSize,
             identifier_t idOfNewFragment) {
-        table_t newFragment;
+        table_t newFragment(trackedAllocator<IAnalyzer*>(MemoryCategory::TABLE));
         newFragment.reserve(firstFragment->second.size() + secondFragment->second.size());
         // Add all entries from the first fragment
         for (const auto &current : firstFragment->second) {
@@ -79,7 +81,7 @@ private:
         return nullCounter;
     }
 
-    inline void compress(std::map<identifier_t, table_t>::iterator firstFragment, std::map<identifier_t, table_t>::iterator secondFragment) {
+    inline void compress(fragment_map::iterator firstFragment, fragment_map::iterator secondFragment) {
         // If the gap between firstFragment->upperBound and secondFragment->lowerBound is too large, don't compress
         size_t interFragmentSpaceSize = secondFragment->first - (firstFragment->first + firstFragment->second.size());
         if (interFragmentSpaceSize > maxGap) {
@@ -11,6 +11,8 @@ public:
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override;
+    IAnalyzer *lookupBranchless(identifier_t identifier) override;
 
 private:
     void stringifyAnalyzersState(std::ostream &os) const override;
@@ -27,7 +29,7 @@ private:
         return nullCounter;
     }
 
-    inline void compress(std::map<identifier_t, table_t>::iterator firstFragment, std::map<identifier_t, table_t>::iterator secondFragment) {
+    inline void compress(fragment_map::iterator firstFragment, fragment_map::iterator secondFragment) {
         // If the gap between firstFragment->upperBound and secondFragment->lowerBound is too large, don't compress
         size_t interFragmentSpaceSize = (secondFragment->first - secondFragment->second.size()) - firstFragment->first;
         if (interFragmentSpaceSize > maxGap) {
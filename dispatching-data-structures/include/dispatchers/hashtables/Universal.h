@@ -4,15 +4,40 @@
 
 #include "Defines.h"
 #include "dispatchers/IDispatcher.h"
-
-class Universal : public IDispatcher {
+#include "dispatchers/hashtables/SlotLayout.h"
+
+/**
+ * Hash table with a collision free universal hash function, one slot per bucket. The layout of the slots is a
+ * template parameter (see SlotLayout.h), Universal is the pair layout.
+ */
+template<class Layout>
+class BasicUniversal : public IDispatcher {
 public:
-    Universal();
-    ~Universal() override;
+    BasicUniversal();
+    ~BasicUniversal() override;
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     void registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *lookupBranchless(identifier_t identifier) override;
+    AnalyzerRef lookupRef(identifier_t identifier) override {
+        return table.ref(hash(identifier), identifier);
+    }
+    void lookupInterleaved(const identifier_t *identifiers, size_t count, IAnalyzer **results,
+                           size_t groupSize) override {
+        interleavedLookup(*this, identifiers, count, results, groupSize);
+    }
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override {
+        return table.trace(hash(identifier), identifier, trace, 0);
+    }
+
+    // The accesses of the bucket of the identifier, one or two depending on the layout
+    bool probe(LookupProbe &probe, IAnalyzer *&result) const {
+        if (probe.stage == 0) {
+            probe.scratch = hash(probe.identifier);
+        }
+        return table.probe(probe, probe.scratch, probe.stage++, result);
+    }
     size_t size() override;
     void clear() override;
 
@@ -49,7 +74,7 @@ private:
     size_t allCounter;
     #endif
 
-    std::vector<Value> table;
+    Layout table{tracker};
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
@@ -88,11 +113,13 @@ private:
 
     inline std::vector<Value> createIntermediate() {
         std::vector<Value> intermediate;
-        for (const auto &current : table) {
-            if (current.second != nullptr) {
-                intermediate.emplace_back(current.first, current.second);
-            }
-        }
+        table.forEach([&intermediate](identifier_t key, IAnalyzer *analyzer) {
+            intermediate.emplace_back(key, analyzer);
+        });
         return intermediate;
     }
-};
\ No newline at end of file
+};
+
+using Universal = BasicUniversal<PairSlots>;
+using UniversalSplit = BasicUniversal<SplitSlots>;
+using UniversalPacked = BasicUniversal<PackedSlots>;
\ No newline at end of file
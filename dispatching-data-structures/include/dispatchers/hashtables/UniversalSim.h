@@ -5,15 +5,18 @@
 
 #include "Defines.h"
 #include "dispatchers/IDispatcher.h"
+#include "dispatchers/hashtables/SlotLayout.h"
 
-class UniversalSim : public IDispatcher {
+template<class Layout>
+class BasicUniversalSim : public IDispatcher {
 public:
-    UniversalSim();
-    ~UniversalSim() override;
+    BasicUniversalSim();
+    ~BasicUniversalSim() override;
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     void registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override;
     size_t size() override;
     void clear() override;
 
@@ -74,7 +77,7 @@ private:
     size_t allCounter;
     #endif
 
-    std::vector<Value> table;
+    Layout table{tracker};
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
@@ -107,11 +110,13 @@ private:
 
     inline std::vector<Value> createIntermediate() {
         std::vector<Value> intermediate;
-        for (const auto &current : table) {
-            if (current.second != nullptr) {
-                intermediate.emplace_back(current.first, current.second);
-            }
-        }
+        table.forEach([&intermediate](identifier_t key, IAnalyzer *analyzer) {
+            intermediate.emplace_back(key, analyzer);
+        });
         return intermediate;
     }
-};
\ No newline at end of file
+};
+
+using UniversalSim = BasicUniversalSim<PairSlots>;
+using UniversalSimSplit = BasicUniversalSim<SplitSlots>;
+using UniversalSimPacked = BasicUniversalSim<PackedSlots>;
\ No newline at end of file
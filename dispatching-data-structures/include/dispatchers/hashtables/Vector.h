@@ -5,19 +5,45 @@
 
 class Vector : public IDispatcher {
 public:
-    Vector() : lowestIdentifier(0), table(std::vector<IAnalyzer*>(1, nullptr)) {}
+    Vector() : lowestIdentifier(0), table(1, nullptr, trackedAllocator<IAnalyzer*>(MemoryCategory::TABLE)),
+               kinds(1, AnalyzerKind::UNKNOWN, trackedAllocator<AnalyzerKind>(MemoryCategory::METADATA)) {}
     ~Vector() override;
 
     bool registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) override;
     void registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) override;
     IAnalyzer *lookup(identifier_t identifier) override;
+    IAnalyzer *lookupBranchless(identifier_t identifier) override;
+    AnalyzerRef lookupRef(identifier_t identifier) override;
+    void lookupInterleaved(const identifier_t *identifiers, size_t count, IAnalyzer **results,
+                           size_t groupSize) override {
+        interleavedLookup(*this, identifiers, count, results, groupSize);
+    }
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override {
+        return traceProbes(*this, identifier, trace);
+    }
+
+    // One access: the slot of the identifier, identifiers outside of the table need none
+    bool probe(LookupProbe &probe, IAnalyzer *&result) const {
+        int64_t index = probe.identifier - lowestIdentifier;
+        if (index < 0 || static_cast<size_t>(index) >= table.size()) {
+            result = nullptr;
+            return true;
+        } else if (probe.stage++ == 0) {
+            probe.address = &table[index];
+            return false;
+        }
+        result = table[index];
+        return true;
+    }
     size_t size() override;
     size_t real_size() override;
     void clear() override;
 
 private:
     identifier_t lowestIdentifier;
-    std::vector<IAnalyzer*> table;
+    tracked_vector<IAnalyzer*> table;
+    // Type tag of every slot for lookupRef(), always as long as the table
+    tracked_vector<AnalyzerKind> kinds;
     void stringifyAnalyzersState(std::ostream &os) const override;
 
     void freeAnalyzers();
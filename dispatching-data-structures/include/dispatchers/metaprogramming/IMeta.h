@@ -13,6 +13,11 @@ public:
         return 0;
     }
 
+    // The generated if-chains and switches compare the identifier in code, only jump tables of switches load data
+    IAnalyzer *traceLookup(identifier_t identifier, LookupTrace &trace) override {
+        return lookup(identifier);
+    }
+
 private:
     size_t _size = 0;
 };
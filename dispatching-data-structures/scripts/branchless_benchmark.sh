@@ -0,0 +1,37 @@
+#!/bin/bash
+# Compares the branchy and the branchless lookups of every dispatcher on predictable (ABOX, static) and unpredictable
+# (uniform, Zipf) traces. Writes one Google Benchmark CSV per trace with branch misses per lookup to results/, the
+# counters are hardware events if the PMU is available.
+
+critical() {
+    echo "$1"
+    exit 1
+}
+
+SCRIPTPATH="$( cd "$(dirname "$0")" > /dev/null 2>&1 || critical 'Could not determine script path.' ; pwd -P )"
+BENCHMARK="$SCRIPTPATH/../build/benchmark"
+MAPPING="$SCRIPTPATH/../input/analyzers/zeek"
+PDUS=${PDUS:-10000000}
+REPETITIONS=${REPETITIONS:-5}
+
+if [ ! -x "$BENCHMARK" ]; then
+    critical "The benchmark is missing, build the project first."
+fi
+
+mkdir -p results || critical "Could not create result directory."
+cd results || critical "Could not cd into result directory."
+
+# ABOX has seven packet types of about three PDUs each
+python3 "$SCRIPTPATH"/gen_packet.py abox -n $((PDUS / 21)) -o branchless_abox > /dev/null || critical "Could not generate the ABOX trace."
+python3 "$SCRIPTPATH"/gen_packet.py static -n "$PDUS" -o branchless_static > /dev/null || critical "Could not generate the static trace."
+
+run() {
+    echo "Running the $1 trace..."
+    taskset 0x1 "$BENCHMARK" "$2" "$MAPPING" "$REPETITIONS" branchless counters --benchmark_format=csv > "branchless_$1.csv" \
+        || critical "The benchmark failed on the $1 trace."
+}
+
+run abox branchless_abox
+run static branchless_static
+run uniform "generate:uniform:pdus=$PDUS,from=$MAPPING"
+run zipf "generate:zipf:pdus=$PDUS,s=1.1,from=$MAPPING"
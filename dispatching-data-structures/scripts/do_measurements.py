@@ -80,7 +80,7 @@ def run_benchmark(iteration_count: int, packet_file: str, analyzer_mapping_file:
     )
 
 
-def run_benchmark_ex(iteration_count: int, packet_file: str, analyzer_mapping_file: str, executable: str, startup: bool):
+def run_benchmark_ex(iteration_count: int, packet_file: str, analyzer_mapping_file: str, executable: str, startup: bool, keywords: str = ""):
     ensure_file_exists(analyzer_mapping_file)
     ensure_file_exists(executable)
 
@@ -98,7 +98,7 @@ def run_benchmark_ex(iteration_count: int, packet_file: str, analyzer_mapping_fi
             file=sys.stderr
         )
 
-        cmd = f"{executable} {current_packet_file} {analyzer_mapping_file} 1{' startup' if startup else ''} --benchmark_format=json"
+        cmd = f"{executable} {current_packet_file} {analyzer_mapping_file} 1{' startup' if startup else ''}{keywords} --benchmark_format=json"
         p = subprocess.Popen(
             shlex.split(f"taskset 0x1 {cmd}"),
             stdout=subprocess.PIPE,
@@ -144,7 +144,7 @@ def run_benchmark_ex(iteration_count: int, packet_file: str, analyzer_mapping_fi
     )
 
 
-def run_cache_analysis(iteration_count: int, packet_file: str, analyzer_mapping_file: str, executable: str):
+def run_cache_analysis(iteration_count: int, packet_file: str, analyzer_mapping_file: str, executable: str, keywords: str = ""):
     ensure_file_exists(packet_file)
     ensure_file_exists(analyzer_mapping_file)
     ensure_file_exists(executable)
@@ -155,7 +155,7 @@ def run_cache_analysis(iteration_count: int, packet_file: str, analyzer_mapping_
     measurements = []
 
     for iteration in range(iteration_count):
-        cmd = f"{executable} {packet_file} {analyzer_mapping_file}"
+        cmd = f"{executable} {packet_file} {analyzer_mapping_file}{keywords}"
         p = subprocess.Popen(
             shlex.split(f"taskset 0x1 {cmd}"),
             stdout=subprocess.PIPE,
@@ -221,8 +221,23 @@ if __name__ == "__main__":
         "--startup", "-s", action="store_true",
         help="Run startup time instead of dispatching time benchmark."
     )
+    parser.add_argument(
+        "--invoke", "-i", action="store_true",
+        help="Call the analyzer returned by every lookup instead of only doing the lookup."
+    )
+    parser.add_argument(
+        "--arena", "-a", action="store_true",
+        help="Additionally measure every data structure with analyzers placed in an analyzer arena."
+    )
+    parser.add_argument(
+        "--work", "-w", default=None,
+        help="Work every analyzer does per PDU when invoked: counter, header or bytes:<N>."
+    )
     args = parser.parse_args()
 
+    keywords = (" invoke" if args.invoke else "") + (" arena" if args.arena else "")
+    if args.work:
+        keywords += f" work={args.work}"
 
     iterations = 10
     if os.path.basename(args.executable) == "benchmark":
@@ -253,7 +268,8 @@ if __name__ == "__main__":
                     os.path.join(PROJECT_ROOT, benchmark_run[0]),
                     os.path.join(PROJECT_ROOT, benchmark_run[1]),
                     args.executable,
-                    args.startup
+                    args.startup,
+                    keywords
                 )
             )
 
@@ -276,7 +292,8 @@ if __name__ == "__main__":
                     iterations,
                     os.path.join(PROJECT_ROOT, cache_run[0]),
                     os.path.join(PROJECT_ROOT, cache_run[1]),
-                    args.executable
+                    args.executable,
+                    keywords
                 )
             )
 
@@ -43,6 +43,24 @@ def clearFiles():
         os.unlink(path)
 
 
+def memberRegions(table=False):
+    # The analyzers are the members the generated class adds to IMeta, the lookup table is declared after them
+    analyzersEnd = "reinterpret_cast<const char*>(table)" if table else "reinterpret_cast<const char*>(this) + sizeof(*this)"
+    regions = [
+        "MemoryRegion{MemoryCategory::ANALYZERS, analyzers, static_cast<size_t>(" + analyzersEnd + " - analyzers), false}"
+    ]
+    if table:
+        regions.append("MemoryRegion{MemoryCategory::TABLE, table, sizeof(table), false}")
+    return [
+        "std::vector<MemoryRegion> inlineRegions() const override {",
+        [
+            "const char* analyzers = reinterpret_cast<const char*>(this) + sizeof(IMeta);",
+            "return {" + ", ".join(regions) + "};"
+        ],
+        "}"
+    ]
+
+
 def generateSwitch(path: str):
     with open(path, "r") as analyzerFile:
         content = analyzerFile.readlines()
@@ -76,6 +94,7 @@ def generateSwitch(path: str):
     declarations = [
         "void stringifyAnalyzersState(std::ostream &os) const override;"
     ]
+    declarations += memberRegions()
     for analyzer in analyzers:
         declarations.append(analyzer.getDeclaration())
     header.append(declarations)
@@ -137,13 +156,15 @@ def generateIf(path: str):
         "class " + classname + " : public IMeta {",
         "public:",
         [
-            "IAnalyzer* lookup(identifier_t identifier) override;"
+            "IAnalyzer* lookup(identifier_t identifier) override;",
+            "IAnalyzer* lookupBranchless(identifier_t identifier) override;"
         ],
         "private:"
     ]
     declarations = [
         "void stringifyAnalyzersState(std::ostream &os) const override;"
     ]
+    declarations += memberRegions()
     for analyzer in analyzers:
         declarations.append(analyzer.getDeclaration())
     header.append(declarations)
@@ -168,6 +189,17 @@ def generateIf(path: str):
     functionContent.append("}")
     cpp.append(functionContent)
     cpp.append("}")
+    # Branchless variant: every comparison masks the address of its analyzer, at most one of them matches
+    cpp.append("IAnalyzer* " + classname + "::lookupBranchless(identifier_t identifier) {")
+    functionContent = [
+        "uintptr_t result = 0;"
+    ]
+    for analyzer in analyzers:
+        functionContent.append("result |= reinterpret_cast<uintptr_t>(maskAnalyzer(identifier == 0x" + analyzer.identifier
+                               + ", &" + analyzer.getCanonicalName() + "));")
+    functionContent.append("return reinterpret_cast<IAnalyzer*>(result);")
+    cpp.append(functionContent)
+    cpp.append("}")
     cpp.append("void " + classname + "::stringifyAnalyzersState(std::ostream &os) const {")
     functionContent = []
     for idx, analyzer in enumerate(analyzers):
@@ -205,13 +237,16 @@ def generateArray(path: str):
         "class " + classname + " : public IMeta {",
         "public:",
         [
-            "IAnalyzer* lookup(identifier_t identifier) override;"
+            "IAnalyzer* lookup(identifier_t identifier) override;",
+            "IAnalyzer* lookupBranchless(identifier_t identifier) override;",
+            "IAnalyzer* traceLookup(identifier_t identifier, LookupTrace &trace) override;"
         ],
         "private:"
     ]
     declarations = [
         "void stringifyAnalyzersState(std::ostream &os) const override;"
     ]
+    declarations += memberRegions(table=True)
     for analyzer in analyzers:
         declarations.append(analyzer.getDeclaration())
     lowest_identifier = int(analyzers[0].identifier, 16)
@@ -254,6 +289,26 @@ def generateArray(path: str):
     ]
     cpp.append(callanalyzer_content)
     cpp.append("}")
+    # Branchless variant: identifiers below the table wrap around, out of range indices read the first slot and are masked
+    cpp.append("IAnalyzer* " + classname + "::lookupBranchless(identifier_t identifier) {")
+    cpp.append([
+        "uint64_t index = static_cast<uint64_t>(identifier) - " + str(lowest_identifier) + ";",
+        "bool inRange = index < " + str(highest_identifier - lowest_identifier + 1) + ";",
+        "return maskAnalyzer(inRange, table[index & -static_cast<uint64_t>(inRange)]);",
+    ])
+    cpp.append("}")
+    cpp.append("IAnalyzer* " + classname + "::traceLookup(identifier_t identifier, LookupTrace &trace) {")
+    cpp.append([
+        "int64_t index = identifier - " + str(lowest_identifier) + ";",
+        "if (index < 0 || index >= " + str(highest_identifier - lowest_identifier + 1) + ") {",
+        [
+            "return nullptr;",
+        ],
+        "}",
+        "trace.load(&table[index], sizeof(IAnalyzer*), 0);",
+        "return table[index];",
+    ])
+    cpp.append("}")
     cpp.append("void " + classname + "::stringifyAnalyzersState(std::ostream &os) const {")
     stringify_content = []
     for idx, analyzer in enumerate(analyzers):
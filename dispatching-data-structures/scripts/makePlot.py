@@ -204,13 +204,11 @@ def plot_DispatchTimesAndCacheCIC_IDS(args):
 
 	# Get cache hits for all traces
 	cache_l1_dict = dict()
-	cache_l2_dict = dict()
-	cache_l3_dict = dict()
+	cache_llc_dict = dict()
 	for json_data in json_cache_mapping:
 		tn = json_data["trace_name"]
 		cache_l1_dict[tn] = filter_cache_misses(json_data["measurements"], "l1")
-		cache_l2_dict[tn] = filter_cache_misses(json_data["measurements"], "l2")
-		cache_l3_dict[tn] = filter_cache_misses(json_data["measurements"], "l3")
+		cache_llc_dict[tn] = filter_cache_misses(json_data["measurements"], "llc")
 
 	# Combine all traces in a data frame
 	combi = pd.DataFrame({
@@ -219,8 +217,7 @@ def plot_DispatchTimesAndCacheCIC_IDS(args):
 
 	cache = pd.DataFrame({
 		"L1": cache_l1_dict["cic-ids17-mon"].loc["mean"],
-		"L2": cache_l2_dict["cic-ids17-mon"].loc["mean"],
-		"L3": cache_l3_dict["cic-ids17-mon"].loc["mean"]},
+		"LLC": cache_llc_dict["cic-ids17-mon"].loc["mean"]},
 		index=times_dict["cic-ids17-mon"].loc["mean"].index)
 
 	print(cache)
@@ -247,7 +244,7 @@ def plot_DispatchTimesAndCacheCIC_IDS(args):
 	ax3.set_yscale('log')
 	rspine = ax3.spines['right']
 	rspine.set_position(('axes', 1.25))
-	ax3.scatter(np.arange(len(cache.index)), cache['L2'], marker='x', color="black")
+	ax3.scatter(np.arange(len(cache.index)), cache['LLC'], marker='x', color="black")
 
 	plt.setp(ax.get_xticklabels(), ha="right", rotation=45)
 	fig.tight_layout()
@@ -263,26 +260,24 @@ def plot_CacheMissesCIC_IDS(args):
 
 	# Get cache hits for all traces
 	cache_l1_dict = dict()
-	cache_l2_dict = dict()
-	cache_l3_dict = dict()
+	cache_llc_dict = dict()
 	for json_data in json_cache_mapping:
 		tn = json_data["trace_name"]
 		cache_l1_dict[tn] = filter_cache_misses(json_data["measurements"], "l1")
-		cache_l2_dict[tn] = filter_cache_misses(json_data["measurements"], "l2")
-		cache_l3_dict[tn] = filter_cache_misses(json_data["measurements"], "l3")
+		cache_llc_dict[tn] = filter_cache_misses(json_data["measurements"], "llc")
 
 	# Combine all Levels in a data frame
 	cache_l1 = pd.DataFrame({
 		"L1": cache_l1_dict["cic-ids17-mon"].loc["mean"]},
 		index=cache_l1_dict["cic-ids17-mon"].loc["mean"].index)
-	cache_l2 = pd.DataFrame({
-		"L2": cache_l2_dict["cic-ids17-mon"].loc["mean"]},
+	cache_llc = pd.DataFrame({
+		"LLC": cache_llc_dict["cic-ids17-mon"].loc["mean"]},
 		index=cache_l1_dict["cic-ids17-mon"].loc["mean"].index)
 
 	err_l1 = pd.DataFrame({
 		"CIC-IDS17": cache_l1_dict["cic-ids17-mon"].loc["cf"]})
-	err_l2 = pd.DataFrame({
-		"CIC-IDS17": cache_l2_dict["cic-ids17-mon"].loc["cf"]})
+	err_llc = pd.DataFrame({
+		"CIC-IDS17": cache_llc_dict["cic-ids17-mon"].loc["cf"]})
 
 	fig, ax = plt.subplots()
 	fig.set_figheight(PLOT_HEIGHT)
@@ -301,13 +296,13 @@ def plot_CacheMissesCIC_IDS(args):
 		ylabel="L1 misses",
 		legend=False)
 
-	cache_l2.plot(kind="bar",
+	cache_llc.plot(kind="bar",
 		ax=ax2,
-		yerr=err_l2.T.values.tolist(),
+		yerr=err_llc.T.values.tolist(),
 		edgecolor='black', color="gray",
 		width=0.4,
 		position=0,
-		ylabel="L2 misses",
+		ylabel="LLC misses",
 		legend=False)
 
 	ax.legend(loc='upper left')
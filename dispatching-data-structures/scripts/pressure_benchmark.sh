@@ -0,0 +1,55 @@
+#!/bin/bash
+# Ranks the dispatchers with warm caches and under cache pressure: evicting the dispatcher every packet or every 64
+# packets, and touching a working set of 32 KiB to 4 MiB before every packet. Writes one Google Benchmark CSV per
+# configuration to results/ and prints the rank of every dispatcher in each of them, ordered by the time per lookup.
+
+critical() {
+    echo "$1"
+    exit 1
+}
+
+SCRIPTPATH="$( cd "$(dirname "$0")" > /dev/null 2>&1 || critical 'Could not determine script path.' ; pwd -P )"
+BENCHMARK="$SCRIPTPATH/../build/benchmark"
+MAPPING="$SCRIPTPATH/../input/analyzers/zeek"
+PDUS=${PDUS:-1000000}
+REPETITIONS=${REPETITIONS:-5}
+TRACE="generate:zipf:pdus=$PDUS,s=1.1,from=$MAPPING"
+CONFIGURATIONS=(warm evict=1 evict=64 evict=64:thrash pollute=32 pollute=256 pollute=1024 pollute=4096)
+
+if [ ! -x "$BENCHMARK" ]; then
+    critical "The benchmark is missing, build the project first."
+fi
+
+mkdir -p results || critical "Could not create result directory."
+cd results || critical "Could not cd into result directory."
+
+for configuration in "${CONFIGURATIONS[@]}"; do
+    echo "Running $configuration..."
+    keyword=$configuration
+    if [ "$configuration" == "warm" ]; then
+        # Plain lookups do not report lookup_ns, pollute the caches with a single line instead
+        keyword=pollute=1
+    fi
+    taskset 0x1 "$BENCHMARK" "$TRACE" "$MAPPING" "$REPETITIONS" "$keyword" --benchmark_format=csv \
+        > "pressure_${configuration//[=:]/_}.csv" || critical "The benchmark failed for $configuration."
+done
+
+python3 - "${CONFIGURATIONS[@]}" <<'EOF'
+import csv
+import sys
+
+# Median time per lookup of every dispatcher, the rows of single repetitions are skipped if there are aggregates
+ranks = {}
+for configuration in sys.argv[1:]:
+    with open("pressure_" + configuration.replace("=", "_").replace(":", "_") + ".csv") as file:
+        lines = file.readlines()
+    rows = list(csv.DictReader(lines[next(i for i, line in enumerate(lines) if line.startswith("name,")):]))
+    medians = [row for row in rows if row["name"].endswith("_median")] or rows
+    times = {row["name"].split("/")[0]: float(row["lookup_ns"]) for row in medians}
+    for rank, name in enumerate(sorted(times, key=times.get)):
+        ranks.setdefault(name, {})[configuration] = (rank + 1, times[name])
+
+print("dispatcher," + ",".join(sys.argv[1:]))
+for name, results in sorted(ranks.items(), key=lambda item: item[1][sys.argv[1]][0]):
+    print(name + "," + ",".join("%d (%.1f ns)" % results[configuration] for configuration in sys.argv[1:]))
+EOF
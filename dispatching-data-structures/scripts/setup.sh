@@ -43,7 +43,7 @@ echo "Generating measurements..."
 chmod +x benchmark
 chmod +x cache_analyzer
 
-# Check PAPI performance counters
-if ! ./cache_analyzer papi_check > /dev/null 2>&1; then
-    critical "The necessary PAPI performance counters are not available on your system. Check ./build/papi/papi-install/bin/papi_component_avail for info why that might be the case."
+# Check hardware performance counters
+if ! ./cache_analyzer perf_check > /dev/null 2>&1; then
+    critical "The necessary hardware performance counters are not available on your system. Check /proc/sys/kernel/perf_event_paranoid and whether your hypervisor exposes the PMU."
 fi
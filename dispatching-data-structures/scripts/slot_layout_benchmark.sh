@@ -0,0 +1,35 @@
+#!/bin/bash
+# Compares the pair, split and packed slot layouts of Hanov and Universal on hit-heavy and miss-heavy uniform traces.
+# Writes one Google Benchmark CSV per hit ratio with cache and dTLB misses per lookup to results/, and the lines every
+# lookup touches according to the cache simulator.
+
+critical() {
+    echo "$1"
+    exit 1
+}
+
+SCRIPTPATH="$( cd "$(dirname "$0")" > /dev/null 2>&1 || critical 'Could not determine script path.' ; pwd -P )"
+BENCHMARK="$SCRIPTPATH/../build/benchmark"
+CACHE_ANALYZER="$SCRIPTPATH/../build/cache_analyzer"
+MAPPING=${MAPPING:-"$SCRIPTPATH/../input/analyzers/fragmented"}
+PDUS=${PDUS:-10000000}
+REPETITIONS=${REPETITIONS:-5}
+
+if [ ! -x "$BENCHMARK" ] || [ ! -x "$CACHE_ANALYZER" ]; then
+    critical "The benchmark is missing, build the project first."
+fi
+
+mkdir -p results || critical "Could not create result directory."
+cd results || critical "Could not cd into result directory."
+
+run() {
+    echo "Running the $1 trace..."
+    local trace="generate:uniform:pdus=$PDUS,hits=$2,from=$MAPPING"
+    taskset 0x1 "$BENCHMARK" "$trace" "$MAPPING" "$REPETITIONS" slots counters --benchmark_filter='Hanov|Universal' \
+        --benchmark_format=csv > "slots_$1.csv" || critical "The benchmark failed on the $1 trace."
+    "$CACHE_ANALYZER" "$trace" "$MAPPING" simulate slots > "slots_$1_simulated.csv" \
+        || critical "The cache simulation failed on the $1 trace."
+}
+
+run hits 1
+run misses 0.1
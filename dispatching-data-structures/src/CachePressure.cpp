@@ -0,0 +1,47 @@
+#include "CachePressure.h"
+
+#include <algorithm>
+#include <numeric>
+#include <random>
+
+#if CACHE_PRESSURE_CLFLUSH
+#include <x86intrin.h>
+#endif
+
+// Seed of the order the lines are touched in, every run touches them in the same order
+#define CACHE_PRESSURE_SEED 0x9e3779b97f4a7c15ull
+
+CachePressure::CachePressure(size_t bytes) {
+    size_t count = std::max<size_t>(1, (bytes + MEMORY_CACHE_LINE_SIZE - 1) / MEMORY_CACHE_LINE_SIZE);
+    buffer = std::make_unique<Line[]>(count);
+    lines.resize(count);
+    std::iota(lines.begin(), lines.end(), 0);
+    std::shuffle(lines.begin(), lines.end(), std::mt19937_64(CACHE_PRESSURE_SEED));
+}
+
+void CachePressure::touch() {
+    // Writes, so the lines become dirty like the state of analyzers and flow tables
+    for (const auto &line : lines) {
+        buffer[line].value++;
+    }
+}
+
+void CachePressure::flush(const std::vector<MemoryRegion> &regions) {
+#if CACHE_PRESSURE_CLFLUSH
+    for (const auto &region : regions) {
+        if (region.bytes == 0) {
+            continue;
+        }
+        auto first = reinterpret_cast<uintptr_t>(region.address) / MEMORY_CACHE_LINE_SIZE;
+        auto last = (reinterpret_cast<uintptr_t>(region.address) + region.bytes - 1) / MEMORY_CACHE_LINE_SIZE;
+        for (uintptr_t line = first; line <= last; line++) {
+            _mm_clflush(reinterpret_cast<const void *>(line * MEMORY_CACHE_LINE_SIZE));
+        }
+    }
+    _mm_mfence();
+#else
+    (void) regions;
+    static CachePressure thrash(CACHE_PRESSURE_THRASH_SIZE);
+    thrash.touch();
+#endif
+}
@@ -0,0 +1,225 @@
+#include "CacheSimulator.h"
+
+#include <algorithm>
+#include <stdexcept>
+#include <unordered_set>
+
+// Minimal number of times the Fenwick tree of the reuse distances holds, when full the live times are renumbered into
+// a tree of twice the distinct lines
+#define CACHE_SIMULATOR_INITIAL_TIMES 4096
+
+CacheLevelConfig CacheLevelConfig::parse(const std::string &name, const std::string &description,
+                                         size_t bytesPerUnit) {
+    size_t separator = description.find(':');
+    if (separator == std::string::npos) {
+        throw std::invalid_argument("Invalid " + name + " geometry " + description + " (expected <size>:<ways>).");
+    }
+    CacheLevelConfig config;
+    config.name = name;
+    try {
+        config.entries = std::stoul(description.substr(0, separator)) * bytesPerUnit;
+        config.associativity = std::stoul(description.substr(separator + 1));
+    } catch (std::logic_error &) {
+        throw std::invalid_argument("Invalid " + name + " geometry " + description + " (expected <size>:<ways>).");
+    }
+    if (config.entries == 0 || config.associativity == 0 || config.entries % config.associativity != 0) {
+        throw std::invalid_argument("The " + name + " entries cannot be split into sets of " +
+                                    std::to_string(config.associativity) + " ways.");
+    }
+    return config;
+}
+
+SetAssociativeCache::SetAssociativeCache(const CacheLevelConfig &config)
+        : sets(config.entries / config.associativity), associativity(config.associativity),
+          blocks(config.entries, UINT64_MAX), lastUse(config.entries, 0) {
+}
+
+bool SetAssociativeCache::access(uint64_t block) {
+    time++;
+    size_t first = (block % sets) * associativity;
+    size_t victim = first;
+    for (size_t way = first; way < first + associativity; way++) {
+        if (blocks[way] == block) {
+            lastUse[way] = time;
+            return true;
+        }
+        if (lastUse[way] < lastUse[victim]) {
+            victim = way;
+        }
+    }
+    blocks[victim] = block;
+    lastUse[victim] = time;
+    return false;
+}
+
+CacheSimulator::CacheSimulator(const CacheSimulatorConfig &config)
+        : tree(CACHE_SIMULATOR_INITIAL_TIMES, 0) {
+    for (const auto &level : config.caches) {
+        cacheNames.push_back(level.name);
+        caches.emplace_back(level);
+    }
+    for (const auto &level : config.tlbs) {
+        tlbNames.push_back(level.name);
+        tlbs.emplace_back(level);
+    }
+    cacheMisses.resize(caches.size());
+    tlbMisses.resize(tlbs.size());
+}
+
+void CacheSimulator::simulate(const LookupTrace &trace) {
+    std::unordered_set<uint64_t> lookupLines;
+    uint32_t maxDepth = 0;
+    for (const auto &access : trace.getAccesses()) {
+        auto address = reinterpret_cast<uintptr_t>(access.address);
+        uintptr_t last = address + std::max<uint32_t>(access.bytes, 1) - 1;
+        for (uintptr_t page = address / MEMORY_PAGE_SIZE; page <= last / MEMORY_PAGE_SIZE; page++) {
+            accessPage(page);
+        }
+        for (uintptr_t line = address / MEMORY_CACHE_LINE_SIZE; line <= last / MEMORY_CACHE_LINE_SIZE; line++) {
+            uint64_t simulated = lineOf(line * MEMORY_CACHE_LINE_SIZE);
+            lookupLines.insert(simulated);
+            accessLine(simulated);
+        }
+        maxDepth = std::max(maxDepth, access.depth + 1);
+        accesses++;
+    }
+    lines += lookupLines.size();
+    depth += maxDepth;
+    lookups++;
+}
+
+void CacheSimulator::resetStatistics() {
+    lookups = 0;
+    accesses = 0;
+    lines = 0;
+    depth = 0;
+    coldLines = 0;
+    std::fill(cacheMisses.begin(), cacheMisses.end(), 0);
+    std::fill(tlbMisses.begin(), tlbMisses.end(), 0);
+    reuseDistances = LatencyHistogram();
+    reuseDistanceSum = 0;
+}
+
+std::vector<std::string> CacheSimulator::getNames() const {
+    std::vector<std::string> names = {"accesses", "lines", "depth"};
+    for (const auto &name : cacheNames) {
+        names.push_back(name + "_misses");
+    }
+    for (const auto &name : tlbNames) {
+        names.push_back(name + "_misses");
+    }
+    names.insert(names.end(), {"cold_lines", "reuse_mean", "reuse_p50", "reuse_p90", "reuse_p99"});
+    return names;
+}
+
+std::vector<double> CacheSimulator::getValues() const {
+    auto perLookup = [this](double value) {
+        return lookups == 0 ? 0 : value / lookups;
+    };
+    std::vector<double> values = {perLookup(accesses), perLookup(lines), perLookup(depth)};
+    for (const auto &misses : cacheMisses) {
+        values.push_back(perLookup(misses));
+    }
+    for (const auto &misses : tlbMisses) {
+        values.push_back(perLookup(misses));
+    }
+    // The reuse distances only cover lines that were accessed before
+    uint64_t reused = reuseDistances.getCount();
+    values.push_back(perLookup(coldLines));
+    values.push_back(reused == 0 ? 0 : reuseDistanceSum / reused);
+    values.push_back(reuseDistances.percentile(0.5));
+    values.push_back(reuseDistances.percentile(0.9));
+    values.push_back(reuseDistances.percentile(0.99));
+    return values;
+}
+
+uint64_t CacheSimulator::lineOf(uintptr_t address) {
+    auto page = pages.emplace(address / MEMORY_PAGE_SIZE, pages.size()).first->second;
+    return (page * MEMORY_PAGE_SIZE + address % MEMORY_PAGE_SIZE) / MEMORY_CACHE_LINE_SIZE;
+}
+
+void CacheSimulator::accessLine(uint64_t line) {
+    uint64_t distance = reuseDistance(line);
+    if (distance == UINT64_MAX) {
+        coldLines++;
+    } else {
+        reuseDistances.record(distance);
+        reuseDistanceSum += distance;
+    }
+
+    for (size_t level = 0; level < caches.size(); level++) {
+        if (caches[level].access(line)) {
+            return;
+        }
+        cacheMisses[level]++;
+    }
+}
+
+void CacheSimulator::accessPage(uint64_t page) {
+    uint64_t simulated = pages.emplace(page, pages.size()).first->second;
+    for (size_t level = 0; level < tlbs.size(); level++) {
+        if (tlbs[level].access(simulated)) {
+            return;
+        }
+        tlbMisses[level]++;
+    }
+}
+
+uint64_t CacheSimulator::reuseDistance(uint64_t line) {
+    // Times start at 1, index 0 of the Fenwick tree is unused
+    time++;
+    if (time >= tree.size()) {
+        compactTimes();
+    }
+
+    uint64_t distance = UINT64_MAX;
+    auto previous = lastAccess.find(line);
+    if (previous != lastAccess.end()) {
+        distance = marksUntil(time - 1) - marksUntil(previous->second);
+        mark(previous->second, -1);
+        previous->second = time;
+    } else {
+        lastAccess.emplace(line, time);
+    }
+    mark(time, 1);
+    return distance;
+}
+
+void CacheSimulator::compactTimes() {
+    // Only the order of the last accesses matters: renumber them to 1..n, so the tree grows with the distinct lines
+    // and not with the number of accesses
+    std::vector<uint64_t *> live;
+    live.reserve(lastAccess.size());
+    for (auto &entry : lastAccess) {
+        live.push_back(&entry.second);
+    }
+    std::sort(live.begin(), live.end(), [](const uint64_t *a, const uint64_t *b) { return *a < *b; });
+    for (size_t i = 0; i < live.size(); i++) {
+        *live[i] = i + 1;
+    }
+
+    // Every renumbered time holds a mark, built bottom up in linear time
+    tree.assign(std::max<size_t>(CACHE_SIMULATOR_INITIAL_TIMES, 2 * (live.size() + 1)), 0);
+    for (size_t i = 1; i < tree.size(); i++) {
+        tree[i] += i <= live.size() ? 1 : 0;
+        size_t parent = i + (i & -i);
+        if (parent < tree.size()) {
+            tree[parent] += tree[i];
+        }
+    }
+    time = live.size() + 1;
+}
+
+void CacheSimulator::mark(uint64_t index, int delta) {
+    for (; index < tree.size(); index += index & -index) {
+        tree[index] += delta;
+    }
+}
+
+uint64_t CacheSimulator::marksUntil(uint64_t index) const {
+    uint64_t sum = 0;
+    for (; index > 0; index -= index & -index) {
+        sum += tree[index];
+    }
+    return sum;
+}
@@ -0,0 +1,35 @@
+#include <algorithm>
+#include <limits>
+#include <thread>
+
+#include "CycleTimer.h"
+
+// Empty intervals measured for the overhead, and the duration the tick rate is measured over
+#define CYCLE_TIMER_OVERHEAD_SAMPLES 100000
+#define CYCLE_TIMER_RATE_DURATION std::chrono::milliseconds(20)
+
+uint64_t CycleTimer::overhead = 0;
+double CycleTimer::ticksPerNanosecond = 1;
+
+void CycleTimer::calibrate() {
+    // The smallest interval is the cost of the timer itself, larger ones include interrupts and the like
+    overhead = 0;
+    uint64_t smallest = std::numeric_limits<uint64_t>::max();
+    for (size_t i = 0; i < CYCLE_TIMER_OVERHEAD_SAMPLES; i++) {
+        uint64_t startTicks = start();
+        smallest = std::min(smallest, stop() - startTicks);
+    }
+    overhead = smallest;
+
+#if CYCLE_TIMER_TSC
+    auto steadyStart = std::chrono::steady_clock::now();
+    uint64_t startTicks = start();
+    std::this_thread::sleep_for(CYCLE_TIMER_RATE_DURATION);
+    uint64_t stopTicks = stop();
+    auto nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - steadyStart).count();
+    ticksPerNanosecond = static_cast<double>(stopTicks - startTicks) / nanoseconds;
+#else
+    ticksPerNanosecond = 1;
+#endif
+}
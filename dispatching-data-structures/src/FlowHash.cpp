@@ -0,0 +1,90 @@
+#include <cstring>
+
+#include "FlowHash.h"
+#include "ProtocolHeaders.h"
+
+// Fragment offset and "more fragments" flag, set for every fragment of a packet
+#define IPV4_FRAGMENT_MASK 0x3FFFu
+
+// The key 0x6d5a repeats every 16 bits, three repetitions hold every 32 bit window of it
+#define TOEPLITZ_KEY 0x6d5a6d5a6d5aull
+
+// XOR of the key windows of all set bits of a byte, for bytes at even and odd positions of the input
+struct ToeplitzTable {
+    uint32_t windows[2][256];
+
+    ToeplitzTable() : windows{} {
+        for (size_t parity = 0; parity < 2; parity++) {
+            for (size_t value = 0; value < 256; value++) {
+                for (size_t bit = 0; bit < 8; bit++) {
+                    if (value & (0x80u >> bit)) {
+                        size_t start = parity * 8 + bit;
+                        windows[parity][value] ^= static_cast<uint32_t>(TOEPLITZ_KEY >> (16 - start));
+                    }
+                }
+            }
+        }
+    }
+};
+
+static const ToeplitzTable TOEPLITZ_TABLE;
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+uint32_t FlowHash::hash(const ArrayView<uint8_t> &frame, identifier_t linkLayer) {
+    if (linkLayer != IDENTIFIER_ETHERNET || frame.size() < ETHERNET_HEADER_SIZE) {
+        return 0;
+    }
+
+    const uint8_t *data = frame.data();
+    uint16_t ethertype = loadBigEndian16(data + 12);
+    size_t offset = ETHERNET_HEADER_SIZE;
+    while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ) && offset + VLAN_HEADER_SIZE <= frame.size()) {
+        ethertype = loadBigEndian16(data + offset + 2);
+        offset += VLAN_HEADER_SIZE;
+    }
+
+    // Addresses followed by the ports, in the order of the packet
+    uint8_t input[2 * 16 + 4];
+    size_t addressSize;
+    uint8_t protocol;
+    bool fragment = false;
+    if (ethertype == ETHERTYPE_IPV4 && offset + IPV4_MIN_HEADER_SIZE <= frame.size()) {
+        const uint8_t *header = data + offset;
+        addressSize = 4;
+        memcpy(input, header + 12, 2 * addressSize);
+        protocol = header[9];
+        fragment = (loadBigEndian16(header + 6) & IPV4_FRAGMENT_MASK) != 0;
+        offset += (header[0] & 0xFu) * 4;
+    } else if (ethertype == ETHERTYPE_IPV6 && offset + IPV6_HEADER_SIZE <= frame.size()) {
+        const uint8_t *header = data + offset;
+        addressSize = 16;
+        memcpy(input, header + 8, 2 * addressSize);
+        protocol = header[6];
+        offset += IPV6_HEADER_SIZE;
+        while (isIPv6ExtensionHeader(protocol) && offset + IPV6_EXTENSION_MIN_SIZE <= frame.size()) {
+            const uint8_t *extension = data + offset;
+            fragment |= protocol == IP_PROTOCOL_FRAGMENT;
+            offset += ipv6ExtensionHeaderLength(protocol, extension);
+            protocol = extension[0];
+        }
+    } else {
+        return 0;
+    }
+
+    size_t length = 2 * addressSize;
+    if (!fragment && (protocol == IP_PROTOCOL_TCP || protocol == IP_PROTOCOL_UDP) && offset + 4 <= frame.size()) {
+        memcpy(input + length, data + offset, 4);
+        length += 4;
+    }
+    return toeplitz(input, length);
+}
+
+uint32_t FlowHash::toeplitz(const uint8_t *input, size_t length) {
+    uint32_t result = 0;
+    for (size_t i = 0; i < length; i++) {
+        result ^= TOEPLITZ_TABLE.windows[i & 1u][input[i]];
+    }
+    return result;
+}
@@ -0,0 +1,194 @@
+#include <algorithm>
+#include <limits>
+#include <stdexcept>
+
+#include "FrameBuilder.h"
+#include "ProtocolHeaders.h"
+
+// Headers whose length field covers the rest of the frame, patched after the payload was appended
+enum class LengthField {
+    IPV4,
+    IPV6,
+    UDP
+};
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+PacketBatch FrameBuilder::build(const PacketBatch &packets) {
+    std::vector<uint32_t> flows(packets.size());
+    for (size_t i = 0; i < packets.size(); i++) {
+        flows[i] = packets[i].getNumber();
+    }
+    return build(packets, flows);
+}
+
+PacketBatch FrameBuilder::build(const PacketBatch &packets, const std::vector<uint32_t> &flows) {
+    if (flows.size() != packets.size()) {
+        throw std::invalid_argument("Every packet needs a flow.");
+    }
+
+    PacketBatch frames;
+    frames.reserve(packets.size(), packets.size(), packets.payloadSize() + packets.identifierCount() * IPV6_HEADER_SIZE);
+
+    std::vector<uint8_t> frame;
+    for (size_t i = 0; i < packets.size(); i++) {
+        PacketView packet = packets[i];
+        frame.clear();
+        build(packet, frame, flows[i]);
+
+        // The link layer is not contained in the frame, it is the identifier to start dispatching with
+        const ArrayView<identifier_t> &identifiers = packet.getIdentifiers();
+        frames.add(identifiers.data(), std::min<size_t>(identifiers.size(), 1), frame.data(), frame.size());
+    }
+
+    frames.shrinkToFit();
+    return frames;
+}
+
+size_t FrameBuilder::build(const PacketView &packet, std::vector<uint8_t> &frame) {
+    return build(packet, frame, packet.getNumber());
+}
+
+size_t FrameBuilder::build(const PacketView &packet, std::vector<uint8_t> &frame, uint32_t flow) {
+    const ArrayView<identifier_t> &identifiers = packet.getIdentifiers();
+    std::vector<std::pair<LengthField, size_t>> lengthFields;
+
+    size_t encoded = 0;
+    if (!identifiers.empty() && identifiers[0] == IDENTIFIER_ETHERNET) {
+        encoded = 1;
+
+        // A missing or too small ethertype is encoded as an 802.3 length field, which ends the chain
+        uint16_t ethertype = identifiers.size() > 1 && identifiers[1] >= ETHERTYPE_MIN ? identifiers[1] : 0;
+        appendEthernet(frame, ethertype);
+        encoded += ethertype != 0;
+
+        // Ethertype of the IP header to append next, the protocol field of every IP header encodes one identifier
+        bool isIP = ethertype == ETHERTYPE_IPV4 || ethertype == ETHERTYPE_IPV6;
+        uint16_t ipVersion = ethertype;
+        while (isIP) {
+            uint8_t protocol = IP_PROTOCOL_NO_NEXT_HEADER;
+            if (encoded < identifiers.size() && identifiers[encoded] <= std::numeric_limits<uint8_t>::max() &&
+                identifiers[encoded] != IP_PROTOCOL_NO_NEXT_HEADER && !isIPv6ExtensionHeader(identifiers[encoded])) {
+                protocol = identifiers[encoded];
+            }
+
+            lengthFields.emplace_back(ipVersion == ETHERTYPE_IPV4 ? LengthField::IPV4 : LengthField::IPV6, frame.size());
+            if (ipVersion == ETHERTYPE_IPV4) {
+                appendIPv4(frame, protocol, flow);
+            } else {
+                appendIPv6(frame, protocol, flow);
+            }
+            if (protocol == IP_PROTOCOL_NO_NEXT_HEADER) {
+                break;
+            }
+            encoded++;
+
+            // Tunnels continue with another IP header
+            isIP = false;
+            if (protocol == IP_PROTOCOL_IPV4 || protocol == IP_PROTOCOL_IPV6) {
+                isIP = true;
+                ipVersion = protocol == IP_PROTOCOL_IPV4 ? ETHERTYPE_IPV4 : ETHERTYPE_IPV6;
+            } else if (protocol == IP_PROTOCOL_TCP) {
+                appendTCP(frame, flow);
+            } else if (protocol == IP_PROTOCOL_UDP) {
+                lengthFields.emplace_back(LengthField::UDP, frame.size());
+                appendUDP(frame, flow);
+            }
+        }
+    }
+
+    const ArrayView<uint8_t> &payload = packet.getPayload();
+    frame.insert(frame.end(), payload.begin(), payload.end());
+
+    for (const auto &field : lengthFields) {
+        size_t length = frame.size() - field.second;
+        switch (field.first) {
+            case LengthField::IPV4:
+                storeBigEndian16(frame, field.second + 2, length);
+                break;
+            case LengthField::IPV6:
+                storeBigEndian16(frame, field.second + 4, length - IPV6_HEADER_SIZE);
+                break;
+            case LengthField::UDP:
+                storeBigEndian16(frame, field.second + 4, length);
+                break;
+        }
+    }
+
+    return encoded;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+void FrameBuilder::appendEthernet(std::vector<uint8_t> &frame, uint16_t ethertype) {
+    const uint8_t header[ETHERNET_HEADER_SIZE] = {
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x01, // Locally administered destination
+            0x02, 0x00, 0x00, 0x00, 0x00, 0x02, // Locally administered source
+            static_cast<uint8_t>(ethertype >> 8u), static_cast<uint8_t>(ethertype)
+    };
+    frame.insert(frame.end(), header, header + ETHERNET_HEADER_SIZE);
+}
+
+// The source address is 10.1.0.0/16 plus the lower 16 bits of the flow
+void FrameBuilder::appendIPv4(std::vector<uint8_t> &frame, uint8_t protocol, uint32_t flow) {
+    const uint8_t header[IPV4_MIN_HEADER_SIZE] = {
+            0x45, 0x00, 0x00, 0x00, // Version, IHL, DSCP, total length
+            0x00, 0x00, 0x40, 0x00, // Identification, don't fragment
+            0x40, protocol, 0x00, 0x00, // TTL, protocol, checksum (not computed)
+            10, 1, static_cast<uint8_t>(flow >> 8u), static_cast<uint8_t>(flow),
+            10, 0, 0, 2
+    };
+    frame.insert(frame.end(), header, header + IPV4_MIN_HEADER_SIZE);
+}
+
+void FrameBuilder::appendIPv6(std::vector<uint8_t> &frame, uint8_t nextHeader, uint32_t flow) {
+    uint8_t header[IPV6_HEADER_SIZE] = {
+            0x60, 0x00, 0x00, 0x00, // Version, traffic class, flow label
+            0x00, 0x00, nextHeader, 0x40 // Payload length, next header, hop limit
+    };
+
+    // fd00::1:<flow> and fd00::2
+    header[8] = header[24] = 0xfd;
+    header[19] = 1;
+    for (size_t i = 0; i < sizeof(flow); i++) {
+        header[23 - i] = static_cast<uint8_t>(flow >> (8 * i));
+    }
+    header[39] = 2;
+    frame.insert(frame.end(), header, header + IPV6_HEADER_SIZE);
+}
+
+void FrameBuilder::appendTCP(std::vector<uint8_t> &frame, uint32_t flow) {
+    uint16_t port = sourcePort(flow);
+    const uint8_t header[TCP_MIN_HEADER_SIZE] = {
+            static_cast<uint8_t>(port >> 8u), static_cast<uint8_t>(port), 0x01, 0xbb, // Ports
+            0x00, 0x00, 0x00, 0x01, // Sequence number
+            0x00, 0x00, 0x00, 0x01, // Acknowledgment number
+            0x50, 0x18, 0xff, 0xff, // Data offset, PSH ACK, window
+            0x00, 0x00, 0x00, 0x00  // Checksum (not computed), urgent pointer
+    };
+    frame.insert(frame.end(), header, header + TCP_MIN_HEADER_SIZE);
+}
+
+void FrameBuilder::appendUDP(std::vector<uint8_t> &frame, uint32_t flow) {
+    uint16_t port = sourcePort(flow);
+    const uint8_t header[UDP_HEADER_SIZE] = {
+            static_cast<uint8_t>(port >> 8u), static_cast<uint8_t>(port), 0x00, 0x35, // Ports
+            0x00, 0x00, 0x00, 0x00  // Length, checksum (not computed)
+    };
+    frame.insert(frame.end(), header, header + UDP_HEADER_SIZE);
+}
+
+// Ephemeral port from the upper 16 bits of the flow, the lower ones are part of the IPv4 source address
+uint16_t FrameBuilder::sourcePort(uint32_t flow) {
+    return static_cast<uint16_t>(0xc000u + (flow >> 16u) % 0x4000u);
+}
+
+// Length fields saturate for frames larger than 64 KiB, the analyzers only check that the length fits into the frame
+void FrameBuilder::storeBigEndian16(std::vector<uint8_t> &frame, size_t position, size_t value) {
+    value = std::min<size_t>(value, std::numeric_limits<uint16_t>::max());
+    frame[position] = static_cast<uint8_t>(value >> 8u);
+    frame[position + 1] = static_cast<uint8_t>(value);
+}
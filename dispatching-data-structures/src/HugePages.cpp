@@ -0,0 +1,229 @@
+#include <atomic>
+#include <fstream>
+#include <map>
+#include <mutex>
+#include <new>
+#include <sstream>
+#include <stdexcept>
+
+#include <sys/mman.h>
+
+#include "HugePages.h"
+
+namespace {
+    // What the kernel was asked for, a TRANSPARENT mapping may still be backed by small pages
+    enum class Backing {
+        TRANSPARENT,
+        EXPLICIT,
+        SMALL // madvise was refused, e.g. transparent huge pages are disabled
+    };
+
+    struct Mapping {
+        size_t length;
+        Backing backing;
+        uint64_t serial;
+    };
+
+    struct State {
+        std::atomic<PagePolicy> policy{PagePolicy::SMALL};
+        std::mutex mutex;
+        std::map<uintptr_t, Mapping> mappings;
+        uint64_t serials = 0;
+        size_t explicitFallbacks = 0;
+        size_t transparentFallbacks = 0;
+    };
+
+    State &state() {
+        static State instance;
+        return instance;
+    }
+
+    size_t roundUp(size_t bytes) {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    void *mapExplicit(size_t length) {
+#ifdef MAP_HUGETLB
+        void *address = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        return address == MAP_FAILED ? nullptr : address;
+#else
+        (void) length;
+        return nullptr;
+#endif
+    }
+
+    // Maps with huge page alignment, otherwise the kernel cannot place huge pages at the start of the mapping
+    void *mapAligned(size_t length) {
+        void *mapped = mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS,
+                            -1, 0);
+        if (mapped == MAP_FAILED) {
+            throw std::bad_alloc();
+        }
+        auto begin = reinterpret_cast<uintptr_t>(mapped);
+        uintptr_t aligned = roundUp(begin);
+        if (aligned > begin) {
+            munmap(mapped, aligned - begin);
+        }
+        munmap(reinterpret_cast<void *>(aligned + length), begin + HUGE_PAGE_SIZE - aligned);
+        return reinterpret_cast<void *>(aligned);
+    }
+
+    bool adviseTransparent(void *address, size_t length) {
+#ifdef MADV_HUGEPAGE
+        return madvise(address, length, MADV_HUGEPAGE) == 0;
+#else
+        (void) address;
+        (void) length;
+        return false;
+#endif
+    }
+
+    // AnonHugePages of all areas in /proc/self/smaps that overlap a transparent mapping, 0 without smaps
+    size_t transparentHugeBytes(const std::map<uintptr_t, Mapping> &mappings) {
+        std::ifstream smaps("/proc/self/smaps");
+        size_t total = 0;
+        bool overlaps = false;
+        std::string line;
+        while (std::getline(smaps, line)) {
+            uintptr_t begin;
+            uintptr_t end;
+            char dash;
+            std::istringstream fields(line);
+            if (line.compare(0, 14, "AnonHugePages:") == 0) {
+                size_t kibibytes = 0;
+                std::istringstream(line.substr(14)) >> kibibytes;
+                total += overlaps ? kibibytes * 1024 : 0;
+            } else if (fields >> std::hex >> begin >> dash >> end && dash == '-') {
+                // Header of the next area
+                overlaps = false;
+                for (auto mapping = mappings.lower_bound(begin); mapping != mappings.end() && mapping->first < end;
+                     ++mapping) {
+                    overlaps |= mapping->second.backing == Backing::TRANSPARENT;
+                }
+            }
+        }
+        return total;
+    }
+}
+
+void HugePages::setPolicy(PagePolicy policy) {
+    state().policy = policy;
+}
+
+PagePolicy HugePages::getPolicy() {
+    return state().policy;
+}
+
+PagePolicy HugePages::parsePolicy(const std::string &name) {
+    if (name == "small") {
+        return PagePolicy::SMALL;
+    } else if (name == "thp") {
+        return PagePolicy::TRANSPARENT;
+    } else if (name == "explicit") {
+        return PagePolicy::EXPLICIT;
+    }
+    throw std::invalid_argument("Invalid page policy " + name + " (expected small, thp or explicit).");
+}
+
+void *HugePages::allocate(size_t bytes) {
+    State &instance = state();
+    PagePolicy policy = instance.policy;
+    if (bytes < HUGE_PAGES_MIN_BYTES || policy == PagePolicy::SMALL) {
+        return ::operator new(bytes);
+    }
+
+    size_t length = roundUp(bytes);
+    Backing backing = Backing::EXPLICIT;
+    void *address = policy == PagePolicy::EXPLICIT ? mapExplicit(length) : nullptr;
+    bool explicitFallback = policy == PagePolicy::EXPLICIT && address == nullptr;
+    bool transparentFallback = false;
+    if (address == nullptr) {
+        address = mapAligned(length);
+        backing = Backing::TRANSPARENT;
+        if (!adviseTransparent(address, length)) {
+            backing = Backing::SMALL;
+            transparentFallback = true;
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    instance.mappings.emplace(reinterpret_cast<uintptr_t>(address), Mapping{length, backing, instance.serials++});
+    instance.explicitFallbacks += explicitFallback;
+    instance.transparentFallbacks += transparentFallback;
+    return address;
+}
+
+void HugePages::deallocate(void *address, size_t bytes) {
+    if (bytes >= HUGE_PAGES_MIN_BYTES) {
+        State &instance = state();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        auto mapping = instance.mappings.find(reinterpret_cast<uintptr_t>(address));
+        if (mapping != instance.mappings.end()) {
+            munmap(address, mapping->second.length);
+            instance.mappings.erase(mapping);
+            return;
+        }
+    }
+    ::operator delete(address);
+}
+
+bool HugePages::owns(const void *address) {
+    State &instance = state();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    return instance.mappings.count(reinterpret_cast<uintptr_t>(address)) != 0;
+}
+
+uint64_t HugePages::serial() {
+    State &instance = state();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    return instance.serials;
+}
+
+HugePageUsage HugePages::usage(uint64_t since, const void *address) {
+    State &instance = state();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    std::map<uintptr_t, Mapping> selected;
+    for (const auto &mapping : instance.mappings) {
+        if (mapping.second.serial >= since || mapping.first == reinterpret_cast<uintptr_t>(address)) {
+            selected.insert(mapping);
+        }
+    }
+
+    HugePageUsage usage;
+    for (const auto &mapping : selected) {
+        switch (mapping.second.backing) {
+            case Backing::EXPLICIT:
+                usage.explicitBytes += mapping.second.length;
+                break;
+            case Backing::TRANSPARENT:
+                usage.transparentBytes += mapping.second.length;
+                break;
+            case Backing::SMALL:
+                usage.smallBytes += mapping.second.length;
+                break;
+        }
+    }
+    usage.transparentHugeBytes = transparentHugeBytes(selected);
+    return usage;
+}
+
+void HugePages::report(std::ostream &os) {
+    State &instance = state();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    size_t counts[3] = {};
+    size_t bytes[3] = {};
+    for (const auto &mapping : instance.mappings) {
+        counts[static_cast<int>(mapping.second.backing)]++;
+        bytes[static_cast<int>(mapping.second.backing)] += mapping.second.length;
+    }
+
+    os << "Huge pages: " << counts[static_cast<int>(Backing::EXPLICIT)] << " explicit mappings with "
+       << bytes[static_cast<int>(Backing::EXPLICIT)] / 1024 << " KiB, "
+       << counts[static_cast<int>(Backing::TRANSPARENT)] << " transparent mappings with "
+       << bytes[static_cast<int>(Backing::TRANSPARENT)] / 1024 << " KiB of which "
+       << transparentHugeBytes(instance.mappings) / 1024 << " KiB are backed by huge pages, "
+       << counts[static_cast<int>(Backing::SMALL)] << " mappings with "
+       << bytes[static_cast<int>(Backing::SMALL)] / 1024 << " KiB on small pages. Fallbacks: "
+       << instance.explicitFallbacks << " from explicit to transparent, "
+       << instance.transparentFallbacks << " from transparent to small pages." << std::endl;
+}
@@ -8,20 +8,36 @@
 #include "analyzers/All.h"
 #include "MyPacket.h"
 #include "InputReader.h"
+#include "ProtocolHeaders.h"
+#include "FrameBuilder.h"
+#include "TextTraceParser.h"
+#include "TraceFile.h"
+#include "TraceGenerator.h"
 
 // ********************
 // ****** PUBLIC ******
 // ********************
-std::vector<MyPacket> InputReader::readPacketFile(const std::string &path) {
+// Packet files that are generated instead of read, see TraceGenerator
+static bool isGeneratedTrace(const std::string &path) {
+    return path.compare(0, strlen(TRACE_GENERATOR_PREFIX), TRACE_GENERATOR_PREFIX) == 0;
+}
+
+PacketBatch InputReader::readPacketFile(const std::string &path) {
+    if (isGeneratedTrace(path)) {
+        return TraceGenerator(TraceGeneratorConfig::parse(path.substr(strlen(TRACE_GENERATOR_PREFIX)))).generate();
+    }
+
     // Determine file type and continue accordingly
     switch(getFileType(path)) {
         case PCAP: {
-			throw std::invalid_argument("Not a valid packet file type.");
-//            return readPCAP(path);
+            return readPCAP(path);
         }
         case CUSTOM_PACKET_FORMAT: {
             return readCustomFileFormat(path);
         }
+        case BINARY_TRACE: {
+            return TraceFile::read(path);
+        }
         default: {
             throw std::invalid_argument("Not a valid packet file type.");
         }
@@ -29,6 +45,54 @@ std::vector<MyPacket> InputReader::readPacketFile(const std::string &path) {
 }
 
 std::map<identifier_t, analyzer_builder> InputReader::readAnalyzerFile(const std::string &path) {
+    return readAnalyzerFile(path, nullptr);
+}
+
+PacketBatch InputReader::readFrames(const std::string &path) {
+    if (isGeneratedTrace(path)) {
+        // The generator knows the flows of the packets
+        TraceGenerator generator(TraceGeneratorConfig::parse(path.substr(strlen(TRACE_GENERATOR_PREFIX))));
+        std::vector<uint32_t> flows;
+        PacketBatch packets = generator.generate(&flows);
+        return FrameBuilder::build(packets, flows);
+    } else if (getFileType(path) != PCAP) {
+        return FrameBuilder::build(readPacketFile(path));
+    }
+
+    PcapReader reader(path);
+    PacketBatch frames;
+    PcapRecord record{};
+    while (reader.next(record)) {
+        identifier_t identifier;
+        switch (record.linkType) {
+            case LINKTYPE_ETHERNET:
+                identifier = IDENTIFIER_ETHERNET;
+                break;
+            case LINKTYPE_IEEE802_11_RADIOTAP:
+                identifier = IDENTIFIER_RADIOTAP;
+                break;
+            case LINKTYPE_IEEE802_11:
+                identifier = IDENTIFIER_IEEE802_11;
+                break;
+            default:
+                throw std::invalid_argument("Unsupported link type " + std::to_string(record.linkType) + ".");
+        }
+        frames.add(&identifier, 1, record.data, record.capturedLength);
+    }
+
+    frames.shrinkToFit();
+    return frames;
+}
+
+std::map<identifier_t, analyzer_builder> InputReader::readAnalyzerFile(const std::string &path, AnalyzerArena &arena) {
+    return readAnalyzerFile(path, &arena);
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+std::map<identifier_t, analyzer_builder> InputReader::readAnalyzerFile(const std::string &path, AnalyzerArena *arena) {
     if (getFileType(path) != ANALYZER) {
         throw std::invalid_argument("Not a valid analyzer file type (Needs to begin with '# ANALYZERS').");
     }
@@ -65,42 +129,35 @@ std::map<identifier_t, analyzer_builder> InputReader::readAnalyzerFile(const std
             input.replace(0, 2, "");
         }
 
-        ANALYZER_IF(identifier, input, ETHAnalyzer, analyzerBuilders)
-        ANALYZER_ELIF(identifier, input, IPv4Analyzer, analyzerBuilders)
-        ANALYZER_ELIF(identifier, input, IPv6Analyzer, analyzerBuilders)
-        ANALYZER_ELIF(identifier, input, TCPAnalyzer, analyzerBuilders)
-        ANALYZER_ELIF(identifier, input, UDPAnalyzer, analyzerBuilders)
-        ANALYZER_ELIF(identifier, input, UnknownAnalyzer, analyzerBuilders)
+        ANALYZER_IF(identifier, input, ETHAnalyzer, analyzerBuilders, arena)
+        ANALYZER_ELIF(identifier, input, IPv4Analyzer, analyzerBuilders, arena)
+        ANALYZER_ELIF(identifier, input, IPv6Analyzer, analyzerBuilders, arena)
+        ANALYZER_ELIF(identifier, input, TCPAnalyzer, analyzerBuilders, arena)
+        ANALYZER_ELIF(identifier, input, UDPAnalyzer, analyzerBuilders, arena)
+        ANALYZER_ELIF(identifier, input, UnknownAnalyzer, analyzerBuilders, arena)
         ANALYZER_ELSE(input, lineCounter)
     }
 
     return analyzerBuilders;
 }
 
-
-// ********************
-// ***** PRIVATE ******
-// ********************
 FileType InputReader::getFileType(const std::string &path) {
     std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
     if (!file.is_open()) {
         throw std::invalid_argument("File does not exist.");
     }
 
-    file.seekg(0);
-
-    // Read first 4 bytes to uint32_t (magic number)
-    char buf[4];
-    uint32_t magicNumber;
-    file.read(buf, 4);
-    memcpy(&magicNumber, buf, 4);
     file.close();
 
-    // If file is a PCAP, return that fact
-    if (magicNumber == 0xA1B2C3D4) {
+    // If file is a PCAP or pcapng, return that fact
+    if (PcapReader::isPcapFile(path)) {
         return PCAP;
     }
 
+    if (TraceFile::isTraceFile(path)) {
+        return BINARY_TRACE;
+    }
+
     // Check if file is a packet file or an analyzer file
     file = std::ifstream(path);
     if (!file.is_open()) {
@@ -126,311 +183,292 @@ identifier_t InputReader::extractWiFiTypeSubtypeIdentifier(T *pdu) {
     return (pdu->type() << 4u) + pdu->subtype();
 }
 
-//std::vector<MyPacket> InputReader::readPCAP(const std::string &path, const std::string &target) {
-//    std::vector<MyPacket> packets;
-//
-//    // LIBTINS
-//    Tins::FileSniffer sniffer(path);
-//    std::string last_ts;
-//    for (auto& currentPacket : sniffer) {
-//        MyPacket packet;
-//        last_ts = std::to_string(currentPacket.timestamp().seconds()) + "." + std::to_string(currentPacket.timestamp().microseconds());
-//#if DEBUG == 1
-//        if (packet.getNumber() % 10000 == 0) {
-//#endif
-//#if DEBUG > 0
-//        auto test = currentPacket.pdu()->serialize();
-//        std::cout << "Packet " << std::setw(5) << std::setfill(' ') << packet.getNumber() << ":\tts="
-//                  << currentPacket.timestamp().seconds() << "." << currentPacket.timestamp().microseconds() << " | "
-//                  << std::hex;
-//        for (size_t i = 0; i < currentPacket.pdu()->size(); i++) {
-//            if (i < 10 || i > currentPacket.pdu()->size() - 10) {
-//                std::cout << std::setw(2) << std::setfill('0') << static_cast<uint32_t>(test[i]) << " ";
-//            }
-//            if (i == 10) {
-//                std::cout << " ... ";
-//            }
-//        }
-//        std::cout << std::dec << std::endl;
-//#endif
-//#if DEBUG == 1
-//        }
-//#endif
-//        for (auto& pdu : Tins::iterate_pdus(currentPacket)) {
-//            bool done = false;
-//            switch(pdu.pdu_type()) {
-//                case Tins::PDU::PDUType::ETHERNET_II: {
-//                    packet.addIdentifier(1);
-//
-//                    // Only add if it is not VLAN
-//                    uint16_t ethertype = pdu.find_pdu<Tins::EthernetII>()->payload_type();
-//                    if (ethertype != 0x8100) {
-//                        packet.addIdentifier(ethertype);
-//                    }
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::RADIOTAP: {
-//                    // Add radiotap and 802.11 identifier. Radiotap analyzer then returns constant 105 as id
-//                    // Because there has to be a 802.11 header after the radio tap header
-//                    // 802.11 analyzer then extracts the frame control field for more exact analyzing
-//                    packet.addIdentifier(127);
-//                    packet.addIdentifier(105);
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_QOS_DATA: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11QoSData>();
-//                    size_t id = extractWiFiTypeSubtypeIdentifier(p);
-//                    if (id == 0x2c) {
-//                        // Ignore NULL data, has no payload
-//                        break;
-//                    }
-//                    packet.addIdentifier(id);
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_DATA: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11Data>();
-//                    size_t id = extractWiFiTypeSubtypeIdentifier(p);
-//                    if (id == 0x24) {
-//                        // Ignore NULL data, has no payload
-//                        break;
-//                    }
-//                    packet.addIdentifier(id);
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_ASSOC_REQ: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11AssocRequest>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_ASSOC_RESP: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11AssocResponse>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_AUTH: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11Authentication>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_BEACON: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11Beacon>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_DEAUTH: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11Deauthentication>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_DIASSOC: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11Disassoc>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_PROBE_REQ: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11ProbeRequest>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_PROBE_RESP: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11ProbeResponse>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_REASSOC_REQ: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11ReAssocRequest>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT11_REASSOC_RESP: {
-//                    auto* p = pdu.find_pdu<Tins::Dot11ReAssocResponse>();
-//                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-//                    break;
-//                }
-////                case Tins::PDU::PDUType::DOT11_ACK: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11Ack>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_BLOCK_ACK: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11BlockAck>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_BLOCK_ACK_REQ: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11BlockAckRequest>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_CF_END: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11CFEnd>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_END_CF_ACK: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11EndCFAck>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_PS_POLL: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11PSPoll>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-////                case Tins::PDU::PDUType::DOT11_RTS: {
-////                    auto* p = pdu.find_pdu<Tins::Dot11RTS>();
-////                    packet.addIdentifier(extractWiFiTypeSubtypeIdentifier(p));
-////                    break;
-////                }
-//                case Tins::PDU::PDUType::LLC: {
-//                    auto* p = pdu.find_pdu<Tins::LLC>();
-//
-//                    // Identifier is in SNAP, not in LLC
-//                    if ((p->ssap() == 0xAA || p->ssap() == 0xAB) && (p->dsap() == 0xAA || p->dsap() == 0xAB)) {
-//                        break;
-//                    }
-//
-//                    // Otherwise no SNAP following, can't decode that proprietary / aged shit anyway
-//                    done = true;
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::SNAP: {
-//                    auto* p = pdu.find_pdu<Tins::SNAP>();
-//
-//                    if ((p->ssap() == 0xAA || p->ssap() == 0xAB) && (p->dsap() == 0xAA || p->dsap() == 0xAB)) {
-//                        // It is really SNAP, extract identifier
-//                        packet.addIdentifier(p->eth_type());
-//                    } else {
-//                       // Otherwise it is not really SNAP but raw LLC, can't decode that proprietary / aged shit anyway
-//                        done = true;
-//                    }
-//
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::IP: {
-//                    packet.addIdentifier(pdu.find_pdu<Tins::IP>()->protocol());
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::IPv6: {
-//                    auto* ipv6PDU = pdu.find_pdu<Tins::IPv6>();
-//                    Tins::IPv6::next_headers_type nhs = ipv6PDU->next_headers();
-//                    // The "next header" field of the last extension header is the identifier if nhs.size() > 0,
-//                    // otherwise the identifier is just pdu.next_header
-//                    if (!nhs.empty()) {
-//                        packet.addIdentifier(nhs.at(nhs.size() - 1));
-//                    } else {
-//                        packet.addIdentifier(ipv6PDU->next_header());
-//                    }
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::DOT1Q: {
-//                    packet.addIdentifier(pdu.find_pdu<Tins::Dot1Q>()->payload_type());
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::PPPOE: {
-//                    // Ignored because no identifier, the identifier is in PPP for PPPoE sessions
-//                    break;
-//                }
-//                case Tins::PDU::PDUType::PPP: {
-//                    packet.addIdentifier(pdu.find_pdu<Tins::PPP>()->protocol());
-//                    break;
-//                }
-//                default: {
-//                    // Not supported or no contained identifier payload protocol
-//                    // Loopback not supported for now
-//                    // 802.3 not supported for now
-//                    // DOT11_Management, Dot11_Control, and DOT11 only appear when no subtype found, ignored
-//                    // EAPOL, ARP, TCP, UDP, ICMP(v6), BOOTP, DHCP, DNS and many others contain no payload identifier
-//                    packet.setPayload("A");
-//                    done = true;
-//                    break;
-//                }
-//            }
-//
-//            if (done) {
-//                break;
-//            }
-//        }
-//        // Drop packets that only contain 7f 69 (radiotap 802.11) or only 01 (Ethernet)
-//        if ((packet.getIdentifiers().size() == 2 && packet.getIdentifiers()[0] == 0x7f && packet.getIdentifiers()[1] == 0x69) ||
-//            (packet.getIdentifiers().size() == 1 && packet.getIdentifiers()[0] == 0x1)) {
-//            continue;
-//        }
-//        packets.push_back(packet);
-//    }
-//
-//    if (!target.empty()) {
-//        std::ofstream output;
-//        output.open(target);
-//        if (!output.is_open()) {
-//            std::cerr << "Error occured while opening target file." << std::endl;
-//        }
-//        std::cout << "Dumping packets to file " << target << std::endl;
-//
-//        for (const auto &packet : packets) {
-//            output << packet;
-//        }
-//        output.close();
-//    }
-//
-//    return packets;
-//}
-
-std::vector<MyPacket> InputReader::readCustomFileFormat(const std::string &path) {
-    std::ifstream file(path);
-    if (!file.is_open()) {
-        throw std::invalid_argument("File path does not exist.");
+PacketBatch InputReader::readPCAP(const std::string &path) {
+    PcapReader reader(path);
+    PacketBatch packets;
+    std::vector<identifier_t> identifiers;
+    PcapRecord record{};
+    while (reader.next(record)) {
+        addPcapRecord(packets, record, identifiers);
     }
 
-    std::string line;
-    size_t lineCounter = 0;
-    std::vector<MyPacket> packets;
-    while (std::getline(file, line)) {
-        lineCounter++;
-        if (line.empty()) {
-            throw std::invalid_argument("Line " + std::to_string(lineCounter) + " is empty.");
-        }
+    packets.shrinkToFit();
+    return packets;
+}
 
-        // Skip first line with the marker
-        if (lineCounter == 1) {
-            continue;
-        }
+void InputReader::addPcapRecord(PacketBatch &packets, const PcapRecord &record, std::vector<identifier_t> &identifiers) {
+    identifiers.clear();
+    size_t payloadOffset = dissect(record.linkType, record.data, record.capturedLength, identifiers);
 
-        MyPacket packet;
-        std::istringstream iss(line);
-        std::vector<std::string> fields(std::istream_iterator<std::string>{iss}, std::istream_iterator<std::string>());
-        if (fields.empty()) {
-            throw std::invalid_argument("Line " + std::to_string(lineCounter) + ": Packet is empty.");
-        } else if (fields.size() == 1) {
-            throw std::invalid_argument("Line " + std::to_string(lineCounter) + ": Packet contains only a payload.");
-        }
+    // Drop packets without identifiers or that only contain 7f 69 (radiotap 802.11) or only 01 (Ethernet)
+    if (identifiers.empty() ||
+        (identifiers.size() == 2 && identifiers[0] == IDENTIFIER_RADIOTAP && identifiers[1] == IDENTIFIER_IEEE802_11) ||
+        (identifiers.size() == 1 && identifiers[0] == IDENTIFIER_ETHERNET)) {
+        return;
+    }
 
-        for (size_t i = 0; i < fields.size(); i++) {
-            std::string &field = fields[i];
+    // The payload is everything behind the last header that contained an identifier
+    packets.add(identifiers.data(), identifiers.size(), record.data + payloadOffset, record.capturedLength - payloadOffset);
+}
+
+// Protocol layers the dissector walks through
+enum class Layer {
+    ETHERNET,
+    ETHERTYPE, // Continues with the layer of the current ethertype
+    VLAN,
+    PPPOE,
+    IPV4,
+    IPV6,
+    RADIOTAP,
+    DOT11,
+    LLC,
+    DONE
+};
+
+// Layer of an IP payload, only tunneled IP is dissected any further
+static Layer ipPayloadLayer(uint8_t protocol) {
+    switch (protocol) {
+        case IP_PROTOCOL_IPV4:
+            return Layer::IPV4;
+        case IP_PROTOCOL_IPV6:
+            return Layer::IPV6;
+        default:
+            return Layer::DONE;
+    }
+}
+
+// Management frames that libtins decoded into their own PDU, only these contributed an identifier
+static bool isDecodedManagementFrame(uint8_t subtype) {
+    switch (subtype) {
+        case 0x0: // Association request
+        case 0x1: // Association response
+        case 0x2: // Reassociation request
+        case 0x3: // Reassociation response
+        case 0x4: // Probe request
+        case 0x5: // Probe response
+        case 0x8: // Beacon
+        case 0xa: // Disassociation
+        case 0xb: // Authentication
+        case 0xc: // Deauthentication
+            return true;
+        default:
+            return false;
+    }
+}
+
+// Produces the same identifier chains as the former libtins based reader. Truncated headers end the dissection.
+size_t InputReader::dissect(uint32_t linkType, const uint8_t *data, size_t length, std::vector<identifier_t> &identifiers) {
+    Layer layer;
+    switch (linkType) {
+        case LINKTYPE_ETHERNET:
+            layer = Layer::ETHERNET;
+            break;
+        case LINKTYPE_IEEE802_11_RADIOTAP:
+            layer = Layer::RADIOTAP;
+            break;
+        case LINKTYPE_IEEE802_11:
+            layer = Layer::DOT11;
+            break;
+        default:
+            throw std::invalid_argument("Unsupported link type " + std::to_string(linkType) + ".");
+    }
 
-            // Strip leading 0x if it exists
-            if (field.substr(0, 2) == "0x") {
-                field.replace(0, 2, "");
+    size_t offset = 0;
+    uint16_t ethertype = 0;
+    while (layer != Layer::DONE) {
+        const uint8_t *header = data + offset;
+        size_t remaining = length - offset;
+        switch (layer) {
+            case Layer::ETHERNET: {
+                if (remaining < ETHERNET_HEADER_SIZE) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                // 802.3 frames are not supported
+                ethertype = loadBigEndian16(header + 12);
+                if (ethertype < ETHERTYPE_MIN) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                identifiers.push_back(IDENTIFIER_ETHERNET);
+                // Only add if it is not VLAN, the tag adds the identifier of its payload itself
+                if (ethertype != ETHERTYPE_VLAN && ethertype != ETHERTYPE_QINQ) {
+                    identifiers.push_back(ethertype);
+                }
+                offset += ETHERNET_HEADER_SIZE;
+                layer = Layer::ETHERTYPE;
+                break;
+            }
+            case Layer::ETHERTYPE: {
+                switch (ethertype) {
+                    case ETHERTYPE_IPV4:
+                        layer = Layer::IPV4;
+                        break;
+                    case ETHERTYPE_IPV6:
+                        layer = Layer::IPV6;
+                        break;
+                    case ETHERTYPE_VLAN:
+                    case ETHERTYPE_QINQ:
+                        layer = Layer::VLAN;
+                        break;
+                    case ETHERTYPE_PPPOE_SESSION:
+                        layer = Layer::PPPOE;
+                        break;
+                    default:
+                        layer = Layer::DONE;
+                        break;
+                }
+                break;
             }
+            case Layer::VLAN: {
+                if (remaining < VLAN_HEADER_SIZE) {
+                    layer = Layer::DONE;
+                    break;
+                }
 
-            // Last token in a line is the payload
-            if (i == fields.size() - 1) {
-                try {
-                    packet.setPayload(field);
-                } catch (std::invalid_argument &e) {
-                    throw std::invalid_argument(
-                            "Line " + std::to_string(lineCounter) +
-                            ": Payload contains invalid characters (only hex allowed).");
+                ethertype = loadBigEndian16(header + 2);
+                identifiers.push_back(ethertype);
+                offset += VLAN_HEADER_SIZE;
+                layer = Layer::ETHERTYPE;
+                break;
+            }
+            case Layer::PPPOE: {
+                // PPPoE has no identifier, it is in the PPP header behind it
+                if (remaining < PPPOE_HEADER_SIZE + PPP_HEADER_SIZE) {
+                    layer = Layer::DONE;
+                    break;
                 }
-            } else {
-                packet.addIdentifier(parseIdentifier(field, lineCounter));
+
+                uint16_t protocol = loadBigEndian16(header + PPPOE_HEADER_SIZE);
+                identifiers.push_back(protocol);
+                offset += PPPOE_HEADER_SIZE + PPP_HEADER_SIZE;
+                layer = protocol == PPP_IPV4 ? Layer::IPV4 : (protocol == PPP_IPV6 ? Layer::IPV6 : Layer::DONE);
+                break;
             }
-        }
+            case Layer::IPV4: {
+                size_t headerLength = (header[0] & 0xFu) * 4;
+                if (remaining < IPV4_MIN_HEADER_SIZE || headerLength < IPV4_MIN_HEADER_SIZE || headerLength > remaining) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                uint8_t protocol = header[9];
+                identifiers.push_back(protocol);
+                offset += headerLength;
+
+                // Later fragments do not start with the header of the payload
+                bool firstFragment = (loadBigEndian16(header + 6) & 0x1FFFu) == 0;
+                layer = firstFragment ? ipPayloadLayer(protocol) : Layer::DONE;
+                break;
+            }
+            case Layer::IPV6: {
+                if (remaining < IPV6_HEADER_SIZE) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                // The "next header" field of the last extension header is the identifier
+                uint8_t next = header[6];
+                size_t headerLength = IPV6_HEADER_SIZE;
+                bool firstFragment = true;
+                while (isIPv6ExtensionHeader(next) && headerLength + IPV6_EXTENSION_MIN_SIZE <= remaining) {
+                    const uint8_t *extension = header + headerLength;
+                    if (next == IP_PROTOCOL_FRAGMENT) {
+                        firstFragment = (loadBigEndian16(extension + 2) & 0xFFF8u) == 0;
+                    }
+                    headerLength += ipv6ExtensionHeaderLength(next, extension);
+                    next = extension[0];
+                }
+                if (headerLength > remaining || isIPv6ExtensionHeader(next)) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                identifiers.push_back(next);
+                offset += headerLength;
+                layer = firstFragment ? ipPayloadLayer(next) : Layer::DONE;
+                break;
+            }
+            case Layer::RADIOTAP: {
+                if (remaining < RADIOTAP_MIN_HEADER_SIZE) {
+                    layer = Layer::DONE;
+                    break;
+                }
+
+                // Radiotap is always followed by 802.11, whose identifier is constant
+                identifiers.push_back(IDENTIFIER_RADIOTAP);
+                identifiers.push_back(IDENTIFIER_IEEE802_11);
+                size_t headerLength = loadLittleEndian16(header + 2);
+                if (headerLength > remaining) {
+                    layer = Layer::DONE;
+                    break;
+                }
+                offset += headerLength;
+                layer = Layer::DOT11;
+                break;
+            }
+            case Layer::DOT11: {
+                layer = Layer::DONE;
+                if (remaining < DOT11_DATA_HEADER_SIZE) {
+                    break;
+                }
 
-        packets.push_back(packet);
+                // 802.11 analyzer extracts the frame control field for more exact analyzing
+                Dot11FrameControl control(header);
+                identifier_t identifier = extractWiFiTypeSubtypeIdentifier(&control);
+                if (control.type() == DOT11_TYPE_MANAGEMENT && isDecodedManagementFrame(control.subtype())) {
+                    identifiers.push_back(identifier);
+                } else if (control.type() == DOT11_TYPE_DATA) {
+                    // Ignore NULL data, has no payload
+                    if (identifier != DOT11_DATA_NULL && identifier != DOT11_QOS_DATA_NULL) {
+                        identifiers.push_back(identifier);
+                    }
+
+                    size_t headerLength = DOT11_DATA_HEADER_SIZE;
+                    if (control.toDS() && control.fromDS()) {
+                        headerLength += 6; // Fourth address
+                    }
+                    if (control.subtype() & 0x8u) {
+                        headerLength += control.order() ? 6 : 2; // QoS control and HT control
+                    }
+
+                    // Subtypes with bit 2 set carry no frame body, encrypted bodies cannot be dissected
+                    if (!(control.subtype() & 0x4u) && !control.isProtected() && headerLength <= remaining) {
+                        offset += headerLength;
+                        layer = Layer::LLC;
+                    }
+                }
+                break;
+            }
+            case Layer::LLC: {
+                layer = Layer::DONE;
+                if (remaining < LLC_SNAP_HEADER_SIZE) {
+                    break;
+                }
+
+                // Identifier is in SNAP, otherwise it is raw LLC, which can't be decoded
+                bool snap = (header[0] == 0xAA || header[0] == 0xAB) && (header[1] == 0xAA || header[1] == 0xAB);
+                if (snap) {
+                    ethertype = loadBigEndian16(header + 6);
+                    identifiers.push_back(ethertype);
+                    offset += LLC_SNAP_HEADER_SIZE;
+                    layer = Layer::ETHERTYPE;
+                }
+                break;
+            }
+            case Layer::DONE: {
+                break;
+            }
+        }
     }
 
-    return packets;
+    return offset;
+}
+
+PacketBatch InputReader::readCustomFileFormat(const std::string &path) {
+    return TextTraceParser::parse(path);
 }
 
 identifier_t InputReader::parseIdentifier(const std::string &field, size_t currentLineNum) {
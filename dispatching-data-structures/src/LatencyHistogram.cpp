@@ -0,0 +1,59 @@
+#include <algorithm>
+#include <cmath>
+
+#include "LatencyHistogram.h"
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+LatencyHistogram::LatencyHistogram() : counts(LATENCY_HISTOGRAM_SUB_COUNT * (65 - LATENCY_HISTOGRAM_SUB_BITS), 0) {
+}
+
+void LatencyHistogram::merge(const LatencyHistogram &other) {
+    for (size_t i = 0; i < counts.size(); i++) {
+        counts[i] += other.counts[i];
+    }
+    count += other.count;
+    max = std::max(max, other.max);
+}
+
+uint64_t LatencyHistogram::percentile(double fraction) const {
+    if (count == 0) {
+        return 0;
+    }
+
+    auto rank = static_cast<uint64_t>(std::ceil(std::clamp(fraction, 0.0, 1.0) * count));
+    rank = std::max<uint64_t>(rank, 1);
+    uint64_t seen = 0;
+    for (size_t i = 0; i < counts.size(); i++) {
+        seen += counts[i];
+        if (seen >= rank) {
+            return std::min(highestOf(i), max);
+        }
+    }
+    return max;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+// Values from 2^e on, e >= SUB_BITS, are split into SUB_COUNT buckets of width 2^(e - SUB_BITS)
+size_t LatencyHistogram::indexOf(uint64_t value) {
+    if (value < LATENCY_HISTOGRAM_SUB_COUNT) {
+        return value;
+    }
+    auto exponent = static_cast<size_t>(63 - __builtin_clzll(value));
+    size_t shift = exponent - LATENCY_HISTOGRAM_SUB_BITS;
+    return LATENCY_HISTOGRAM_SUB_COUNT * (shift + 1) + ((value >> shift) - LATENCY_HISTOGRAM_SUB_COUNT);
+}
+
+uint64_t LatencyHistogram::highestOf(size_t index) {
+    if (index < LATENCY_HISTOGRAM_SUB_COUNT) {
+        return index;
+    }
+    size_t shift = index / LATENCY_HISTOGRAM_SUB_COUNT - 1;
+    uint64_t sub = index % LATENCY_HISTOGRAM_SUB_COUNT;
+    uint64_t lowest = (LATENCY_HISTOGRAM_SUB_COUNT + sub) << shift;
+    return lowest + ((uint64_t(1u) << shift) - 1);
+}
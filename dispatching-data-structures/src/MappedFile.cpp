@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "MappedFile.h"
+
+MappedFile::MappedFile(const std::string &path) {
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::invalid_argument("Could not open " + path + ": " + strerror(errno));
+    }
+
+    struct stat info{};
+    if (fstat(fd, &info) < 0) {
+        int error = errno;
+        close(fd);
+        throw std::invalid_argument("Could not stat " + path + ": " + strerror(error));
+    }
+    length = info.st_size;
+
+    // mmap does not accept empty mappings, an empty file is represented by a null address
+    if (length > 0) {
+        void *mapped = mmap(nullptr, length, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapped == MAP_FAILED) {
+            int error = errno;
+            close(fd);
+            throw std::invalid_argument("Could not map " + path + ": " + strerror(error));
+        }
+        address = static_cast<const uint8_t *>(mapped);
+
+        // The benchmarks walk the trace front to back
+        madvise(mapped, length, MADV_SEQUENTIAL);
+    }
+
+    // The mapping stays valid without the descriptor
+    close(fd);
+}
+
+void MappedFile::release(size_t offset, size_t size, size_t first) const {
+    static const size_t pageSize = sysconf(_SC_PAGESIZE);
+
+    // Touching the page behind the range can map the whole large folio around it again, including pages of a range
+    // that was released before. Those are released together with the next range, but never pages in front of first,
+    // which can hold data that was not consumed yet.
+    size_t begin = std::max((offset - std::min<size_t>(offset, MAPPED_FILE_RELEASE_OVERLAP)) / pageSize * pageSize,
+                            (first + pageSize - 1) / pageSize * pageSize);
+    size_t end = std::min(offset + size, length) / pageSize * pageSize;
+    if (address != nullptr && begin < end) {
+        madvise(const_cast<uint8_t *>(address) + begin, end - begin, MADV_DONTNEED);
+    }
+}
+
+MappedFile::~MappedFile() {
+    if (address != nullptr) {
+        munmap(const_cast<uint8_t *>(address), length);
+    }
+}
@@ -0,0 +1,108 @@
+#include <unordered_set>
+
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+#include "MemoryTracker.h"
+
+// Bytes malloc keeps in front of every chunk for its size
+#define MEMORY_MALLOC_HEADER sizeof(size_t)
+
+bool MemoryTracker::enabled = false;
+thread_local MemoryTracker *MemoryTracker::active = nullptr;
+
+void MemoryTracker::setEnabled(bool value) {
+    enabled = value;
+}
+
+bool MemoryTracker::isEnabled() {
+    return enabled;
+}
+
+// Header and rounding of a block returned by malloc, 0 where the usable size is unknown
+static size_t allocatorOverhead(const MemoryRegion &region) {
+#if defined(__GLIBC__)
+    if (region.heap) {
+        size_t usable = malloc_usable_size(const_cast<void *>(region.address));
+        return MEMORY_MALLOC_HEADER + (usable > region.bytes ? usable - region.bytes : 0);
+    }
+#endif
+    return 0;
+}
+
+MemoryUsage MemoryTracker::usage(const std::vector<MemoryRegion> &regions) const {
+    MemoryUsage usage;
+    std::unordered_set<uintptr_t> lines;
+    std::unordered_set<uintptr_t> pages;
+
+    auto add = [&](const MemoryRegion &region) {
+        switch (region.category) {
+            case MemoryCategory::TABLE:
+                usage.table += region.bytes;
+                break;
+            case MemoryCategory::METADATA:
+                usage.metadata += region.bytes;
+                break;
+            case MemoryCategory::NODES:
+                usage.nodes += region.bytes;
+                break;
+            case MemoryCategory::ANALYZERS:
+                usage.analyzers += region.bytes;
+                break;
+        }
+        usage.allocatorOverhead += allocatorOverhead(region);
+        usage.allocations += region.heap;
+
+        if (region.bytes == 0) {
+            return;
+        }
+        auto first = reinterpret_cast<uintptr_t>(region.address);
+        uintptr_t last = first + region.bytes - 1;
+        for (uintptr_t line = first / MEMORY_CACHE_LINE_SIZE; line <= last / MEMORY_CACHE_LINE_SIZE; line++) {
+            lines.insert(line);
+        }
+        for (uintptr_t page = first / MEMORY_PAGE_SIZE; page <= last / MEMORY_PAGE_SIZE; page++) {
+            pages.insert(page);
+        }
+    };
+
+    for (const auto &allocation : allocations) {
+        add(allocation.second);
+    }
+    for (const auto &region : regions) {
+        add(region);
+    }
+
+    usage.cacheLines = lines.size();
+    usage.pages = pages.size();
+    return usage;
+}
+
+const MemoryRegion *MemoryTracker::find(MemoryCategory category) const {
+    const MemoryRegion *largest = nullptr;
+    for (const auto &allocation : allocations) {
+        if (allocation.second.category == category && (largest == nullptr || allocation.second.bytes > largest->bytes)) {
+            largest = &allocation.second;
+        }
+    }
+    return largest;
+}
+
+std::vector<MemoryRegion> MemoryTracker::regions(const std::vector<MemoryRegion> &regions) const {
+    std::vector<MemoryRegion> result;
+    result.reserve(allocations.size() + regions.size());
+    for (const auto &allocation : allocations) {
+        result.push_back(allocation.second);
+    }
+    result.insert(result.end(), regions.begin(), regions.end());
+    return result;
+}
+
+std::ostream &operator<<(std::ostream &os, const MemoryUsage &usage) {
+    os << "table " << usage.table << " B, metadata " << usage.metadata << " B, nodes " << usage.nodes
+       << " B, allocator overhead " << usage.allocatorOverhead << " B, analyzers " << usage.analyzers << " B, total "
+       << usage.total() << " B in " << usage.allocations << " allocations, " << usage.cacheLines << " cache lines, "
+       << usage.pages << " pages";
+    return os;
+}
@@ -3,7 +3,7 @@
 
 #include "MyPacket.h"
 
-size_t MyPacket::objCount = 0;
+std::atomic<size_t> MyPacket::objCount{0};
 
 size_t MyPacket::getMaxIdentifierSize() {
     return sizeof(identifier_t);
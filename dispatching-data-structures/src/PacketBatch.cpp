@@ -0,0 +1,177 @@
+#include <limits>
+#include <stdexcept>
+
+#include "PacketBatch.h"
+#include "MappedFile.h"
+
+PacketBatch::PacketBatch(const PacketBatch &other)
+        : columns(other.columns), packetCount(other.packetCount), stackTotal(other.stackTotal),
+          identifierOffsets(other.identifierOffsets), payloadOffsets(other.payloadOffsets),
+          identifiers(other.identifiers), payloads(other.payloads), mapping(other.mapping) {
+    if (!mapping) {
+        updateColumns();
+    }
+}
+
+PacketBatch::PacketBatch(PacketBatch &&other) noexcept
+        : columns(other.columns), packetCount(other.packetCount), stackTotal(other.stackTotal),
+          identifierOffsets(std::move(other.identifierOffsets)), payloadOffsets(std::move(other.payloadOffsets)),
+          identifiers(std::move(other.identifiers)), payloads(std::move(other.payloads)),
+          mapping(std::move(other.mapping)) {
+    if (!mapping) {
+        updateColumns();
+    }
+    other.clear();
+}
+
+PacketBatch &PacketBatch::operator=(const PacketBatch &other) {
+    if (this != &other) {
+        *this = PacketBatch(other);
+    }
+    return *this;
+}
+
+PacketBatch &PacketBatch::operator=(PacketBatch &&other) noexcept {
+    if (this != &other) {
+        columns = other.columns;
+        packetCount = other.packetCount;
+        stackTotal = other.stackTotal;
+        identifierOffsets = std::move(other.identifierOffsets);
+        payloadOffsets = std::move(other.payloadOffsets);
+        identifiers = std::move(other.identifiers);
+        payloads = std::move(other.payloads);
+        mapping = std::move(other.mapping);
+        if (!mapping) {
+            updateColumns();
+        }
+        other.clear();
+    }
+    return *this;
+}
+
+void PacketBatch::reserve(size_t packetCount, size_t identifierCount, size_t payloadSize) {
+    if (mapping) {
+        return;
+    }
+    identifierOffsets.reserve(packetCount + 1);
+    payloadOffsets.reserve(packetCount + 1);
+    identifiers.reserve(identifierCount);
+    payloads.reserve(payloadSize);
+    updateColumns();
+}
+
+void PacketBatch::shrinkToFit() {
+    if (mapping) {
+        return;
+    }
+    identifierOffsets.shrink_to_fit();
+    payloadOffsets.shrink_to_fit();
+    identifiers.shrink_to_fit();
+    payloads.shrink_to_fit();
+    updateColumns();
+}
+
+void PacketBatch::add(const identifier_t *packetIdentifiers, size_t identifierCount, const uint8_t *payload,
+                      size_t payloadSize) {
+    if (mapping) {
+        throw std::runtime_error("Packets cannot be added to a mapped trace file.");
+    }
+    if (identifiers.size() + identifierCount > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Packet batch exceeds the maximum amount of identifiers.");
+    }
+
+    identifiers.insert(identifiers.end(), packetIdentifiers, packetIdentifiers + identifierCount);
+    payloads.insert(payloads.end(), payload, payload + payloadSize);
+    identifierOffsets.push_back(identifiers.size());
+    payloadOffsets.push_back(payloads.size());
+    updateColumns();
+}
+
+void PacketBatch::add(const MyPacket &packet) {
+    add(packet.getIdentifiers().data(), packet.getIdentifiers().size(),
+        packet.getPayload().data(), packet.getPayload().size());
+}
+
+void PacketBatch::append(const PacketBatch &other) {
+    if (mapping) {
+        throw std::runtime_error("Packets cannot be added to a mapped trace file.");
+    }
+    if (identifiers.size() + other.identifierCount() > std::numeric_limits<uint32_t>::max()) {
+        throw std::runtime_error("Packet batch exceeds the maximum amount of identifiers.");
+    }
+
+    // The offsets of the other batch are shifted behind the packets of this one
+    uint32_t identifierBase = identifiers.size();
+    uint64_t payloadBase = payloads.size();
+    for (size_t i = 1; i <= other.size(); i++) {
+        identifierOffsets.push_back(identifierBase + other.columns.identifierOffsets[i]);
+        payloadOffsets.push_back(payloadBase + other.columns.payloadOffsets[i]);
+    }
+    identifiers.insert(identifiers.end(), other.columns.identifiers, other.columns.identifiers + other.identifierCount());
+    payloads.insert(payloads.end(), other.columns.payloads, other.columns.payloads + other.payloadSize());
+    updateColumns();
+}
+
+void PacketBatch::clear() {
+    mapping.reset();
+    identifierOffsets.assign(1, 0);
+    payloadOffsets.assign(1, 0);
+    identifiers.clear();
+    payloads.clear();
+    updateColumns();
+}
+
+size_t PacketBatch::bytes() const {
+    if (mapping) {
+        return mapping->size();
+    }
+
+    return identifierOffsets.capacity() * sizeof(uint32_t)
+           + payloadOffsets.capacity() * sizeof(uint64_t)
+           + identifiers.capacity() * sizeof(identifier_t)
+           + payloads.capacity();
+}
+
+void PacketBatch::release(size_t begin, size_t end) const {
+    if (!mapping || begin >= end) {
+        return;
+    }
+
+    // Only the consumed part of each column, the pages in front of it belong to other columns
+    auto releaseColumn = [this](const void *column, size_t offset, size_t size) {
+        size_t first = static_cast<const uint8_t *>(column) - mapping->data();
+        mapping->release(first + offset, size, first);
+    };
+    releaseColumn(columns.identifierOffsets, begin * sizeof(uint32_t), (end - begin) * sizeof(uint32_t));
+    releaseColumn(columns.payloadOffsets, begin * sizeof(uint64_t), (end - begin) * sizeof(uint64_t));
+    releaseColumn(columns.identifiers, columns.identifierOffsets[begin] * sizeof(identifier_t),
+                  (columns.identifierOffsets[end] - columns.identifierOffsets[begin]) * sizeof(identifier_t));
+    releaseColumn(columns.payloads, columns.payloadOffsets[begin], columns.payloadOffsets[end] - columns.payloadOffsets[begin]);
+    if (hasStacks()) {
+        releaseColumn(columns.packetStacks, begin * sizeof(uint32_t), (end - begin) * sizeof(uint32_t));
+    }
+}
+
+// #######################
+// ####### PRIVATE #######
+// #######################
+
+PacketBatch::PacketBatch(std::shared_ptr<const MappedFile> mapping, const Columns &columns, size_t packetCount,
+                         size_t stackCount)
+        : columns(columns), packetCount(packetCount), stackTotal(stackCount), mapping(std::move(mapping)) {
+}
+
+// Points the columns to the owned vectors, needed after every change that may reallocate them
+void PacketBatch::updateColumns() {
+    columns = Columns{
+            identifierOffsets.data(),
+            payloadOffsets.data(),
+            identifiers.data(),
+            payloads.data(),
+            nullptr,
+            nullptr,
+            nullptr
+    };
+    packetCount = identifierOffsets.size() - 1;
+    stackTotal = 0;
+}
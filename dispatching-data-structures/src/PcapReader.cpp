@@ -0,0 +1,181 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <stdexcept>
+
+#include "PcapReader.h"
+
+#define PCAP_FILE_HEADER_SIZE 24
+#define PCAP_RECORD_HEADER_SIZE 16
+
+// Block type, block length and the trailing copy of the block length
+#define PCAPNG_BLOCK_OVERHEAD 12
+#define PCAPNG_INTERFACE_DESCRIPTION 0x1
+#define PCAPNG_PACKET 0x2
+#define PCAPNG_SIMPLE_PACKET 0x3
+#define PCAPNG_ENHANCED_PACKET 0x6
+
+PcapReader::PcapReader(const std::string &path) : file(path) {
+    if (file.size() < sizeof(uint32_t)) {
+        throw std::invalid_argument("File is too small for a pcap file.");
+    }
+
+    uint32_t magic;
+    memcpy(&magic, file.data(), sizeof(magic));
+    if (magic == PCAPNG_SECTION_HEADER) {
+        // The byte order is determined by every section header
+        pcapng = true;
+        return;
+    }
+
+    if (magic == PCAP_MAGIC || magic == PCAP_MAGIC_NANOSECONDS) {
+        swapped = false;
+    } else if (__builtin_bswap32(magic) == PCAP_MAGIC || __builtin_bswap32(magic) == PCAP_MAGIC_NANOSECONDS) {
+        swapped = true;
+    } else {
+        throw std::invalid_argument("Not a pcap or pcapng file.");
+    }
+
+    if (file.size() < PCAP_FILE_HEADER_SIZE) {
+        throw std::invalid_argument("File is too small for a pcap header.");
+    }
+    // The upper bits may contain FCS information
+    linkType = load32(20) & 0xFFFFu;
+    position = PCAP_FILE_HEADER_SIZE;
+}
+
+bool PcapReader::next(PcapRecord &record) {
+    return pcapng ? nextPcapng(record) : nextPcap(record);
+}
+
+void PcapReader::release() {
+    file.release(released, position - released);
+    released = position;
+}
+
+bool PcapReader::isPcapFile(const std::string &path) {
+    std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+    uint32_t magic;
+    if (!file.read(reinterpret_cast<char *>(&magic), sizeof(magic))) {
+        return false;
+    }
+
+    return magic == PCAPNG_SECTION_HEADER ||
+           magic == PCAP_MAGIC || magic == PCAP_MAGIC_NANOSECONDS ||
+           __builtin_bswap32(magic) == PCAP_MAGIC || __builtin_bswap32(magic) == PCAP_MAGIC_NANOSECONDS;
+}
+
+// #######################
+// ####### PRIVATE #######
+// #######################
+
+bool PcapReader::nextPcap(PcapRecord &record) {
+    if (position + PCAP_RECORD_HEADER_SIZE > file.size()) {
+        return false;
+    }
+
+    uint32_t capturedLength = load32(position + 8);
+    if (capturedLength > file.size() - position - PCAP_RECORD_HEADER_SIZE) {
+        return false;
+    }
+
+    record = PcapRecord{linkType, file.data() + position + PCAP_RECORD_HEADER_SIZE, capturedLength};
+    position += PCAP_RECORD_HEADER_SIZE + capturedLength;
+    return true;
+}
+
+bool PcapReader::nextPcapng(PcapRecord &record) {
+    while (position + PCAPNG_BLOCK_OVERHEAD <= file.size()) {
+        // The section header type reads the same in both byte orders
+        uint32_t type = load32(position);
+        if (type == PCAPNG_SECTION_HEADER) {
+            uint32_t magic;
+            memcpy(&magic, file.data() + position + 8, sizeof(magic));
+            if (magic == PCAPNG_BYTE_ORDER_MAGIC) {
+                swapped = false;
+            } else if (__builtin_bswap32(magic) == PCAPNG_BYTE_ORDER_MAGIC) {
+                swapped = true;
+            } else {
+                throw std::invalid_argument("Invalid byte order magic in pcapng section header.");
+            }
+            interfaceLinkTypes.clear();
+        }
+
+        uint32_t length = load32(position + 4);
+        if (length < PCAPNG_BLOCK_OVERHEAD || length > file.size() - position) {
+            return false;
+        }
+
+        size_t body = position + 8;
+        size_t bodyLength = length - PCAPNG_BLOCK_OVERHEAD;
+        position += length;
+
+        // Fixed fields in front of the packet data
+        size_t dataOffset;
+        switch (type) {
+            case PCAPNG_INTERFACE_DESCRIPTION:
+                dataOffset = 8;
+                break;
+            case PCAPNG_ENHANCED_PACKET:
+            case PCAPNG_PACKET:
+                dataOffset = 20;
+                break;
+            case PCAPNG_SIMPLE_PACKET:
+                dataOffset = 4;
+                break;
+            default:
+                continue;
+        }
+        if (dataOffset > bodyLength) {
+            throw std::invalid_argument("Block of type " + std::to_string(type) + " is too short.");
+        }
+
+        uint32_t interface = 0;
+        uint32_t capturedLength;
+        switch (type) {
+            case PCAPNG_INTERFACE_DESCRIPTION: {
+                interfaceLinkTypes.push_back(load16(body));
+                continue;
+            }
+            case PCAPNG_ENHANCED_PACKET: {
+                interface = load32(body);
+                capturedLength = load32(body + 12);
+                break;
+            }
+            case PCAPNG_SIMPLE_PACKET: {
+                // Always belongs to the first interface, the captured length is only implied by the block length
+                capturedLength = std::min<size_t>(load32(body), bodyLength - dataOffset);
+                break;
+            }
+            default: {
+                // Obsolete packet block
+                interface = load16(body);
+                capturedLength = load32(body + 12);
+                break;
+            }
+        }
+
+        if (capturedLength > bodyLength - dataOffset) {
+            throw std::invalid_argument("Packet block exceeds its block length.");
+        } else if (interface >= interfaceLinkTypes.size()) {
+            throw std::invalid_argument("Packet block refers to unknown interface " + std::to_string(interface) + ".");
+        }
+
+        record = PcapRecord{interfaceLinkTypes[interface], file.data() + body + dataOffset, capturedLength};
+        return true;
+    }
+
+    return false;
+}
+
+uint16_t PcapReader::load16(size_t offset) const {
+    uint16_t value;
+    memcpy(&value, file.data() + offset, sizeof(value));
+    return swapped ? __builtin_bswap16(value) : value;
+}
+
+uint32_t PcapReader::load32(size_t offset) const {
+    uint32_t value;
+    memcpy(&value, file.data() + offset, sizeof(value));
+    return swapped ? __builtin_bswap32(value) : value;
+}
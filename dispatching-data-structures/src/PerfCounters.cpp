@@ -0,0 +1,141 @@
+#include <cstring>
+#include <linux/perf_event.h>
+#include <stdexcept>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+#include "PerfCounters.h"
+
+// Read misses of a generic cache (see perf_event_open(2))
+#define CACHE_READ_MISSES(cache) \
+    ((cache) | (PERF_COUNT_HW_CACHE_OP_READ << 8u) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16u))
+
+static int perfEventOpen(perf_event_attr &attributes, int groupDescriptor) {
+    return static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, groupDescriptor, 0));
+}
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+PerfCounters::PerfCounters() {
+    std::vector<Event> hardwareEvents = {
+        {"cycles", PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES},
+        {"instructions", PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS},
+        {"branch_misses", PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES},
+        {"l1d_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_L1D)},
+        {"llc_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_LL)},
+        {"dtlb_misses", PERF_TYPE_HW_CACHE, CACHE_READ_MISSES(PERF_COUNT_HW_CACHE_DTLB)},
+    };
+    std::vector<Event> softwareEvents = {
+        {"task_clock_ns", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_TASK_CLOCK},
+        {"page_faults", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_PAGE_FAULTS},
+        {"context_switches", PERF_TYPE_SOFTWARE, PERF_COUNT_SW_CONTEXT_SWITCHES},
+    };
+
+    if (openGroup(hardwareEvents) > 0) {
+        shrinkToSchedulable();
+    }
+    hardware = !descriptors.empty();
+
+    // Virtual machines and containers often provide no PMU at all
+    if (!hardware && openGroup(softwareEvents) == 0) {
+        throw std::runtime_error("No performance counter could be opened, check /proc/sys/kernel/perf_event_paranoid.");
+    }
+    values.assign(descriptors.size(), 0);
+}
+
+PerfCounters::~PerfCounters() {
+    closeAll();
+}
+
+void PerfCounters::start() {
+    ioctl(descriptors[0], PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+    ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::pause() {
+    ioctl(descriptors[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::resume() {
+    ioctl(descriptors[0], PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+}
+
+void PerfCounters::stop() {
+    ioctl(descriptors[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+    if (!readGroup()) {
+        throw std::runtime_error("The performance counters were never scheduled.");
+    }
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+size_t PerfCounters::openGroup(const std::vector<Event> &events) {
+    for (const auto &event : events) {
+        perf_event_attr attributes;
+        std::memset(&attributes, 0, sizeof(attributes));
+        attributes.size = sizeof(attributes);
+        attributes.type = event.type;
+        attributes.config = event.config;
+        attributes.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+        // Only the leader is disabled, the members follow it. User space only works with perf_event_paranoid = 2.
+        attributes.disabled = descriptors.empty();
+        attributes.exclude_kernel = 1;
+        attributes.exclude_hv = 1;
+
+        int descriptor = perfEventOpen(attributes, descriptors.empty() ? -1 : descriptors[0]);
+        if (descriptor >= 0) {
+            descriptors.push_back(descriptor);
+            names.emplace_back(event.name);
+        }
+    }
+    values.assign(descriptors.size(), 0);
+    return descriptors.size();
+}
+
+void PerfCounters::shrinkToSchedulable() {
+    while (!descriptors.empty()) {
+        // Some work, so a schedulable group certainly runs for a moment
+        start();
+        volatile uint64_t sum = 0;
+        for (uint64_t i = 0; i < 100000; i++) {
+            sum = sum + i;
+        }
+        ioctl(descriptors[0], PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+        if (readGroup()) {
+            return;
+        }
+
+        close(descriptors.back());
+        descriptors.pop_back();
+        names.pop_back();
+        values.pop_back();
+    }
+}
+
+void PerfCounters::closeAll() {
+    for (auto it = descriptors.rbegin(); it != descriptors.rend(); it++) {
+        close(*it);
+    }
+    descriptors.clear();
+    names.clear();
+    values.clear();
+}
+
+bool PerfCounters::readGroup() {
+    // Layout of PERF_FORMAT_GROUP: count, time enabled, time running and one value per event
+    std::vector<uint64_t> buffer(3 + descriptors.size());
+    ssize_t size = ::read(descriptors[0], buffer.data(), buffer.size() * sizeof(uint64_t));
+    if (size != static_cast<ssize_t>(buffer.size() * sizeof(uint64_t)) || buffer[2] == 0) {
+        return false;
+    }
+
+    double scale = static_cast<double>(buffer[1]) / buffer[2];
+    for (size_t i = 0; i < descriptors.size(); i++) {
+        values[i] = static_cast<uint64_t>(buffer[3 + i] * scale);
+    }
+    return true;
+}
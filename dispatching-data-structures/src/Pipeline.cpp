@@ -0,0 +1,352 @@
+#include <algorithm>
+#include <limits>
+#include <pthread.h>
+#include <stdexcept>
+#include <thread>
+
+#include "Pipeline.h"
+#include "FlowHash.h"
+#include "Timing.h"
+
+static uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+Pipeline::Pipeline(const PipelineConfig &config, const dispatcher_factory &makeDispatcher,
+                   const std::map<identifier_t, analyzer_builder> &analyzerBuilders) : config(config), indirection{} {
+    if (config.workerCount == 0 || config.batchSize == 0 || config.ringSize < config.batchSize) {
+        throw std::invalid_argument("The pipeline needs at least one worker, and rings that hold at least one batch.");
+    }
+
+    // Every worker has its own dispatcher and analyzers, like the workers of a deployed monitor. In steal mode the
+    // rings carry batches, and every worker can hold as many batches in its deque as in its ring.
+    size_t ringCapacity = config.steal ? std::max<size_t>(1, config.ringSize / config.batchSize) : config.ringSize;
+    for (size_t i = 0; i < config.workerCount; i++) {
+        dispatchers.push_back(makeDispatcher());
+        dispatchers.back()->registerAnalyzers(analyzerBuilders);
+        rings.push_back(std::make_unique<SpscRing<uint32_t>>(ringCapacity));
+        if (config.steal) {
+            deques.push_back(std::make_unique<WorkStealingDeque<uint32_t>>(rings.back()->capacity()));
+        }
+    }
+    if (config.steal) {
+        buckets = std::make_unique<BucketState[]>(PIPELINE_INDIRECTION_SIZE);
+    }
+
+    // Spread the hash values round robin over the workers, like the default indirection table of NICs
+    for (size_t i = 0; i < PIPELINE_INDIRECTION_SIZE; i++) {
+        indirection[i] = i % config.workerCount;
+    }
+}
+
+Pipeline::~Pipeline() {
+    for (auto &dispatcher : dispatchers) {
+        dispatcher->clear();
+    }
+}
+
+uint64_t Pipeline::run(const PacketBatch &frames) {
+    if (frames.size() > std::numeric_limits<uint32_t>::max()) {
+        throw std::invalid_argument("Too many frames for the pipeline.");
+    }
+
+    readerStatistics = StageStatistics();
+    workerStatistics.assign(config.workerCount, StageStatistics());
+    finished.store(false);
+    if (config.steal) {
+        // Every indirection entry leaves at most one partial batch
+        batches.resize(frames.size() / config.batchSize + PIPELINE_INDIRECTION_SIZE);
+        slots.resize(batches.size() * config.batchSize);
+        for (size_t i = 0; i < PIPELINE_INDIRECTION_SIZE; i++) {
+            buckets[i].completed.store(0);
+        }
+        batchCount = 0;
+        completedBatches.store(0);
+    }
+    start = std::chrono::steady_clock::now();
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < config.workerCount; i++) {
+        workers.emplace_back(config.steal ? &Pipeline::workStealing : &Pipeline::work, this, i, std::cref(frames));
+    }
+    std::thread reader(config.steal ? &Pipeline::readBatches : &Pipeline::read, this, std::cref(frames));
+
+    reader.join();
+    for (auto &worker : workers) {
+        worker.join();
+    }
+    return nanosecondsSince(start);
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+void Pipeline::read(const PacketBatch &frames) {
+    if (config.pin) {
+        pin(0);
+    }
+
+    StageStatistics &statistics = readerStatistics;
+    std::vector<std::vector<uint32_t>> pending(config.workerCount);
+    for (auto &batch : pending) {
+        batch.reserve(config.batchSize);
+    }
+
+    // Enqueues the pending frames of a worker, waits for free slots or drops the rest if the ring is full
+    auto flush = [&](size_t worker) {
+        std::vector<uint32_t> &batch = pending[worker];
+        size_t pushed = rings[worker]->push(batch.data(), batch.size());
+        if (pushed < batch.size()) {
+            if (config.drop) {
+                statistics.drops += batch.size() - pushed;
+            } else {
+                auto stallStart = std::chrono::steady_clock::now();
+                while (pushed < batch.size()) {
+                    std::this_thread::yield();
+                    pushed += rings[worker]->push(batch.data() + pushed, batch.size() - pushed);
+                }
+                statistics.stallTime += nanosecondsSince(stallStart);
+            }
+        }
+        batch.clear();
+    };
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        size_t worker = indirection[bucketOf(frames[i])];
+
+        pending[worker].push_back(i);
+        if (pending[worker].size() == config.batchSize) {
+            flush(worker);
+        }
+    }
+    for (size_t worker = 0; worker < config.workerCount; worker++) {
+        flush(worker);
+    }
+    finished.store(true, std::memory_order_release);
+
+    statistics.frames = frames.size() - statistics.drops;
+    statistics.time = nanosecondsSince(start);
+    statistics.busyTime = statistics.time - statistics.stallTime;
+}
+
+void Pipeline::work(size_t worker, const PacketBatch &frames) {
+    if (config.pin) {
+        pin(worker + 1);
+    }
+
+    StageStatistics &statistics = workerStatistics[worker];
+    SpscRing<uint32_t> &ring = *rings[worker];
+    IDispatcher &dispatcher = *dispatchers[worker];
+    std::vector<uint32_t> batch(config.batchSize);
+
+    while (true) {
+        size_t occupancy = ring.size();
+        size_t count = ring.pop(batch.data(), batch.size());
+        if (count == 0) {
+            // Everything the reader enqueued is visible once it finished, so an empty ring after that is final
+            if (!finished.load(std::memory_order_acquire)) {
+                std::this_thread::yield();
+                continue;
+            }
+            occupancy = ring.size();
+            count = ring.pop(batch.data(), batch.size());
+            if (count == 0) {
+                break;
+            }
+        }
+
+        statistics.occupancySum += occupancy;
+        statistics.occupancySamples++;
+        statistics.maxOccupancy = std::max<uint64_t>(statistics.maxOccupancy, occupancy);
+
+        auto busyStart = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < count; i++) {
+            statistics.lookups += dispatch(dispatcher, frames[batch[i]]);
+        }
+        statistics.busyTime += nanosecondsSince(busyStart);
+        statistics.frames += count;
+    }
+
+    statistics.time = nanosecondsSince(start);
+}
+
+void Pipeline::readBatches(const PacketBatch &frames) {
+    if (config.pin) {
+        pin(0);
+    }
+
+    StageStatistics &statistics = readerStatistics;
+    std::vector<std::vector<uint32_t>> pending(PIPELINE_INDIRECTION_SIZE);
+    for (auto &batch : pending) {
+        batch.reserve(config.batchSize);
+    }
+    std::vector<uint32_t> sequences(PIPELINE_INDIRECTION_SIZE, 0);
+    size_t nextSlot = 0;
+
+    // Stores the pending frames of an entry as the next batch and enqueues it. A dropped batch does not take a
+    // sequence number, so the workers never wait for it.
+    auto flush = [&](size_t bucket) {
+        std::vector<uint32_t> &frameIndices = pending[bucket];
+        if (frameIndices.empty()) {
+            return;
+        }
+
+        auto id = static_cast<uint32_t>(batchCount);
+        batches[id] = {static_cast<uint32_t>(bucket), sequences[bucket], static_cast<uint32_t>(frameIndices.size()),
+                       nextSlot};
+        std::copy(frameIndices.begin(), frameIndices.end(), slots.begin() + nextSlot);
+
+        SpscRing<uint32_t> &ring = *rings[indirection[bucket]];
+        if (ring.push(&id, 1) == 0) {
+            if (config.drop) {
+                statistics.drops += frameIndices.size();
+                frameIndices.clear();
+                return;
+            }
+            auto stallStart = std::chrono::steady_clock::now();
+            while (ring.push(&id, 1) == 0) {
+                std::this_thread::yield();
+            }
+            statistics.stallTime += nanosecondsSince(stallStart);
+        }
+
+        batchCount++;
+        sequences[bucket]++;
+        nextSlot += frameIndices.size();
+        frameIndices.clear();
+    };
+
+    for (size_t i = 0; i < frames.size(); i++) {
+        size_t bucket = bucketOf(frames[i]);
+        pending[bucket].push_back(i);
+        if (pending[bucket].size() == config.batchSize) {
+            flush(bucket);
+        }
+    }
+    for (size_t bucket = 0; bucket < PIPELINE_INDIRECTION_SIZE; bucket++) {
+        flush(bucket);
+    }
+    finished.store(true, std::memory_order_release);
+
+    statistics.frames = frames.size() - statistics.drops;
+    statistics.time = nanosecondsSince(start);
+    statistics.busyTime = statistics.time - statistics.stallTime;
+}
+
+void Pipeline::workStealing(size_t worker, const PacketBatch &frames) {
+    if (config.pin) {
+        pin(worker + 1);
+    }
+
+    StageStatistics &statistics = workerStatistics[worker];
+    SpscRing<uint32_t> &ring = *rings[worker];
+    WorkStealingDeque<uint32_t> &deque = *deques[worker];
+    IDispatcher &dispatcher = *dispatchers[worker];
+    std::vector<uint32_t> inbox(deque.capacity());
+
+    // A batch is ready once all earlier batches of its entry are dispatched
+    auto ready = [&](uint32_t id) {
+        const Batch &batch = batches[id];
+        return !config.ordered ||
+               buckets[batch.bucket].completed.load(std::memory_order_acquire) == batch.sequence;
+    };
+
+    while (true) {
+        // Refill the empty deque from the ring, the oldest batch goes to the top
+        if (deque.size() == 0) {
+            size_t occupancy = ring.size();
+            size_t count = ring.pop(inbox.data(), inbox.size());
+            if (count > 0) {
+                statistics.occupancySum += occupancy;
+                statistics.occupancySamples++;
+                statistics.maxOccupancy = std::max<uint64_t>(statistics.maxOccupancy, occupancy);
+                for (size_t i = 0; i < count; i++) {
+                    deque.push(inbox[i]);
+                }
+            }
+        }
+
+        // Ordered, the owner takes the oldest batch like the thieves, so the batch it waits for is never behind it in
+        // its own deque. Unordered, it takes the newest one, whose frames are more likely still cached.
+        uint32_t id;
+        bool stolen = false;
+        bool own;
+        if (config.ordered) {
+            StealResult result;
+            while ((result = deque.steal(id)) == StealResult::ABORT) {}
+            own = result == StealResult::SUCCESS;
+        } else {
+            own = deque.pop(id);
+        }
+        if (!own) {
+            for (size_t i = 1; i < config.workerCount && !stolen; i++) {
+                stolen = deques[(worker + i) % config.workerCount]->steal(id, ready) == StealResult::SUCCESS;
+            }
+            if (!stolen) {
+                // Everything the reader enqueued is counted once it finished, so nothing can arrive after that
+                if (finished.load(std::memory_order_acquire) &&
+                    completedBatches.load(std::memory_order_acquire) == batchCount) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+        }
+
+        // An earlier batch of the entry can only be missing if a thief is dispatching it
+        const Batch &batch = batches[id];
+        while (!ready(id)) {
+            std::this_thread::yield();
+        }
+
+        auto busyStart = std::chrono::steady_clock::now();
+        for (size_t i = batch.firstSlot; i < batch.firstSlot + batch.count; i++) {
+            statistics.lookups += dispatch(dispatcher, frames[slots[i]]);
+        }
+        statistics.busyTime += nanosecondsSince(busyStart);
+        statistics.frames += batch.count;
+        if (stolen) {
+            statistics.stolen += batch.count;
+        }
+
+        buckets[batch.bucket].completed.store(batch.sequence + 1, std::memory_order_release);
+        completedBatches.fetch_add(1, std::memory_order_acq_rel);
+    }
+
+    statistics.time = nanosecondsSince(start);
+}
+
+size_t Pipeline::bucketOf(const PacketView &frame) const {
+    identifier_t linkLayer = frame.getIdentifiers().empty() ? 0 : frame.getIdentifiers()[0];
+    return FlowHash::hash(frame.getPayload(), linkLayer) % PIPELINE_INDIRECTION_SIZE;
+}
+
+size_t Pipeline::dispatch(IDispatcher &dispatcher, const PacketView &frame) {
+    TIMING_SCOPE("pipeline_dispatch");
+    if (frame.getIdentifiers().empty()) {
+        return 0;
+    }
+
+    size_t lookups = 0;
+    ParseResult result = ParseResult::nextLayer(frame.getIdentifiers()[0], 0);
+    while (result.hasNext) {
+        IAnalyzer *analyzer = dispatcher.lookup(result.next);
+        lookups++;
+        if (analyzer == nullptr) {
+            break;
+        }
+        result = analyzer->parse(frame.getPayload(), result.offset);
+    }
+    return lookups;
+}
+
+void Pipeline::pin(size_t core) {
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(core % std::thread::hardware_concurrency(), &cpus);
+    pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+}
@@ -0,0 +1,258 @@
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <thread>
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#include "TextTraceParser.h"
+#include "MappedFile.h"
+
+// Same characters as std::isspace in the C locale, which separated the fields of the istream based parser
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f';
+}
+
+// Value of a hex digit, or -1 if the character is none
+static inline int hexValue(char c) {
+    if (c >= '0' && c <= '9') {
+        return c - '0';
+    }
+    char lower = static_cast<char>(c | 0x20);
+    if (lower >= 'a' && lower <= 'f') {
+        return lower - 'a' + 10;
+    }
+    return -1;
+}
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+PacketBatch TextTraceParser::parse(const std::string &path, size_t threadCount) {
+    MappedFile file(path);
+    const char *begin = reinterpret_cast<const char *>(file.data());
+    const char *end = begin + file.size();
+
+    // Skip first line with the marker
+    const char *data = static_cast<const char *>(memchr(begin, '\n', end - begin));
+    if (data == nullptr) {
+        return PacketBatch();
+    }
+    data++;
+
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    size_t chunkCount = std::max<size_t>(1, std::min<size_t>(threadCount, (end - data) / TEXT_TRACE_MIN_CHUNK_SIZE));
+
+    // Split at the first line break behind every equally sized part
+    std::vector<Chunk> chunks(chunkCount);
+    const char *chunkBegin = data;
+    for (size_t i = 0; i < chunkCount; i++) {
+        const char *chunkEnd = end;
+        if (i + 1 < chunkCount) {
+            chunkEnd = std::max(chunkBegin, data + (end - data) / chunkCount * (i + 1));
+            const char *lineEnd = static_cast<const char *>(memchr(chunkEnd, '\n', end - chunkEnd));
+            chunkEnd = lineEnd == nullptr ? end : lineEnd + 1;
+        }
+        chunks[i].begin = chunkBegin;
+        chunks[i].end = chunkEnd;
+        chunkBegin = chunkEnd;
+    }
+
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < chunkCount; i++) {
+        threads.emplace_back(parseChunk, std::ref(chunks[i]));
+    }
+    parseChunk(chunks[0]);
+    for (auto &thread : threads) {
+        thread.join();
+    }
+
+    // Report the first error in the file, all chunks before it were parsed completely
+    size_t lineOffset = 1;
+    size_t packetCount = 0;
+    size_t identifierCount = 0;
+    size_t payloadSize = 0;
+    for (const auto &chunk : chunks) {
+        if (chunk.failed) {
+            throw std::invalid_argument("Line " + std::to_string(lineOffset + chunk.errorLine) + chunk.error);
+        }
+        lineOffset += chunk.lineCount;
+        packetCount += chunk.packets.size();
+        identifierCount += chunk.packets.identifierCount();
+        payloadSize += chunk.packets.payloadSize();
+    }
+
+    if (chunkCount == 1) {
+        return std::move(chunks[0].packets);
+    }
+
+    PacketBatch packets;
+    packets.reserve(packetCount, identifierCount, payloadSize);
+    for (const auto &chunk : chunks) {
+        packets.append(chunk.packets);
+    }
+    return packets;
+}
+
+bool TextTraceParser::decodeHex(const char *begin, const char *end, std::vector<uint8_t> &target) {
+    size_t offset = target.size();
+    target.resize(offset + (end - begin + 1) / 2);
+    uint8_t *output = target.data() + offset;
+
+#ifdef __SSE2__
+    // 16 digits at once: map every digit to its nibble, then merge the pairs of nibbles into bytes
+    const __m128i zero = _mm_setzero_si128();
+    while (end - begin >= 16) {
+        __m128i input = _mm_loadu_si128(reinterpret_cast<const __m128i *>(begin));
+        __m128i digits = _mm_sub_epi8(input, _mm_set1_epi8('0'));
+        __m128i letters = _mm_sub_epi8(_mm_or_si128(input, _mm_set1_epi8(0x20)), _mm_set1_epi8('a'));
+
+        // Unsigned x <= n iff min(x, n) == x
+        __m128i isDigit = _mm_cmpeq_epi8(_mm_min_epu8(digits, _mm_set1_epi8(9)), digits);
+        __m128i isLetter = _mm_cmpeq_epi8(_mm_min_epu8(letters, _mm_set1_epi8(5)), letters);
+        if (_mm_movemask_epi8(_mm_or_si128(isDigit, isLetter)) != 0xFFFF) {
+            return false;
+        }
+
+        __m128i nibbles = _mm_or_si128(
+                _mm_and_si128(isDigit, digits),
+                _mm_andnot_si128(isDigit, _mm_add_epi8(letters, _mm_set1_epi8(10)))
+        );
+
+        // Every 16 bit lane holds the high nibble in its low byte and the low nibble in its high byte
+        __m128i high = _mm_slli_epi16(_mm_and_si128(nibbles, _mm_set1_epi16(0x00FF)), 4);
+        __m128i low = _mm_srli_epi16(nibbles, 8);
+        __m128i bytes = _mm_packus_epi16(_mm_or_si128(high, low), zero);
+        _mm_storel_epi64(reinterpret_cast<__m128i *>(output), bytes);
+
+        begin += 16;
+        output += 8;
+    }
+#endif
+
+    for (; end - begin >= 2; begin += 2) {
+        int high = hexValue(begin[0]);
+        int low = hexValue(begin[1]);
+        if (high < 0 || low < 0) {
+            return false;
+        }
+        *output++ = static_cast<uint8_t>(high << 4 | low);
+    }
+
+    if (begin != end) {
+        int value = hexValue(*begin);
+        if (value < 0) {
+            return false;
+        }
+        *output = static_cast<uint8_t>(value);
+    }
+
+    return true;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+void TextTraceParser::parseChunk(Chunk &chunk) {
+    // Reused for every line, so parsing does not allocate per token
+    std::vector<std::pair<const char *, const char *>> fields;
+    std::vector<identifier_t> identifiers;
+    std::vector<uint8_t> payload;
+
+    const char *position = chunk.begin;
+    while (position < chunk.end) {
+        const char *lineEnd = static_cast<const char *>(memchr(position, '\n', chunk.end - position));
+        if (lineEnd == nullptr) {
+            lineEnd = chunk.end;
+        }
+        chunk.lineCount++;
+
+        if (!parseLine(position, lineEnd, fields, identifiers, payload, chunk.error)) {
+            chunk.failed = true;
+            chunk.errorLine = chunk.lineCount;
+            return;
+        }
+        chunk.packets.add(identifiers.data(), identifiers.size(), payload.data(), payload.size());
+
+        position = lineEnd + 1;
+    }
+
+    chunk.packets.shrinkToFit();
+}
+
+bool TextTraceParser::parseLine(const char *begin, const char *end,
+                                std::vector<std::pair<const char *, const char *>> &fields,
+                                std::vector<identifier_t> &identifiers, std::vector<uint8_t> &payload,
+                                std::string &error) {
+    if (begin == end) {
+        error = " is empty.";
+        return false;
+    }
+
+    fields.clear();
+    for (const char *current = begin; current < end;) {
+        while (current < end && isSpace(*current)) {
+            current++;
+        }
+        const char *fieldBegin = current;
+        while (current < end && !isSpace(*current)) {
+            current++;
+        }
+        if (fieldBegin != current) {
+            // Strip leading 0x if it exists
+            if (current - fieldBegin >= 2 && fieldBegin[0] == '0' && fieldBegin[1] == 'x') {
+                fieldBegin += 2;
+            }
+            fields.emplace_back(fieldBegin, current);
+        }
+    }
+
+    if (fields.empty()) {
+        error = ": Packet is empty.";
+        return false;
+    } else if (fields.size() == 1) {
+        error = ": Packet contains only a payload.";
+        return false;
+    }
+
+    // Last token in a line is the payload
+    identifiers.clear();
+    for (size_t i = 0; i < fields.size() - 1; i++) {
+        const char *fieldBegin = fields[i].first;
+        const char *fieldEnd = fields[i].second;
+
+        // 2 chars of a hex string == 1 byte
+        if (static_cast<size_t>(fieldEnd - fieldBegin) > 2 * sizeof(identifier_t)) {
+            error = ": Identifier " + std::string(fieldBegin, fieldEnd) +
+                    " has more than " + std::to_string(sizeof(identifier_t)) + " bytes.";
+            return false;
+        }
+
+        identifier_t identifier = 0;
+        bool valid = fieldBegin != fieldEnd;
+        for (const char *current = fieldBegin; current < fieldEnd && valid; current++) {
+            int value = hexValue(*current);
+            valid = value >= 0;
+            identifier = static_cast<identifier_t>(identifier << 4u | value);
+        }
+        if (!valid) {
+            error = ": Identifier " + std::string(fieldBegin, fieldEnd) +
+                    " contains invalid characters (only hex allowed).";
+            return false;
+        }
+        identifiers.push_back(identifier);
+    }
+
+    payload.clear();
+    if (!decodeHex(fields.back().first, fields.back().second, payload)) {
+        error = ": Payload contains invalid characters (only hex allowed).";
+        return false;
+    }
+
+    return true;
+}
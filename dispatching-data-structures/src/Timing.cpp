@@ -1,304 +1,183 @@
 #include "Timing.h"
 
-#include <map>
-#include <chrono>
-#include <iostream>
-#include <sstream>
-#include <iomanip>
+#include <algorithm>
 #include <cmath>
 #include <fstream>
-#include <numeric>
-#include <vector>
-#include <algorithm>
-
-std::map<std::string, uint64_t> measurements;
-std::map<std::string, std::vector<uint64_t>> allmeasurements;
-std::map<std::string, uint64_t> numMeasurements;
-std::map<std::string, std::chrono::time_point<std::chrono::high_resolution_clock>> measureStarts;
-
-std::string Timing::fmtTime(uint64_t time) {
-    std::stringstream ss;
-    ss << std::setprecision(3) << std::fixed << std::setfill(' ') << std::setw(11);
-    if (time < 10'000) {
-        ss << (double) time << "ns";
-    } else if (time < 10'000'000) {
-        ss << time / 1E3 << "µs";
-    } else if (time < 10'000'000'000){
-        ss << time / 1E6 << "ms";
-    } else {
-        ss << time / 1E9 << "s";
-    }
+#include <iomanip>
+#include <memory>
+#include <mutex>
+#include <sstream>
+#include <stdexcept>
 
-    return ss.str();
-}
+namespace {
+    // Names and the slots of every thread that ever recorded, a thread keeps its slots alive while it runs
+    struct Registry {
+        std::mutex mutex;
+        std::vector<std::string> names;
+        std::vector<std::shared_ptr<Timing::ThreadTimers>> threads;
+    };
 
-void Timing::startTM(const std::string &identifier) {
-    if (measureStarts.count(identifier) != 0) {
-        std::cout << "The timer '" << identifier << "' is already running!" << std::endl;
-        abort();
+    // Constructed on first use, timers may be registered from static initializers of other translation units
+    Registry &registry() {
+        static Registry instance;
+        return instance;
     }
 
-    measureStarts.emplace(identifier, std::chrono::high_resolution_clock::now());
-}
-
-void Timing::endTM(const std::string &identifier) {
-    auto end = std::chrono::high_resolution_clock::now();
-    if(measureStarts.count(identifier) == 0) {
-        std::cout << "The timer '" << identifier << "' isn't running!" << std::endl;
-        abort();
+    void clearSlot(Timing::TimerSlot &slot) {
+        slot.count.store(0, std::memory_order_relaxed);
+        slot.ticks.store(0, std::memory_order_relaxed);
+        slot.minTicks.store(UINT64_MAX, std::memory_order_relaxed);
+        slot.maxTicks.store(0, std::memory_order_relaxed);
+        slot.squares.store(0, std::memory_order_relaxed);
     }
 
-    long time = std::chrono::duration_cast<std::chrono::nanoseconds>(end - measureStarts.at(identifier)).count();
-    if (!measurements.count(identifier)) {
-        measurements.emplace(identifier, time);
-        numMeasurements.emplace(identifier, 1);
-        allmeasurements.emplace(identifier, std::vector<uint64_t>());
-        allmeasurements.at(identifier).push_back(time);
-    } else {
-        measurements.at(identifier) += time;
-        numMeasurements.at(identifier)++;
-        allmeasurements.at(identifier).push_back(time);
+    int64_t operationsPerSecond(const Timing::TimerSummary &summary) {
+        return summary.total == 0 ? 0 : static_cast<int64_t>(summary.count / (summary.total / 1E9));
     }
 
-    measureStarts.erase(identifier);
-}
-
-size_t getPadding() {
-    size_t max = 0;
-    for (const auto &current : measurements) {
-        max = std::max(current.first.length(), max);
+    double nanoseconds(double ticks) {
+        // The tick rate is only needed for reports, calibrate once on the first one
+        static bool calibrated = (CycleTimer::calibrate(), true);
+        (void) calibrated;
+        return ticks / CycleTimer::getTicksPerNanosecond();
     }
-
-    return max;
 }
 
-void Timing::printAllTM() {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
+Timing::TimerId Timing::registerTimer(const std::string &name) {
+    Registry &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    auto existing = std::find(instance.names.begin(), instance.names.end(), name);
+    if (existing != instance.names.end()) {
+        return static_cast<TimerId>(existing - instance.names.begin());
     }
-
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### TIMINGS #####" << std::endl;
-
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &entry : measurements) {
-        int64_t newTime = entry.second;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << entry.first << std::right;
-        std::cout <<  " - ";
-        std::cout << fmtTime(newTime);
-        std::cout << std::endl;
+    if (instance.names.size() == TIMING_MAX_TIMERS) {
+        throw std::runtime_error("Cannot register timer " + name + ", all " + std::to_string(TIMING_MAX_TIMERS) +
+                                 " timers are in use.");
     }
+    instance.names.push_back(name);
+    return static_cast<TimerId>(instance.names.size() - 1);
 }
 
-void Timing::printAllTMRelative(const std::string &identifier) {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
-    }
-
-    if (measurements.count(identifier) == 0) {
-        std::cout << "The base timer doesn't exist!" << std::endl;
-        abort();
-    }
-
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### TIMINGS #####" << std::endl;
-    int64_t baseTime = measurements[identifier];
-    std::cout << std::left << std::setfill(' ') << std::setw(padding) << identifier << " - " << std::right;
-    std::cout << fmtTime(baseTime) << std::endl;
+Timing::ThreadTimers &Timing::attachThread() {
+    // Destroyed when the thread exits, the registry then holds the only reference
+    thread_local std::shared_ptr<ThreadTimers> owner;
+    if (!owner) {
+        owner.reset(new ThreadTimers());
+        Registry &instance = registry();
+        std::lock_guard<std::mutex> lock(instance.mutex);
+        instance.threads.push_back(owner);
+    }
+    localTimers = owner.get();
+    return *owner;
+}
 
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &entry : measurements) {
-        if (entry.first == identifier) {
+std::vector<Timing::TimerSummary> Timing::snapshot() {
+    Registry &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+
+    std::vector<TimerSummary> summaries;
+    for (size_t id = 0; id < instance.names.size(); id++) {
+        uint64_t count = 0;
+        uint64_t ticks = 0;
+        uint64_t minTicks = UINT64_MAX;
+        uint64_t maxTicks = 0;
+        double squares = 0;
+        for (const auto &thread : instance.threads) {
+            const TimerSlot &slot = thread->slots[id];
+            count += slot.count.load(std::memory_order_relaxed);
+            ticks += slot.ticks.load(std::memory_order_relaxed);
+            minTicks = std::min(minTicks, slot.minTicks.load(std::memory_order_relaxed));
+            maxTicks = std::max(maxTicks, slot.maxTicks.load(std::memory_order_relaxed));
+            squares += slot.squares.load(std::memory_order_relaxed);
+        }
+        if (count == 0) {
             continue;
         }
 
-        int64_t newTime = entry.second;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << entry.first << std::right;
-        std::cout <<  " - ";
-        std::cout << fmtTime(newTime);
-        std::cout << ", ";
-        std::cout << std::setfill(' ') << std::setw(7) << (double) (newTime - baseTime) / baseTime * 100;
-        std::cout << "%";
-        std::cout << ", factor " << std::setfill(' ') << std::setw(5) << (double) newTime / baseTime << std::endl;
-    }
-}
-
-void Timing::printAllTMAvg() {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
-    }
-
-    if (numMeasurements.size() != measurements.size()) {
-        std::cout << "The number of measurement groups is inconsistent!" << std::endl;
-        abort();
-    }
-
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### TIME PER OPERATION #####" << std::endl;
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &current : measurements) {
-        uint64_t count = numMeasurements.at(current.first);
-        int64_t newAvg = current.second / count;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << current.first << std::right;
-        std::cout <<  " - ";
-        std::cout << fmtTime(newAvg);
-        std::cout << std::endl;
-    }
+        double mean = static_cast<double>(ticks) / count;
+        TimerSummary summary;
+        summary.name = instance.names[id];
+        summary.count = count;
+        summary.total = nanoseconds(ticks);
+        summary.mean = nanoseconds(mean);
+        summary.stddev = nanoseconds(std::sqrt(std::max(0.0, squares / count - mean * mean)));
+        summary.min = nanoseconds(minTicks);
+        summary.max = nanoseconds(maxTicks);
+        summaries.push_back(summary);
+    }
+    return summaries;
 }
 
-void Timing::printAllTMAvgRelative(const std::string &identifier) {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
-    }
-
-    if (numMeasurements.size() != measurements.size()) {
-        std::cout << "The number of measurement groups is inconsistent!" << std::endl;
-        abort();
-    }
-
-    if (measurements.count(identifier) == 0) {
-        std::cout << "The base timer doesn't exist!" << std::endl;
-        abort();
-    }
-
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### TIME PER OPERATION #####" << std::endl;
-    int64_t baseAvg = measurements[identifier] / numMeasurements[identifier];
-    std::cout << std::left << std::setfill(' ') << std::setw(padding) << identifier << " - " << std::right;
-    std::cout << fmtTime(baseAvg) << std::endl;
-
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &current : measurements) {
-        if (current.first == identifier) {
-            continue;
+void Timing::reset() {
+    Registry &instance = registry();
+    std::lock_guard<std::mutex> lock(instance.mutex);
+    instance.threads.erase(std::remove_if(instance.threads.begin(), instance.threads.end(), [](const auto &thread) {
+        return thread.use_count() == 1;
+    }), instance.threads.end());
+    for (const auto &thread : instance.threads) {
+        for (auto &slot : thread->slots) {
+            clearSlot(slot);
         }
-
-        uint64_t count = numMeasurements.at(current.first);
-        int64_t newAvg = current.second / count;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << current.first << std::right;
-        std::cout <<  " - ";
-        std::cout << fmtTime(newAvg);
-        std::cout << ", ";
-        std::cout << std::setfill(' ') << std::setw(7) << (double) (newAvg - baseAvg) / baseAvg * 100;
-        std::cout << "%";
-        std::cout << ", factor " << std::setfill(' ') << std::setw(5) << (double) newAvg / baseAvg << std::endl;
     }
 }
 
-void Timing::printAllTMOPS() {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
-    }
-
-    if (numMeasurements.size() != measurements.size()) {
-        std::cout << "The number of measurement groups is inconsistent!" << std::endl;
-        abort();
-    }
-
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### OPERATIONS PER SECOND #####" << std::endl;
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &current : measurements) {
-        double timeInSecs = current.second / 1E9;
-        int64_t newOPS = numMeasurements.at(current.first) / timeInSecs;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << current.first << std::right;
-        std::cout <<  " - ";
-        std::cout.imbue(std::locale(""));
-        std::cout << std::setfill(' ') << std::setw(13) << newOPS;
-        std::cout << " Operations/s";
-        std::cout << std::endl;
-    }
+std::string Timing::fmtTime(uint64_t time) {
+    return fmtTime(static_cast<double>(time));
 }
 
-void Timing::printAllTMOPSRelative(const std::string &identifier) {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
+std::string Timing::fmtTime(double time) {
+    std::stringstream ss;
+    ss << std::setprecision(3) << std::fixed << std::setfill(' ') << std::setw(11);
+    if (time < 10'000) {
+        ss << time << "ns";
+    } else if (time < 10'000'000) {
+        ss << time / 1E3 << "µs";
+    } else if (time < 10'000'000'000) {
+        ss << time / 1E6 << "ms";
+    } else {
+        ss << time / 1E9 << "s";
     }
 
-    if (numMeasurements.size() != measurements.size()) {
-        std::cout << "The number of measurement groups is inconsistent!" << std::endl;
-        abort();
-    }
+    return ss.str();
+}
 
-    if (measurements.count(identifier) == 0) {
-        std::cout << "The base timer doesn't exist!" << std::endl;
-        abort();
+void Timing::print(std::ostream &os) {
+    std::vector<TimerSummary> summaries = snapshot();
+    size_t padding = 0;
+    for (const auto &summary : summaries) {
+        padding = std::max(summary.name.length(), padding);
     }
 
-    size_t padding = getPadding();
-
-    std::cout << std::endl << "##### OPERATIONS PER SECOND #####" << std::endl;
-    int64_t baseOPS = numMeasurements[identifier] / (measurements[identifier] / 1E9);
-    std::cout << std::left << std::setfill(' ') << std::setw(padding) << identifier << " - " << std::right;
-    std::cout.imbue(std::locale(""));
-    std::cout << std::setfill(' ') << std::setw(13) << baseOPS;
-    std::cout << " Operations/s" << std::endl;
-    std::cout.imbue(std::locale("en_US.UTF8"));
-
-    std::cout << std::setprecision(2) << std::fixed;
-    for (const auto &current : measurements) {
-        if (current.first == identifier) {
-            continue;
-        }
-
-        double timeInSecs = current.second / 1E9;
-        int64_t newOPS = numMeasurements.at(current.first) / timeInSecs;
-        std::cout << std::left << std::setfill(' ') << std::setw(padding) << current.first << std::right;
-        std::cout <<  " - ";
-        std::cout.imbue(std::locale(""));
-        std::cout << std::setfill(' ') << std::setw(13) << newOPS;
-        std::cout << " Operations/s";
-        std::cout.imbue(std::locale("en_US.UTF8"));
-        std::cout << ", ";
-        std::cout << std::setfill(' ') << std::setw(7) << (double) (newOPS - baseOPS) / baseOPS * 100;
-        std::cout << "%";
-        std::cout << ", factor " << std::setfill(' ') << std::setw(5) << (double) newOPS / baseOPS << std::endl;
+    os << std::endl << "##### TIMINGS #####" << std::endl;
+    for (const auto &summary : summaries) {
+        os << std::left << std::setfill(' ') << std::setw(padding) << summary.name << std::right;
+        os << " - " << fmtTime(summary.total);
+        os << ", " << fmtTime(summary.mean) << "/op";
+        os << ", " << std::setw(13) << operationsPerSecond(summary) << " Operations/s";
+        os << std::endl;
     }
 }
 
 void Timing::toCSV(const std::string &name) {
-    if (!measureStarts.empty()) {
-        std::cout << "There is still a timer running: " << measureStarts.begin()->first << std::endl;
-        abort();
-    }
-
-    if (numMeasurements.size() != measurements.size()) {
-        std::cout << "The number of measurement groups is inconsistent!" << std::endl;
-        abort();
-    }
-
-    // Open csv file
-    std::ofstream csv;
-    std::stringstream ss;
-    ss << "benchmark_" << name << ".csv";
-    csv.open(ss.str());
-
-    csv << "name,runtime,time/op,stddev,op/s" << std::endl;
-    for (const auto &current : measurements) {
-        auto v = allmeasurements.at(current.first);
-        allmeasurements.erase(allmeasurements.begin());
-        double sum = std::accumulate(v.begin(), v.end(), 0.0);
-        double mean = sum / v.size();
-
-        std::vector<double> diff(v.size());
-        std::transform(v.begin(), v.end(), diff.begin(), [mean](double x) { return x - mean; });
-        double sq_sum = std::inner_product(diff.begin(), diff.end(), diff.begin(), 0.0);
-        double stdev = std::sqrt(sq_sum / v.size());
-
-        csv << std::fixed << current.first << "," << current.second << "," << mean << "," << stdev
-            << "," << static_cast<int64_t>(numMeasurements.at(current.first) / (current.second / 1E9)) << std::endl;
+    std::ofstream csv("benchmark_" + name + ".csv");
+    csv << "name,runtime,time/op,stddev,op/s,count,min,max" << std::endl;
+    for (const auto &summary : snapshot()) {
+        csv << std::fixed << summary.name << "," << summary.total << "," << summary.mean << "," << summary.stddev
+            << "," << operationsPerSecond(summary) << "," << summary.count << ","
+            << summary.min << "," << summary.max << std::endl;
     }
+}
 
-    csv.close();
-}
\ No newline at end of file
+void Timing::toJSON(const std::string &name) {
+    std::ofstream json("benchmark_" + name + ".json");
+    std::vector<TimerSummary> summaries = snapshot();
+    json << "[" << std::endl;
+    for (size_t i = 0; i < summaries.size(); i++) {
+        const TimerSummary &summary = summaries[i];
+        json << std::fixed << "  {\"name\": \"" << summary.name << "\", \"count\": " << summary.count
+             << ", \"total_ns\": " << summary.total << ", \"mean_ns\": " << summary.mean
+             << ", \"stddev_ns\": " << summary.stddev << ", \"min_ns\": " << summary.min
+             << ", \"max_ns\": " << summary.max << "}" << (i + 1 < summaries.size() ? "," : "") << std::endl;
+    }
+    json << "]" << std::endl;
+}
@@ -0,0 +1,151 @@
+#include <cstring>
+#include <fstream>
+#include <map>
+#include <stdexcept>
+
+#include "TraceFile.h"
+#include "MappedFile.h"
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+void TraceFile::write(const std::string &path, const PacketBatch &batch, bool withStacks) {
+    // Build the dictionary of distinct protocol stacks
+    std::vector<uint32_t> stackOffsets{0};
+    std::vector<identifier_t> stackIdentifiers;
+    std::vector<uint32_t> packetStacks;
+    if (withStacks) {
+        std::map<std::vector<identifier_t>, uint32_t> stacks;
+        packetStacks.reserve(batch.size());
+        for (const auto &packet : batch) {
+            std::vector<identifier_t> stack(packet.getIdentifiers().begin(), packet.getIdentifiers().end());
+            auto result = stacks.emplace(std::move(stack), stacks.size());
+            if (result.second) {
+                stackIdentifiers.insert(stackIdentifiers.end(), result.first->first.begin(), result.first->first.end());
+                stackOffsets.push_back(stackIdentifiers.size());
+            }
+            packetStacks.push_back(result.first->second);
+        }
+    }
+
+    TraceFileHeader header{};
+    memcpy(header.magic, TRACE_FILE_MAGIC, TRACE_FILE_MAGIC_SIZE);
+    header.version = TRACE_FILE_VERSION;
+    header.identifierSize = sizeof(identifier_t);
+    header.flags = withStacks ? TRACE_FILE_FLAG_STACKS : 0;
+    header.packetCount = batch.size();
+    header.identifierCount = batch.identifierCount();
+    header.payloadSize = batch.payloadSize();
+    header.stackCount = stackOffsets.size() - 1;
+    header.stackIdentifierCount = stackIdentifiers.size();
+
+    header.identifierOffsetsPosition = align(sizeof(TraceFileHeader));
+    header.payloadOffsetsPosition = align(header.identifierOffsetsPosition + (header.packetCount + 1) * sizeof(uint32_t));
+    header.identifiersPosition = align(header.payloadOffsetsPosition + (header.packetCount + 1) * sizeof(uint64_t));
+    header.payloadsPosition = align(header.identifiersPosition + header.identifierCount * sizeof(identifier_t));
+    uint64_t end = header.payloadsPosition + header.payloadSize;
+    if (withStacks) {
+        header.stackOffsetsPosition = align(end);
+        header.stackIdentifiersPosition = align(header.stackOffsetsPosition + (header.stackCount + 1) * sizeof(uint32_t));
+        header.packetStacksPosition = align(header.stackIdentifiersPosition + header.stackIdentifierCount * sizeof(identifier_t));
+    }
+
+    std::ofstream file(path, std::ofstream::out | std::ofstream::binary | std::ofstream::trunc);
+    if (!file.is_open()) {
+        throw std::invalid_argument("Could not open " + path + " for writing.");
+    }
+
+    auto writeSection = [&file](uint64_t position, const void *data, size_t length) {
+        static const char padding[TRACE_FILE_ALIGNMENT] = {};
+        file.write(padding, position - file.tellp());
+        file.write(static_cast<const char *>(data), length);
+    };
+
+    file.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    writeSection(header.identifierOffsetsPosition, batch.columns.identifierOffsets, (header.packetCount + 1) * sizeof(uint32_t));
+    writeSection(header.payloadOffsetsPosition, batch.columns.payloadOffsets, (header.packetCount + 1) * sizeof(uint64_t));
+    writeSection(header.identifiersPosition, batch.columns.identifiers, header.identifierCount * sizeof(identifier_t));
+    writeSection(header.payloadsPosition, batch.columns.payloads, header.payloadSize);
+    if (withStacks) {
+        writeSection(header.stackOffsetsPosition, stackOffsets.data(), stackOffsets.size() * sizeof(uint32_t));
+        writeSection(header.stackIdentifiersPosition, stackIdentifiers.data(), stackIdentifiers.size() * sizeof(identifier_t));
+        writeSection(header.packetStacksPosition, packetStacks.data(), packetStacks.size() * sizeof(uint32_t));
+    }
+
+    if (!file) {
+        throw std::runtime_error("Error while writing " + path + ".");
+    }
+}
+
+PacketBatch TraceFile::read(const std::string &path) {
+    auto mapping = std::make_shared<const MappedFile>(path);
+    if (mapping->size() < sizeof(TraceFileHeader)) {
+        throw std::invalid_argument("Trace file is too small for a header.");
+    }
+
+    TraceFileHeader header{};
+    memcpy(&header, mapping->data(), sizeof(header));
+    if (memcmp(header.magic, TRACE_FILE_MAGIC, TRACE_FILE_MAGIC_SIZE) != 0) {
+        throw std::invalid_argument("Not a binary trace file.");
+    } else if (header.version != TRACE_FILE_VERSION) {
+        throw std::invalid_argument("Unsupported trace file version " + std::to_string(header.version) + ".");
+    } else if (header.identifierSize != sizeof(identifier_t)) {
+        throw std::invalid_argument("Trace file was written with " + std::to_string(header.identifierSize) + " byte identifiers.");
+    }
+
+    uint64_t fileSize = mapping->size();
+    checkSection(header.identifierOffsetsPosition, (header.packetCount + 1) * sizeof(uint32_t), fileSize, "identifier offsets");
+    checkSection(header.payloadOffsetsPosition, (header.packetCount + 1) * sizeof(uint64_t), fileSize, "payload offsets");
+    checkSection(header.identifiersPosition, header.identifierCount * sizeof(identifier_t), fileSize, "identifiers");
+    checkSection(header.payloadsPosition, header.payloadSize, fileSize, "payloads");
+
+    const uint8_t *data = mapping->data();
+    PacketBatch::Columns columns{
+            reinterpret_cast<const uint32_t *>(data + header.identifierOffsetsPosition),
+            reinterpret_cast<const uint64_t *>(data + header.payloadOffsetsPosition),
+            reinterpret_cast<const identifier_t *>(data + header.identifiersPosition),
+            data + header.payloadsPosition,
+            nullptr,
+            nullptr,
+            nullptr
+    };
+
+    // Only the final offsets are checked, checking all of them would touch every page of the offset columns
+    if (columns.identifierOffsets[header.packetCount] != header.identifierCount ||
+        columns.payloadOffsets[header.packetCount] != header.payloadSize) {
+        throw std::invalid_argument("Trace file offsets do not match the header.");
+    }
+
+    size_t stackCount = 0;
+    if (header.flags & TRACE_FILE_FLAG_STACKS) {
+        checkSection(header.stackOffsetsPosition, (header.stackCount + 1) * sizeof(uint32_t), fileSize, "stack offsets");
+        checkSection(header.stackIdentifiersPosition, header.stackIdentifierCount * sizeof(identifier_t), fileSize, "stack identifiers");
+        checkSection(header.packetStacksPosition, header.packetCount * sizeof(uint32_t), fileSize, "packet stacks");
+        columns.stackOffsets = reinterpret_cast<const uint32_t *>(data + header.stackOffsetsPosition);
+        columns.stackIdentifiers = reinterpret_cast<const identifier_t *>(data + header.stackIdentifiersPosition);
+        columns.packetStacks = reinterpret_cast<const uint32_t *>(data + header.packetStacksPosition);
+        stackCount = header.stackCount;
+    }
+
+    return PacketBatch(std::move(mapping), columns, header.packetCount, stackCount);
+}
+
+bool TraceFile::isTraceFile(const std::string &path) {
+    std::ifstream file(path, std::ifstream::in | std::ifstream::binary);
+    char magic[TRACE_FILE_MAGIC_SIZE];
+    return file.read(magic, TRACE_FILE_MAGIC_SIZE) && memcmp(magic, TRACE_FILE_MAGIC, TRACE_FILE_MAGIC_SIZE) == 0;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+uint64_t TraceFile::align(uint64_t position) {
+    return (position + TRACE_FILE_ALIGNMENT - 1) / TRACE_FILE_ALIGNMENT * TRACE_FILE_ALIGNMENT;
+}
+
+void TraceFile::checkSection(uint64_t position, uint64_t length, uint64_t fileSize, const std::string &name) {
+    if (position % TRACE_FILE_ALIGNMENT != 0 || position > fileSize || length > fileSize - position) {
+        throw std::invalid_argument("Trace file section " + name + " is out of bounds.");
+    }
+}
@@ -0,0 +1,351 @@
+#include <algorithm>
+#include <cmath>
+#include <numeric>
+#include <stdexcept>
+
+#include "TraceGenerator.h"
+#include "InputReader.h"
+
+// Same payload as the traces of gen_packet.py, which all end with "A"
+#define TRACE_GENERATOR_PAYLOAD_BYTE 0x0A
+
+static inline uint64_t rotateLeft(uint64_t value, int shift) {
+    return (value << shift) | (value >> (64 - shift));
+}
+
+// Values may be given in decimal or, prefixed with 0x, in hex
+static uint64_t parseUnsigned(const std::string &key, const std::string &value) {
+    try {
+        return std::stoull(value, nullptr, 0);
+    } catch (std::logic_error &e) {
+        throw std::invalid_argument("Invalid value " + value + " of option " + key + " in trace description.");
+    }
+}
+
+static double parseDouble(const std::string &key, const std::string &value) {
+    try {
+        return std::stod(value);
+    } catch (std::logic_error &e) {
+        throw std::invalid_argument("Invalid value " + value + " of option " + key + " in trace description.");
+    }
+}
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+TraceGeneratorConfig TraceGeneratorConfig::parse(const std::string &description) {
+    TraceGeneratorConfig config;
+
+    size_t colon = description.find(':');
+    std::string model = description.substr(0, colon);
+    if (model == "uniform") {
+        config.model = TraceModel::UNIFORM;
+    } else if (model == "zipf") {
+        config.model = TraceModel::ZIPF;
+    } else if (model == "markov") {
+        config.model = TraceModel::MARKOV;
+    } else {
+        throw std::invalid_argument("Invalid trace model " + model + " (expected uniform, zipf or markov).");
+    }
+
+    size_t position = colon == std::string::npos ? description.size() : colon + 1;
+    while (position < description.size()) {
+        size_t end = std::min(description.find(',', position), description.size());
+        std::string option = description.substr(position, end - position);
+        position = end + 1;
+
+        size_t equals = option.find('=');
+        if (equals == std::string::npos) {
+            throw std::invalid_argument("Invalid option " + option + " in trace description (expected <key>=<value>).");
+        }
+        std::string key = option.substr(0, equals);
+        std::string value = option.substr(equals + 1);
+
+        if (key == "pdus") {
+            config.pduCount = parseUnsigned(key, value);
+        } else if (key == "layers") {
+            config.layerCount = parseUnsigned(key, value);
+        } else if (key == "ids") {
+            config.identifierCount = parseUnsigned(key, value);
+        } else if (key == "max") {
+            config.maxIdentifier = parseUnsigned(key, value);
+        } else if (key == "from") {
+            config.analyzerFile = value;
+        } else if (key == "hits") {
+            config.hitRatio = parseDouble(key, value);
+        } else if (key == "s") {
+            config.exponent = parseDouble(key, value);
+        } else if (key == "learn") {
+            config.learnFile = value;
+        } else if (key == "burst") {
+            config.burstLength = parseDouble(key, value);
+        } else if (key == "locality") {
+            config.locality = parseDouble(key, value);
+        } else if (key == "window") {
+            config.window = parseUnsigned(key, value);
+        } else if (key == "payload") {
+            config.payloadSize = parseUnsigned(key, value);
+        } else if (key == "flows") {
+            config.flowCount = parseUnsigned(key, value);
+        } else if (key == "elephants") {
+            config.elephantCount = parseUnsigned(key, value);
+        } else if (key == "share") {
+            config.elephantShare = parseDouble(key, value);
+        } else if (key == "seed") {
+            config.seed = parseUnsigned(key, value);
+        } else {
+            throw std::invalid_argument("Unknown option " + key + " in trace description.");
+        }
+    }
+
+    if (config.model == TraceModel::MARKOV && config.learnFile.empty()) {
+        throw std::invalid_argument("The markov model needs a packet file to learn from (learn=<file>).");
+    } else if (config.layerCount == 0 || config.identifierCount == 0 || config.window == 0) {
+        throw std::invalid_argument("layers, ids and window have to be positive.");
+    } else if (config.maxIdentifier > (size_t(1) << sizeof(identifier_t) * 8) || config.identifierCount > config.maxIdentifier) {
+        throw std::invalid_argument("Identifiers have to fit into identifier_t and ids must not exceed max.");
+    } else if (config.exponent < 0 || config.burstLength < 1 || config.locality < 0 || config.locality > 1 ||
+               config.hitRatio < 0 || config.hitRatio > 1) {
+        throw std::invalid_argument("s must not be negative, burst must be at least 1, locality and hits probabilities.");
+    } else if (config.elephantCount > config.flowCount || config.flowCount > (size_t(1) << 32u) ||
+               config.elephantShare < 0 || config.elephantShare > 1) {
+        throw std::invalid_argument("elephants must not exceed flows, flows must fit into 32 bits and share has to be a probability.");
+    }
+    return config;
+}
+
+TraceGenerator::TraceGenerator(const TraceGeneratorConfig &config) : config(config), state{} {
+    // Seed xoshiro256** with splitmix64 as recommended by its authors
+    uint64_t seed = config.seed;
+    for (uint64_t &word : state) {
+        seed += 0x9e3779b97f4a7c15ull;
+        uint64_t z = seed;
+        z = (z ^ (z >> 30u)) * 0xbf58476d1ce4e5b9ull;
+        z = (z ^ (z >> 27u)) * 0x94d049bb133111ebull;
+        word = z ^ (z >> 31u);
+    }
+
+    if (config.model == TraceModel::MARKOV) {
+        learn(InputReader::readPacketFile(config.learnFile));
+    } else {
+        selectIdentifiers();
+    }
+}
+
+PacketBatch TraceGenerator::generate(std::vector<uint32_t> *flows) {
+    PacketBatch packets;
+    if (config.model != TraceModel::MARKOV) {
+        size_t packetCount = (config.pduCount + config.layerCount - 1) / config.layerCount;
+        packets.reserve(packetCount, packetCount * config.layerCount, packetCount * config.payloadSize);
+    }
+
+    std::vector<uint8_t> payload(config.payloadSize, TRACE_GENERATOR_PAYLOAD_BYTE);
+    std::vector<identifier_t> stack;
+
+    // Stacks of the last bursts, reused with the configured locality
+    std::vector<std::vector<identifier_t>> recentStacks(config.window);
+    size_t recentCount = 0;
+    size_t recentNext = 0;
+
+    // Stack of every flow, empty until its first burst
+    std::vector<std::vector<identifier_t>> flowStacks(config.flowCount);
+    uint32_t flow = 0;
+    if (flows != nullptr) {
+        flows->clear();
+    }
+
+    // Burst lengths are geometrically distributed with the configured mean
+    double continueProbability = 1.0 - 1.0 / config.burstLength;
+
+    size_t pduCount = 0;
+    while (pduCount < config.pduCount) {
+        if (pduCount == 0 || nextDouble() >= continueProbability) {
+            if (config.flowCount > 0) {
+                flow = drawFlow();
+            }
+
+            if (config.flowCount > 0 && !flowStacks[flow].empty()) {
+                stack = flowStacks[flow];
+            } else {
+                if (recentCount > 0 && nextDouble() < config.locality) {
+                    stack = recentStacks[nextBelow(recentCount)];
+                } else {
+                    drawStack(stack);
+                }
+
+                recentStacks[recentNext] = stack;
+                recentNext = (recentNext + 1) % config.window;
+                recentCount = std::min(recentCount + 1, config.window);
+                if (config.flowCount > 0) {
+                    flowStacks[flow] = stack;
+                }
+            }
+        }
+
+        // Without flows, every packet is a flow of its own, numbered like the packets
+        if (flows != nullptr) {
+            flows->push_back(config.flowCount > 0 ? flow : static_cast<uint32_t>(packets.size() + 1));
+        }
+        packets.add(stack.data(), stack.size(), payload.data(), payload.size());
+        pduCount += stack.size();
+    }
+
+    packets.shrinkToFit();
+    return packets;
+}
+
+void TraceGenerator::learn(const PacketBatch &packets) {
+    std::map<MarkovState, std::map<int32_t, uint64_t>> counts;
+    for (const auto &packet : packets) {
+        const ArrayView<identifier_t> &stack = packet.getIdentifiers();
+        if (stack.empty()) {
+            continue;
+        }
+
+        MarkovState previous(0, MARKOV_START);
+        for (size_t depth = 0; depth < stack.size() && depth < TRACE_GENERATOR_MAX_DEPTH; depth++) {
+            counts[previous][stack[depth]]++;
+            previous = MarkovState(depth + 1, stack[depth]);
+        }
+        counts[previous][MARKOV_END]++;
+    }
+
+    if (counts.empty()) {
+        throw std::invalid_argument("The packet file to learn from contains no packets.");
+    }
+
+    transitions.clear();
+    for (const auto &state : counts) {
+        Transitions &target = transitions[state.first];
+        uint64_t total = 0;
+        for (const auto &successor : state.second) {
+            total += successor.second;
+            target.next.push_back(successor.first);
+            target.cumulativeCounts.push_back(total);
+        }
+    }
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+void TraceGenerator::selectIdentifiers() {
+    identifiers.clear();
+    if (!config.fromIdentifiers.empty()) {
+        identifiers = config.fromIdentifiers;
+    } else if (!config.analyzerFile.empty()) {
+        for (const auto &entry : InputReader::readAnalyzerFile(config.analyzerFile)) {
+            identifiers.push_back(entry.first);
+        }
+        if (identifiers.empty()) {
+            throw std::invalid_argument("Analyzer file " + config.analyzerFile + " contains no identifiers.");
+        }
+    } else {
+        // Partial Fisher-Yates shuffle of the identifier space
+        std::vector<identifier_t> space(config.maxIdentifier);
+        std::iota(space.begin(), space.end(), 0);
+        for (size_t i = 0; i < config.identifierCount; i++) {
+            std::swap(space[i], space[i + nextBelow(space.size() - i)]);
+        }
+        identifiers.assign(space.begin(), space.begin() + config.identifierCount);
+    }
+
+    // Ranks are assigned randomly, so the popularity of an identifier does not depend on its value
+    for (size_t i = identifiers.size() - 1; i > 0; i--) {
+        std::swap(identifiers[i], identifiers[nextBelow(i + 1)]);
+    }
+
+    missIdentifiers.clear();
+    if (config.hitRatio < 1) {
+        std::vector<bool> selected(config.maxIdentifier, false);
+        for (const auto &identifier : identifiers) {
+            if (identifier < config.maxIdentifier) {
+                selected[identifier] = true;
+            }
+        }
+        for (size_t identifier = 0; identifier < config.maxIdentifier; identifier++) {
+            if (!selected[identifier]) {
+                missIdentifiers.push_back(static_cast<identifier_t>(identifier));
+            }
+        }
+        if (missIdentifiers.empty()) {
+            throw std::invalid_argument("The identifiers cover [0, max), there are none left to miss with hits < 1.");
+        }
+    }
+
+    double exponent = config.model == TraceModel::UNIFORM ? 0.0 : config.exponent;
+    cumulativeProbabilities.resize(identifiers.size());
+    double total = 0;
+    for (size_t rank = 0; rank < identifiers.size(); rank++) {
+        total += 1.0 / std::pow(rank + 1, exponent);
+        cumulativeProbabilities[rank] = total;
+    }
+    for (auto &probability : cumulativeProbabilities) {
+        probability /= total;
+    }
+}
+
+void TraceGenerator::drawStack(std::vector<identifier_t> &stack) {
+    stack.clear();
+    if (config.model != TraceModel::MARKOV) {
+        for (size_t i = 0; i < config.layerCount; i++) {
+            if (!missIdentifiers.empty() && nextDouble() >= config.hitRatio) {
+                stack.push_back(missIdentifiers[nextBelow(missIdentifiers.size())]);
+                continue;
+            }
+            auto rank = std::upper_bound(cumulativeProbabilities.begin(), cumulativeProbabilities.end(), nextDouble());
+            stack.push_back(identifiers[std::min<size_t>(rank - cumulativeProbabilities.begin(), identifiers.size() - 1)]);
+        }
+        return;
+    }
+
+    // Every state that was reached while learning has successors, the learned stacks end at the maximum depth
+    MarkovState current(0, MARKOV_START);
+    while (true) {
+        const Transitions &successors = transitions.at(current);
+        uint64_t value = nextBelow(successors.cumulativeCounts.back());
+        auto position = std::upper_bound(successors.cumulativeCounts.begin(), successors.cumulativeCounts.end(), value);
+        int32_t next = successors.next[position - successors.cumulativeCounts.begin()];
+        if (next == MARKOV_END) {
+            break;
+        }
+        stack.push_back(static_cast<identifier_t>(next));
+        current = MarkovState(stack.size(), next);
+    }
+}
+
+// Heavy hitters are drawn with the configured share, the other flows uniformly
+uint32_t TraceGenerator::drawFlow() {
+    if (config.elephantCount > 0 && (config.elephantCount == config.flowCount || nextDouble() < config.elephantShare)) {
+        return nextBelow(config.elephantCount);
+    }
+    return config.elephantCount + nextBelow(config.flowCount - config.elephantCount);
+}
+
+uint64_t TraceGenerator::nextRandom() {
+    uint64_t result = rotateLeft(state[1] * 5, 7) * 9;
+    uint64_t shifted = state[1] << 17u;
+    state[2] ^= state[0];
+    state[3] ^= state[1];
+    state[1] ^= state[2];
+    state[0] ^= state[3];
+    state[2] ^= shifted;
+    state[3] = rotateLeft(state[3], 45);
+    return result;
+}
+
+// Uniform in [0, 1) with 53 random bits
+double TraceGenerator::nextDouble() {
+    return static_cast<double>(nextRandom() >> 11u) * 0x1.0p-53;
+}
+
+// Uniform in [0, bound) without modulo bias
+uint64_t TraceGenerator::nextBelow(uint64_t bound) {
+    uint64_t threshold = -bound % bound;
+    uint64_t value;
+    do {
+        value = nextRandom();
+    } while (value < threshold);
+    return value % bound;
+}
@@ -0,0 +1,184 @@
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <stdexcept>
+
+#include "TraceStream.h"
+#include "InputReader.h"
+#include "MappedFile.h"
+#include "PcapReader.h"
+#include "TextTraceParser.h"
+#include "TraceFile.h"
+
+static uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+TraceStream::TraceStream(const std::string &path, size_t chunkSize) : chunkSize(std::max<size_t>(1, chunkSize)) {
+    switch (InputReader::getFileType(path)) {
+        case CUSTOM_PACKET_FORMAT: {
+            source = Source::TEXT;
+            textFile = std::make_unique<MappedFile>(path);
+
+            // Skip first line with the marker
+            const char *data = reinterpret_cast<const char *>(textFile->data());
+            const char *marker = static_cast<const char *>(memchr(data, '\n', textFile->size()));
+            textPosition = marker == nullptr ? textFile->size() : marker - data + 1;
+            break;
+        }
+        case BINARY_TRACE: {
+            source = Source::BINARY;
+            binaryTrace = TraceFile::read(path);
+            break;
+        }
+        case PCAP: {
+            source = Source::PCAP;
+            pcapReader = std::make_unique<PcapReader>(path);
+            break;
+        }
+        default: {
+            throw std::invalid_argument("Not a valid packet file type.");
+        }
+    }
+
+    reader = std::thread(&TraceStream::read, this);
+}
+
+TraceStream::~TraceStream() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopped = true;
+    }
+    changed.notify_all();
+    reader.join();
+}
+
+const PacketBatch *TraceStream::next() {
+    auto start = std::chrono::steady_clock::now();
+    std::unique_lock<std::mutex> lock(mutex);
+
+    // Hand the previous chunk back to the reader
+    if (started) {
+        buffers[current].ready = false;
+        changed.notify_all();
+    }
+    started = true;
+
+    current ^= 1u;
+    changed.wait(lock, [this] { return buffers[current].ready || finished; });
+    waitTime = nanosecondsSince(start);
+
+    // The reader fills the buffers in order, so a ready buffer always precedes the end or an error
+    if (buffers[current].ready) {
+        return &buffers[current].packets;
+    } else if (error) {
+        std::rethrow_exception(error);
+    }
+    return nullptr;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+void TraceStream::read() {
+    try {
+        for (size_t index = 0;; index ^= 1u) {
+            Buffer &buffer = buffers[index];
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                changed.wait(lock, [this, &buffer] { return !buffer.ready || stopped; });
+                if (stopped) {
+                    return;
+                }
+            }
+
+            // The buffer is not ready, so next() does not touch it
+            auto start = std::chrono::steady_clock::now();
+            buffer.packets.clear();
+            fill(buffer.packets);
+            buffer.readTime = nanosecondsSince(start);
+
+            bool exhausted = buffer.packets.empty();
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                buffer.ready = !exhausted;
+                finished = exhausted;
+            }
+            changed.notify_all();
+            if (exhausted) {
+                return;
+            }
+        }
+    } catch (...) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            error = std::current_exception();
+            finished = true;
+        }
+        changed.notify_all();
+    }
+}
+
+void TraceStream::fill(PacketBatch &packets) {
+    switch (source) {
+        case Source::TEXT:
+            fillText(packets);
+            break;
+        case Source::BINARY:
+            fillBinary(packets);
+            break;
+        case Source::PCAP:
+            fillPcap(packets);
+            break;
+    }
+}
+
+void TraceStream::fillText(PacketBatch &packets) {
+    const char *data = reinterpret_cast<const char *>(textFile->data());
+    const char *end = data + textFile->size();
+
+    std::string message;
+    while (packets.size() < chunkSize && textPosition < textFile->size()) {
+        const char *line = data + textPosition;
+        const char *lineEnd = static_cast<const char *>(memchr(line, '\n', end - line));
+        if (lineEnd == nullptr) {
+            lineEnd = end;
+        }
+        lineNumber++;
+
+        if (!TextTraceParser::parseLine(line, lineEnd, fields, identifiers, payload, message)) {
+            throw std::invalid_argument("Line " + std::to_string(lineNumber) + message);
+        }
+        packets.add(identifiers.data(), identifiers.size(), payload.data(), payload.size());
+
+        textPosition = std::min<size_t>(lineEnd - data + 1, textFile->size());
+    }
+
+    textFile->release(textReleased, textPosition - textReleased);
+    textReleased = textPosition;
+}
+
+void TraceStream::fillBinary(PacketBatch &packets) {
+    size_t end = std::min(binaryPosition + chunkSize, binaryTrace.size());
+    for (size_t i = binaryPosition; i < end; i++) {
+        PacketView packet = binaryTrace[i];
+        packets.add(packet.getIdentifiers().data(), packet.getIdentifiers().size(),
+                    packet.getPayload().data(), packet.getPayload().size());
+    }
+
+    binaryTrace.release(binaryPosition, end);
+    binaryPosition = end;
+}
+
+void TraceStream::fillPcap(PacketBatch &packets) {
+    PcapRecord record{};
+    while (packets.size() < chunkSize && pcapReader->next(record)) {
+        InputReader::addPcapRecord(packets, record, identifiers);
+    }
+
+    pcapReader->release();
+}
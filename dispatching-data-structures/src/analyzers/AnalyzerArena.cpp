@@ -0,0 +1,142 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include "analyzers/AnalyzerArena.h"
+
+// Address ranges of all blocks of all arenas. Only needed to decide ownership when dispatchers free their analyzers.
+// Never destroyed on purpose, dispatchers in static storage (e.g. registered benchmarks) may still ask at exit.
+static std::vector<std::pair<const uint8_t*, const uint8_t*>> &arenaRanges() {
+    static auto *ranges = new std::vector<std::pair<const uint8_t*, const uint8_t*>>();
+    return *ranges;
+}
+
+AnalyzerArena::~AnalyzerArena() {
+    clear();
+
+    auto &ranges = arenaRanges();
+    for (auto &pool : pools) {
+        for (auto &block : pool.blocks) {
+            ranges.erase(std::remove_if(ranges.begin(), ranges.end(), [&block](const auto &range) {
+                return range.first == block.data;
+            }), ranges.end());
+            std::free(block.data);
+        }
+    }
+}
+
+void AnalyzerArena::clear() {
+    for (auto &pool : pools) {
+        for (auto &block : pool.blocks) {
+            // Destroy in reverse order of construction
+            for (size_t i = block.used; i > 0; i--) {
+                pool.destroy(block.data + (i - 1) * pool.stride);
+            }
+            block.used = 0;
+        }
+        pool.current = 0;
+    }
+}
+
+size_t AnalyzerArena::size() const {
+    size_t result = 0;
+    for (const auto &pool : pools) {
+        for (const auto &block : pool.blocks) {
+            result += block.used;
+        }
+    }
+    return result;
+}
+
+size_t AnalyzerArena::bytes() const {
+    size_t result = 0;
+    for (const auto &pool : pools) {
+        for (const auto &block : pool.blocks) {
+            result += block.capacity * pool.stride;
+        }
+    }
+    return result;
+}
+
+bool AnalyzerArena::owns(const IAnalyzer *analyzer) {
+    const auto *address = reinterpret_cast<const uint8_t*>(analyzer);
+    for (const auto &range : arenaRanges()) {
+        if (range.first <= address && address < range.second) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// #######################
+// ####### PRIVATE #######
+// #######################
+
+AnalyzerArena::Pool &AnalyzerArena::getPool(const std::type_info &type, size_t size, size_t alignment,
+                                            void (*destroy)(void *object)) {
+    for (auto &pool : pools) {
+        if (pool.type == type) {
+            return pool;
+        }
+    }
+
+    if (alignment > CACHE_LINE_SIZE) {
+        throw std::invalid_argument("Analyzer alignment exceeds the cache line size.");
+    }
+
+    // Objects are packed back to back, the stride only has to respect the alignment of the type
+    size_t stride = (size + alignment - 1) / alignment * alignment;
+    pools.push_back(Pool{std::type_index(type), stride, destroy, {}, 0});
+    return pools.back();
+}
+
+void *AnalyzerArena::allocate(Pool &pool) {
+    // Skip full blocks
+    while (pool.current < pool.blocks.size() && pool.blocks[pool.current].used == pool.blocks[pool.current].capacity) {
+        pool.current++;
+    }
+
+    if (pool.current == pool.blocks.size()) {
+        addBlock(pool, std::max<size_t>(1, blockSize / pool.stride));
+    }
+
+    Block &block = pool.blocks[pool.current];
+    return block.data + (block.used++) * pool.stride;
+}
+
+void AnalyzerArena::reserve(Pool &pool, size_t count) {
+    if (pool.current < pool.blocks.size()) {
+        const Block &block = pool.blocks[pool.current];
+        if (block.capacity - block.used >= count) {
+            return;
+        }
+
+        // The rest of a started block is given up, all blocks behind it are still unused
+        if (block.used > 0) {
+            pool.current++;
+        }
+    }
+
+    // Continue in an unused block that is large enough or allocate a new one
+    for (size_t i = pool.current; i < pool.blocks.size(); i++) {
+        if (pool.blocks[i].capacity >= count) {
+            std::swap(pool.blocks[pool.current], pool.blocks[i]);
+            return;
+        }
+    }
+
+    addBlock(pool, count);
+    std::swap(pool.blocks[pool.current], pool.blocks.back());
+}
+
+void AnalyzerArena::addBlock(Pool &pool, size_t capacity) {
+    // Round up to full cache lines, aligned_alloc requires a multiple of the alignment
+    size_t bytes = (capacity * pool.stride + CACHE_LINE_SIZE - 1) / CACHE_LINE_SIZE * CACHE_LINE_SIZE;
+    auto *data = static_cast<uint8_t*>(std::aligned_alloc(CACHE_LINE_SIZE, bytes));
+    if (data == nullptr) {
+        throw std::bad_alloc();
+    }
+
+    pool.blocks.push_back(Block{data, capacity, 0});
+    arenaRanges().emplace_back(data, data + bytes);
+}
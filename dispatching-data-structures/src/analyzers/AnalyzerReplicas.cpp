@@ -0,0 +1,64 @@
+#include <algorithm>
+
+#include "analyzers/AnalyzerReplicas.h"
+#include "analyzers/All.h"
+#include "dispatchers/IDispatcher.h"
+
+#define CREATE_ANALYZER(analyzer, arena) ((arena) == nullptr ? new analyzer : (arena)->create<analyzer>())
+
+// ********************
+// ****** PUBLIC ******
+// ********************
+AnalyzerReplicas::AnalyzerReplicas(IDispatcher &dispatcher,
+                                   const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+                                   size_t workerCount) {
+    // Several identifiers may map to the same analyzer, it is only replicated once
+    for (const auto &builder : analyzerBuilders) {
+        IAnalyzer *analyzer = dispatcher.lookup(builder.first);
+        if (analyzer != nullptr && std::find(prototypes.begin(), prototypes.end(), analyzer) == prototypes.end()) {
+            analyzer->replicaIndex = prototypes.size();
+            prototypes.push_back(analyzer);
+        }
+    }
+
+    for (size_t i = 0; i < workerCount; i++) {
+        workers.push_back(std::make_unique<Worker>());
+        Worker &worker = *workers.back();
+        for (const auto &prototype : prototypes) {
+            worker.analyzers.push_back(create(prototype->getKind(), &worker.arena));
+        }
+    }
+}
+
+std::vector<std::unique_ptr<IAnalyzer>> AnalyzerReplicas::snapshot() const {
+    std::vector<std::unique_ptr<IAnalyzer>> result;
+    for (size_t i = 0; i < prototypes.size(); i++) {
+        result.emplace_back(create(prototypes[i]->getKind(), nullptr));
+        for (const auto &worker : workers) {
+            result.back()->merge(*worker->analyzers[i]);
+        }
+    }
+    return result;
+}
+
+
+// ********************
+// ***** PRIVATE ******
+// ********************
+IAnalyzer *AnalyzerReplicas::create(AnalyzerKind kind, AnalyzerArena *arena) {
+    switch (kind) {
+        case AnalyzerKind::ETH:
+            return CREATE_ANALYZER(ETHAnalyzer, arena);
+        case AnalyzerKind::IPV4:
+            return CREATE_ANALYZER(IPv4Analyzer, arena);
+        case AnalyzerKind::IPV6:
+            return CREATE_ANALYZER(IPv6Analyzer, arena);
+        case AnalyzerKind::TCP:
+            return CREATE_ANALYZER(TCPAnalyzer, arena);
+        case AnalyzerKind::UDP:
+            return CREATE_ANALYZER(UDPAnalyzer, arena);
+        case AnalyzerKind::UNKNOWN:
+            break;
+    }
+    return CREATE_ANALYZER(UnknownAnalyzer, arena);
+}
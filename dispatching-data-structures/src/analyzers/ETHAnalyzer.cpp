@@ -1,9 +1,38 @@
 #include "analyzers/ETHAnalyzer.h"
+#include "ProtocolHeaders.h"
 
-void ETHAnalyzer::analyze(const MyPacket &packet) {
-    counter++;
+void ETHAnalyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult ETHAnalyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    counter.increment();
+    if (!fits(frame, offset, ETHERNET_HEADER_SIZE)) {
+        return ParseResult::end();
+    }
+
+    uint16_t ethertype = loadBigEndian16(frame.data() + offset + 12);
+    offset += ETHERNET_HEADER_SIZE;
+
+    // VLAN tags have no analyzer of their own, the next layer is the one behind them
+    while ((ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ) && fits(frame, offset, VLAN_HEADER_SIZE)) {
+        ethertype = loadBigEndian16(frame.data() + offset + 2);
+        offset += VLAN_HEADER_SIZE;
+    }
+
+    // Smaller values are the length of an 802.3 frame
+    if (ethertype < ETHERTYPE_MIN || ethertype == ETHERTYPE_VLAN || ethertype == ETHERTYPE_QINQ) {
+        return ParseResult::end();
+    }
+    return ParseResult::nextLayer(ethertype, offset);
 }
 
 void ETHAnalyzer::print(std::ostream &os) const {
-    os << "ETH packets: " << counter;
+    os << "ETH packets: " << counter.get();
+}
+
+void ETHAnalyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const ETHAnalyzer &>(other);
+    counter.add(source.counter.get());
 }
@@ -0,0 +1,28 @@
+#include <stdexcept>
+
+#include "analyzers/IAnalyzer.h"
+
+AnalyzerWorkload AnalyzerWorkload::parse(const std::string &description) {
+    AnalyzerWorkload result;
+    if (description == "counter") {
+        result.type = AnalyzerWork::COUNTER;
+    } else if (description == "header") {
+        result.type = AnalyzerWork::HEADER;
+        result.bytes = WORKLOAD_HEADER_SIZE;
+    } else if (description.substr(0, 6) == "bytes:") {
+        result.type = AnalyzerWork::BYTES;
+        // Only digits, std::stoull would wrap a negative count around to an enormous one
+        std::string count = description.substr(6);
+        try {
+            if (count.empty() || count.find_first_not_of("0123456789") != std::string::npos) {
+                throw std::invalid_argument(count);
+            }
+            result.bytes = std::stoull(count);
+        } catch (std::logic_error &e) {
+            throw std::invalid_argument("Invalid byte count in workload " + description + ".");
+        }
+    } else {
+        throw std::invalid_argument("Invalid workload " + description + " (expected counter, header or bytes:<N>).");
+    }
+    return result;
+}
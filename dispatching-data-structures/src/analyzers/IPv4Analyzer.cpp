@@ -1,9 +1,36 @@
 #include "analyzers/IPv4Analyzer.h"
+#include "ProtocolHeaders.h"
 
-void IPv4Analyzer::analyze(const MyPacket &packet) {
-    counter++;
+void IPv4Analyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult IPv4Analyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    counter.increment();
+    if (!fits(frame, offset, IPV4_MIN_HEADER_SIZE)) {
+        return ParseResult::end();
+    }
+
+    const uint8_t *header = frame.data() + offset;
+    size_t headerLength = (header[0] & 0xFu) * 4;
+    if (header[0] >> 4u != 4 || headerLength < IPV4_MIN_HEADER_SIZE || !fits(frame, offset, headerLength)) {
+        return ParseResult::end();
+    }
+
+    // Later fragments do not start with the header of the next layer
+    uint8_t protocol = header[9];
+    if ((loadBigEndian16(header + 6) & 0x1FFFu) != 0 || protocol == IP_PROTOCOL_NO_NEXT_HEADER) {
+        return ParseResult::end();
+    }
+    return ParseResult::nextLayer(protocol, offset + headerLength);
 }
 
 void IPv4Analyzer::print(std::ostream &os) const {
-    os << "IPv4 packets: " << counter;
+    os << "IPv4 packets: " << counter.get();
+}
+
+void IPv4Analyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const IPv4Analyzer &>(other);
+    counter.add(source.counter.get());
 }
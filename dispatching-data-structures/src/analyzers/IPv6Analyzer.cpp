@@ -1,9 +1,44 @@
 #include "analyzers/IPv6Analyzer.h"
+#include "ProtocolHeaders.h"
 
-void IPv6Analyzer::analyze(const MyPacket &packet) {
-    counter++;
+void IPv6Analyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult IPv6Analyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    counter.increment();
+    if (!fits(frame, offset, IPV6_HEADER_SIZE) || frame[offset] >> 4u != 6) {
+        return ParseResult::end();
+    }
+
+    // The next layer is named by the "next header" field of the last extension header
+    uint8_t next = frame[offset + 6];
+    offset += IPV6_HEADER_SIZE;
+    while (isIPv6ExtensionHeader(next)) {
+        if (!fits(frame, offset, IPV6_EXTENSION_MIN_SIZE)) {
+            return ParseResult::end();
+        }
+
+        const uint8_t *extension = frame.data() + offset;
+        if (next == IP_PROTOCOL_FRAGMENT && (loadBigEndian16(extension + 2) & 0xFFF8u) != 0) {
+            return ParseResult::end();
+        }
+        offset += ipv6ExtensionHeaderLength(next, extension);
+        next = extension[0];
+    }
+
+    if (offset > frame.size() || next == IP_PROTOCOL_NO_NEXT_HEADER) {
+        return ParseResult::end();
+    }
+    return ParseResult::nextLayer(next, offset);
 }
 
 void IPv6Analyzer::print(std::ostream &os) const {
-    os << "IPv6 packets: " << counter;
+    os << "IPv6 packets: " << counter.get();
+}
+
+void IPv6Analyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const IPv6Analyzer &>(other);
+    counter.add(source.counter.get());
 }
@@ -1,9 +1,31 @@
 #include "analyzers/TCPAnalyzer.h"
+#include "ProtocolHeaders.h"
 
-void TCPAnalyzer::analyze(const MyPacket &packet) {
-    counter++;
+void TCPAnalyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult TCPAnalyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    counter.increment();
+    if (!fits(frame, offset, TCP_MIN_HEADER_SIZE)) {
+        return ParseResult::end();
+    }
+
+    // Validate the data offset, the application layer is not dispatched
+    size_t headerLength = (frame[offset + 12] >> 4u) * 4;
+    if (headerLength >= TCP_MIN_HEADER_SIZE && fits(frame, offset, headerLength)) {
+        validHeaders.increment();
+    }
+    return ParseResult::end();
 }
 
 void TCPAnalyzer::print(std::ostream &os) const {
-    os << "TCP packets: " << counter;
+    os << "TCP packets: " << counter.get() << ", valid headers: " << validHeaders.get();
+}
+
+void TCPAnalyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const TCPAnalyzer &>(other);
+    counter.add(source.counter.get());
+    validHeaders.add(source.validHeaders.get());
 }
@@ -1,9 +1,31 @@
 #include "analyzers/UDPAnalyzer.h"
+#include "ProtocolHeaders.h"
 
-void UDPAnalyzer::analyze(const MyPacket &packet) {
-    counter++;
+void UDPAnalyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult UDPAnalyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    counter.increment();
+    if (!fits(frame, offset, UDP_HEADER_SIZE)) {
+        return ParseResult::end();
+    }
+
+    // Validate the length, the application layer is not dispatched
+    size_t length = loadBigEndian16(frame.data() + offset + 4);
+    if (length >= UDP_HEADER_SIZE && fits(frame, offset, length)) {
+        validHeaders.increment();
+    }
+    return ParseResult::end();
 }
 
 void UDPAnalyzer::print(std::ostream &os) const {
-    os << "UDP packets: " << counter;
+    os << "UDP packets: " << counter.get() << ", valid headers: " << validHeaders.get();
+}
+
+void UDPAnalyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const UDPAnalyzer &>(other);
+    counter.add(source.counter.get());
+    validHeaders.add(source.validHeaders.get());
 }
@@ -1,9 +1,21 @@
 #include "analyzers/UnknownAnalyzer.h"
 
-void UnknownAnalyzer::analyze(const MyPacket &packet) {
-    counter++;
+void UnknownAnalyzer::analyze(const PacketView &packet) {
+    counter.increment();
+    work(packet);
+}
+
+ParseResult UnknownAnalyzer::parse(const ArrayView<uint8_t> &frame, size_t offset) {
+    // The protocol is not known, so the chain ends here
+    counter.increment();
+    return ParseResult::end();
 }
 
 void UnknownAnalyzer::print(std::ostream &os) const {
-    os << "Unknown packets: " << counter;
+    os << "Unknown packets: " << counter.get();
+}
+
+void UnknownAnalyzer::mergeState(const IAnalyzer &other) {
+    const auto &source = static_cast<const UnknownAnalyzer &>(other);
+    counter.add(source.counter.get());
 }
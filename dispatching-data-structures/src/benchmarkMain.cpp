@@ -1,28 +1,99 @@
 #include <benchmark/benchmark.h>
+#include <chrono>
 #include <iostream>
 
 #include "dispatchers/All.h"
+#include "CachePressure.h"
+#include "CycleTimer.h"
+#include "HugePages.h"
 #include "InputReader.h"
+#include "LatencyHistogram.h"
+#include "PerfCounters.h"
 
 #define ITERATIONS 1
+
+// Identifiers per call of IDispatcher::lookupInterleaved
+#define INTERLEAVED_BENCHMARK_CHUNK 1024
 benchmark::TimeUnit timeunit = benchmark::kMillisecond;
 
-#define registerBenchmark(dispatcher, test, packets, analyzerBuilders, repetitionCount) \
-    benchmark::RegisterBenchmark(#dispatcher, test, std::make_shared<dispatcher>(), packets, analyzerBuilders) \
+// RegisterBenchmark copies its arguments, the trace and the builders are shared by reference instead. The dispatcher
+// is created with new rather than make_shared, so a class level operator new (Array, see HugePages) applies.
+#define registerNamedBenchmark(name, dispatcher, test, packets, analyzerBuilders, arena, repetitionCount) \
+    benchmark::RegisterBenchmark((name).c_str(), test, std::shared_ptr<dispatcher>(new dispatcher()), std::cref(packets), std::cref(analyzerBuilders), arena) \
     ->Unit(timeunit) \
     ->Iterations(ITERATIONS) \
     ->Repetitions(repetitionCount)
 
+#define registerBenchmark(dispatcher, suffix, test, packets, analyzerBuilders, arena, repetitionCount) \
+    registerNamedBenchmark(std::string(#dispatcher) + suffix, dispatcher, test, packets, analyzerBuilders, arena, repetitionCount)
+
+// Every how many lookups the "latency" mode times one, set with latency=<N>
+size_t latencySampleInterval = 1;
+
+// Cache pressure between lookups: evict=<K>[:thrash] evicts the dispatcher every K packets, pollute=<N> touches N KiB
+// before every packet
+size_t evictionInterval = 0;
+bool evictByThrashing = false;
+size_t pollutionBytes = 0;
+
+// The "slots" keyword adds the split and packed slot layouts of Hanov and Universal to every mode
+bool slotLayouts = false;
+
+// Counters of the "counters" keyword, reported per lookup as user counters of every run
+std::unique_ptr<PerfCounters> perfCounters;
+
+void startPerfCounters() {
+    if (perfCounters) {
+        perfCounters->start();
+    }
+}
+
+// Leaves work inside the timed loop out of the counters, like State::PauseTiming does for the time
+void pausePerfCounters() {
+    if (perfCounters) {
+        perfCounters->pause();
+    }
+}
+
+void resumePerfCounters() {
+    if (perfCounters) {
+        perfCounters->resume();
+    }
+}
+
+void reportPerfCounters(benchmark::State &state, uint64_t lookupCount) {
+    if (!perfCounters) {
+        return;
+    }
+    perfCounters->stop();
+    for (size_t i = 0; i < perfCounters->getNames().size(); i++) {
+        state.counters[perfCounters->getNames()[i]] =
+                lookupCount == 0 ? 0 : static_cast<double>(perfCounters->getValues()[i]) / lookupCount;
+    }
+}
+
+using benchmark_function = void (*)(
+        benchmark::State &,
+        std::shared_ptr<IDispatcher> &&,
+        const PacketBatch &,
+        const std::map<identifier_t, analyzer_builder> &,
+        const std::shared_ptr<AnalyzerArena> &
+);
+
 // Need to use a shared_ptr because RegisterBenchmark internally creates a lambda with a copy capture.
 void BM_startup(
 		benchmark::State &state,
 		std::shared_ptr<IDispatcher> &&dispatcher,
-		const std::vector<MyPacket> &packets,
-		const std::map<identifier_t, analyzer_builder> &analyzerBuilders
+		const PacketBatch &packets,
+		const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+		const std::shared_ptr<AnalyzerArena> &arena
 ) {
 	for (auto _ : state) {
 		dispatcher->registerAnalyzers(analyzerBuilders);
 		dispatcher->clear();
+		if (arena) {
+			arena->clear();
+		}
 	}
 }
 
@@ -30,20 +101,413 @@ void BM_startup(
 void BM_dispatchers(
 	benchmark::State &state,
 	std::shared_ptr<IDispatcher> &&dispatcher,
-	const std::vector<MyPacket> &packets,
-	const std::map<identifier_t, analyzer_builder> &analyzerBuilders
+	const PacketBatch &packets,
+	const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+	const std::shared_ptr<AnalyzerArena> &arena
 ) {
     dispatcher->registerAnalyzers(analyzerBuilders);
 
+    // Lookups only need the identifiers, walk the flat array of all packets
+    startPerfCounters();
     for (auto _ : state) {
+        for (const auto &identifier : packets.getIdentifiers()) {
+            benchmark::DoNotOptimize(dispatcher->lookup(identifier));
+        }
+    }
+    reportPerfCounters(state, state.iterations() * packets.identifierCount());
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_dispatchers, but the tables the dispatcher allocates while registering follow the given page policy. The
+// dispatchers are also constructed with it (see main), which matters for tables that are allocated up front. After the
+// lookups, the mappings of the dispatcher are reported as counters: "huge_bytes" are backed by huge pages (explicit or
+// transparent ones the kernel backed, see HugePages::usage), "mapped_bytes" are all bytes of its huge page mappings.
+template<PagePolicy policy>
+void BM_hugePages(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    PagePolicy previous = HugePages::getPolicy();
+    HugePages::setPolicy(policy);
+    uint64_t serial = HugePages::serial();
+    dispatcher->registerAnalyzers(analyzerBuilders);
+
+    startPerfCounters();
+    for (auto _ : state) {
+        for (const auto &identifier : packets.getIdentifiers()) {
+            benchmark::DoNotOptimize(dispatcher->lookup(identifier));
+        }
+    }
+    reportPerfCounters(state, state.iterations() * packets.identifierCount());
+
+    // Array is placed as a whole when it is constructed, before the benchmark runs
+    HugePageUsage usage = HugePages::usage(serial, dispatcher.get());
+    state.counters["huge_bytes"] = usage.explicitBytes + usage.transparentHugeBytes;
+    state.counters["mapped_bytes"] = usage.explicitBytes + usage.transparentBytes + usage.smallBytes;
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+    HugePages::setPolicy(previous);
+}
+
+// Same as BM_dispatchers, but with the branchless variant of every lookup (see IDispatcher::lookupBranchless).
+void BM_branchless(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+
+    startPerfCounters();
+    for (auto _ : state) {
+        for (const auto &identifier : packets.getIdentifiers()) {
+            benchmark::DoNotOptimize(dispatcher->lookupBranchless(identifier));
+        }
+    }
+    reportPerfCounters(state, state.iterations() * packets.identifierCount());
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_dispatchers, but keeps up to GroupSize lookups in flight (see IDispatcher::lookupInterleaved). Every
+// iteration first runs the plain lookups of BM_dispatchers over the trace with the timing and counters paused, so both
+// passes see the same cache state and run equally often. The "speedup" counter is the ratio of their summed times.
+template<size_t GroupSize>
+void BM_interleaved(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+    ArrayView<identifier_t> identifiers = packets.getIdentifiers();
+
+    // The results go to a small buffer that stays cached, the lookups in flight only drain at its end
+    IAnalyzer *results[INTERLEAVED_BENCHMARK_CHUNK];
+    std::chrono::duration<double> sequential{};
+    std::chrono::duration<double> interleaved{};
+    startPerfCounters();
+    for (auto _ : state) {
+        state.PauseTiming();
+        pausePerfCounters();
+        auto sequentialStart = std::chrono::steady_clock::now();
+        for (const auto &identifier : identifiers) {
+            benchmark::DoNotOptimize(dispatcher->lookup(identifier));
+        }
+        sequential += std::chrono::steady_clock::now() - sequentialStart;
+        resumePerfCounters();
+        state.ResumeTiming();
+
+        auto start = std::chrono::steady_clock::now();
+        for (size_t i = 0; i < identifiers.size(); i += INTERLEAVED_BENCHMARK_CHUNK) {
+            size_t count = std::min<size_t>(INTERLEAVED_BENCHMARK_CHUNK, identifiers.size() - i);
+            dispatcher->lookupInterleaved(identifiers.data() + i, count, results, GroupSize);
+            benchmark::DoNotOptimize(results);
+            benchmark::ClobberMemory();
+        }
+        interleaved += std::chrono::steady_clock::now() - start;
+    }
+    state.SetItemsProcessed(state.iterations() * identifiers.size());
+    reportPerfCounters(state, state.iterations() * identifiers.size());
+    state.counters["speedup"] = interleaved.count() == 0 ? 0 : sequential.count() / interleaved.count();
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_dispatchers, but times every latencySampleInterval-th lookup on its own with the CycleTimer. The
+// percentiles of these samples are reported as counters in nanoseconds, the total time includes the timer overhead.
+void BM_latency(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+    ArrayView<identifier_t> identifiers = packets.getIdentifiers();
+
+    LatencyHistogram histogram;
+    startPerfCounters();
+    for (auto _ : state) {
+        size_t untilSample = 0;
+        for (const auto &identifier : identifiers) {
+            if (untilSample == 0) {
+                uint64_t start = CycleTimer::start();
+                benchmark::DoNotOptimize(dispatcher->lookup(identifier));
+                histogram.record(CycleTimer::elapsed(start, CycleTimer::stop()));
+                untilSample = latencySampleInterval;
+            } else {
+                benchmark::DoNotOptimize(dispatcher->lookup(identifier));
+            }
+            untilSample--;
+        }
+    }
+    reportPerfCounters(state, state.iterations() * identifiers.size());
+    state.counters["samples"] = histogram.getCount();
+    state.counters["p50_ns"] = CycleTimer::toNanoseconds(histogram.percentile(0.5));
+    state.counters["p90_ns"] = CycleTimer::toNanoseconds(histogram.percentile(0.9));
+    state.counters["p99_ns"] = CycleTimer::toNanoseconds(histogram.percentile(0.99));
+    state.counters["p999_ns"] = CycleTimer::toNanoseconds(histogram.percentile(0.999));
+    state.counters["max_ns"] = CycleTimer::toNanoseconds(histogram.getMax());
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_dispatchers, but puts the caches under pressure between packets like the rest of a monitor would: every
+// evictionInterval packets, the memory of the dispatcher and its analyzers is flushed (or a working set larger than the
+// last level cache is touched), and before every packet a working set of pollutionBytes is touched. The total time
+// and the counters include this work, the "lookup_ns" counter is the time per lookup without it.
+void BM_pressure(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+    std::vector<MemoryRegion> regions = dispatcher->memoryRegions();
+    std::unique_ptr<CachePressure> thrash;
+    if (evictionInterval != 0 && evictByThrashing) {
+        thrash = std::make_unique<CachePressure>(CACHE_PRESSURE_THRASH_SIZE);
+    }
+    std::unique_ptr<CachePressure> pollution;
+    if (pollutionBytes != 0) {
+        pollution = std::make_unique<CachePressure>(pollutionBytes);
+    }
+
+    // The packets between two evictions or pollutions are timed as one interval, fenced like the latency mode and
+    // without the overhead of the timer, so the timer does not dominate packets of a few cheap lookups
+    uint64_t lookupTicks = 0;
+    startPerfCounters();
+    for (auto _ : state) {
+        size_t untilEviction = 0;
+        bool timing = false;
+        uint64_t start = 0;
         for (const auto &packet : packets) {
+            bool evict = evictionInterval != 0 && untilEviction-- == 0;
+            if (timing && (evict || pollution)) {
+                lookupTicks += CycleTimer::elapsed(start, CycleTimer::stop());
+                timing = false;
+            }
+            if (evict) {
+                if (thrash) {
+                    thrash->touch();
+                } else {
+                    CachePressure::flush(regions);
+                }
+                untilEviction = evictionInterval - 1;
+            }
+            if (pollution) {
+                pollution->touch();
+            }
+
+            if (!timing) {
+                start = CycleTimer::start();
+                timing = true;
+            }
             for (const auto &identifier : packet.getIdentifiers()) {
                 benchmark::DoNotOptimize(dispatcher->lookup(identifier));
             }
         }
+        if (timing) {
+            lookupTicks += CycleTimer::elapsed(start, CycleTimer::stop());
+        }
     }
+    uint64_t lookupCount = state.iterations() * packets.identifierCount();
+    state.SetItemsProcessed(lookupCount);
+    reportPerfCounters(state, lookupCount);
+    state.counters["lookup_ns"] = lookupCount == 0 ? 0 : CycleTimer::toNanoseconds(lookupTicks) / lookupCount;
 
     dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_dispatchers, but follows the returned pointer and calls the analyzer like a monitor would.
+// The work each analyzer does per PDU is set with IAnalyzer::setWorkload.
+void BM_invoke(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+
+    startPerfCounters();
+    for (auto _ : state) {
+        for (const auto &packet : packets) {
+            for (const auto &identifier : packet.getIdentifiers()) {
+                IAnalyzer *analyzer = dispatcher->lookup(identifier);
+                if (analyzer != nullptr) {
+                    analyzer->analyze(packet);
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * packets.identifierCount());
+    reportPerfCounters(state, state.iterations() * packets.identifierCount());
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Same as BM_invoke, but invokes the analyzers through an AnalyzerRef instead of the virtual analyze().
+template<void (*invoke)(const AnalyzerRef &, const PacketView &)>
+void BM_invokeRef(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+
+    startPerfCounters();
+    for (auto _ : state) {
+        for (const auto &packet : packets) {
+            for (const auto &identifier : packet.getIdentifiers()) {
+                AnalyzerRef analyzer = dispatcher->lookupRef(identifier);
+                if (analyzer) {
+                    invoke(analyzer, packet);
+                }
+            }
+        }
+    }
+    state.SetItemsProcessed(state.iterations() * packets.identifierCount());
+    reportPerfCounters(state, state.iterations() * packets.identifierCount());
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+// Dispatches on raw frames like a monitor: starting with the link layer, every analyzer parses its header and names
+// the identifier of the next layer, which is looked up in turn. Which lookups happen depends on the frame content.
+void BM_parse(
+    benchmark::State &state,
+    std::shared_ptr<IDispatcher> &&dispatcher,
+    const PacketBatch &frames,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena
+) {
+    dispatcher->registerAnalyzers(analyzerBuilders);
+
+    size_t lookupCount = 0;
+    startPerfCounters();
+    for (auto _ : state) {
+        for (const auto &frame : frames) {
+            if (frame.getIdentifiers().empty()) {
+                continue;
+            }
+
+            ParseResult result = ParseResult::nextLayer(frame.getIdentifiers()[0], 0);
+            while (result.hasNext) {
+                IAnalyzer *analyzer = dispatcher->lookup(result.next);
+                lookupCount++;
+                if (analyzer == nullptr) {
+                    break;
+                }
+                result = analyzer->parse(frame.getPayload(), result.offset);
+            }
+        }
+    }
+    state.SetItemsProcessed(lookupCount);
+    reportPerfCounters(state, lookupCount);
+
+    dispatcher->clear();
+    if (arena) {
+        arena->clear();
+    }
+}
+
+void registerDispatcherBenchmarks(
+    const std::string &suffix,
+    benchmark_function benchmarkFunction,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena,
+    uint32_t repetitionCount,
+    const std::string &analyzerFile
+) {
+    registerBenchmark(Array, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Vector, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(TreeMap, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(UnorderedMap, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Cuckoo, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Hanov, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Universal, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(SparseUpper, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    if (slotLayouts) {
+        registerBenchmark(HanovSplit, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(HanovPacked, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(UniversalSplit, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(UniversalPacked, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    }
+
+    // The generated dispatchers contain their analyzers as members, an arena makes no difference for them.
+    if (arena) {
+        return;
+    }
+
+    // Fragmented tests
+    if (analyzerFile.find("fragmented") != std::string::npos) {
+        registerBenchmark(GeneratedSwitchFragmented, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(GeneratedIfFragmented, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    }
+
+    // Zeek default mapping tests
+    if (analyzerFile.find("zeek") != std::string::npos) {
+        registerBenchmark(GeneratedSwitchZeek, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(GeneratedIfZeek, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    }
+}
+
+// Registers the dispatchers that store the type tag of every analyzer next to its pointer (see IDispatcher::lookupRef),
+// for the devirtualized variants. The others load the tag from the analyzer, there is nothing to compare for them.
+void registerStoredKindBenchmarks(
+    const std::string &suffix,
+    benchmark_function benchmarkFunction,
+    const PacketBatch &packets,
+    const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+    const std::shared_ptr<AnalyzerArena> &arena,
+    uint32_t repetitionCount
+) {
+    registerBenchmark(Array, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Vector, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Hanov, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    registerBenchmark(Universal, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    if (slotLayouts) {
+        registerBenchmark(HanovSplit, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(HanovPacked, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(UniversalSplit, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+        registerBenchmark(UniversalPacked, suffix, benchmarkFunction, packets, analyzerBuilders, arena, repetitionCount);
+    }
 }
 
 int main(int argc, char** argv) {
@@ -58,23 +522,148 @@ int main(int argc, char** argv) {
         return 1;
     }
 
-    auto benchmarkFunction = BM_dispatchers;
-    if (argc > 4 && std::string(argv[4]) == "startup") {
-        // Benchmark startup time instead.
-        benchmarkFunction = BM_startup;
+    // Optional keywords after the repetition count select the mode, flags for google benchmark start with --.
+    benchmark_function benchmarkFunction = BM_dispatchers;
+    bool useArena = false;
+    bool devirtualized = false;
+    bool interleaved = false;
+    bool branchless = false;
+    bool hugePages = false;
+    PagePolicy tracePolicy = PagePolicy::SMALL;
+    for (int i = 4; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option == "startup") {
+            // Benchmark startup time instead.
+            benchmarkFunction = BM_startup;
+        } else if (option == "invoke") {
+            // Benchmark lookup plus analyzer invocation instead.
+            benchmarkFunction = BM_invoke;
+        } else if (option == "parse") {
+            // Benchmark dispatching on raw frames, with the analyzers parsing the headers.
+            benchmarkFunction = BM_parse;
+        } else if (option.substr(0, 7) == "latency") {
+            // Time single lookups and report their percentiles, latency=<N> only times every N-th lookup.
+            benchmarkFunction = BM_latency;
+            if (option.size() > 7) {
+                long interval = option[7] == '=' ? std::strtol(option.c_str() + 8, nullptr, 10) : 0;
+                if (interval <= 0) {
+                    std::cerr << "Invalid latency sample interval: " << option << std::endl;
+                    return 1;
+                }
+                latencySampleInterval = interval;
+            }
+        } else if (option.substr(0, 6) == "evict=") {
+            // Evict the dispatcher from the caches every N packets, with clflush or with :thrash by a large working set
+            size_t separator = option.find(':');
+            evictByThrashing = separator != std::string::npos && option.substr(separator + 1) == "thrash";
+            long interval = std::strtol(option.c_str() + 6, nullptr, 10);
+            if (interval <= 0 || (separator != std::string::npos && !evictByThrashing)) {
+                std::cerr << "Invalid eviction interval: " << option << std::endl;
+                return 1;
+            }
+            evictionInterval = interval;
+        } else if (option.substr(0, 8) == "pollute=") {
+            // Touch a working set of N KiB before every packet
+            long kibibytes = std::strtol(option.c_str() + 8, nullptr, 10);
+            if (kibibytes <= 0) {
+                std::cerr << "Invalid pollution size: " << option << std::endl;
+                return 1;
+            }
+            pollutionBytes = kibibytes * 1024;
+        } else if (option == "arena") {
+            // Additionally run every dispatcher with analyzers placed in an AnalyzerArena.
+            useArena = true;
+        } else if (option == "devirtualized") {
+            // Additionally invoke the analyzers through a switch and a function table instead of the vtable.
+            devirtualized = true;
+        } else if (option == "interleaved") {
+            // Additionally look up with 1 to 32 lookups in flight, the default mode is the baseline.
+            interleaved = true;
+        } else if (option == "branchless") {
+            // Additionally look up without data dependent branches, the default mode is the baseline.
+            branchless = true;
+        } else if (option == "slots") {
+            // Additionally run Hanov and Universal with their keys apart from the analyzers (see SlotLayout.h)
+            slotLayouts = true;
+        } else if (option == "hugepages") {
+            // Additionally back the tables with transparent and with explicit huge pages, the default mode is the baseline.
+            hugePages = true;
+        } else if (option.substr(0, 11) == "tracepages=") {
+            // Page policy of the trace: small, thp or explicit
+            try {
+                tracePolicy = HugePages::parsePolicy(option.substr(11));
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        } else if (option == "counters") {
+            // Report hardware counters per lookup, or software events if there is no PMU.
+            try {
+                perfCounters = std::make_unique<PerfCounters>();
+            } catch (std::runtime_error &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            if (!perfCounters->hasHardwareEvents()) {
+                std::cerr << "No hardware performance counters available, counting software events instead." << std::endl;
+            }
+        } else if (option.substr(0, 5) == "work=") {
+            // Work every analyzer does per PDU in invoke mode: counter, header or bytes:<N>
+            try {
+                IAnalyzer::setWorkload(AnalyzerWorkload::parse(option.substr(5)));
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    if (devirtualized && benchmarkFunction != BM_invoke) {
+        std::cerr << "The devirtualized keyword requires invoke." << std::endl;
+        return 1;
+    } else if ((interleaved || branchless || hugePages) && benchmarkFunction != BM_dispatchers) {
+        std::cerr << "The interleaved, branchless and hugepages keywords only apply to plain lookups." << std::endl;
+        return 1;
+    }
+
+    if (evictionInterval != 0 || pollutionBytes != 0) {
+        if (benchmarkFunction != BM_dispatchers || interleaved || branchless) {
+            std::cerr << "The evict and pollute keywords only apply to plain lookups." << std::endl;
+            return 1;
+        }
+        benchmarkFunction = BM_pressure;
+        // Eviction flushes the memory the dispatchers record, the other modes build them without bookkeeping
+        MemoryTracker::setEnabled(evictionInterval != 0);
     }
 
-    std::vector<MyPacket> packets;
+    if (benchmarkFunction == BM_latency || benchmarkFunction == BM_pressure) {
+        CycleTimer::calibrate();
+    }
+
+    PacketBatch packets;
     try {
-        packets = InputReader::readPacketFile(argv[1]);
+        HugePages::setPolicy(tracePolicy);
+        packets = benchmarkFunction == BM_parse ? InputReader::readFrames(argv[1]) : InputReader::readPacketFile(argv[1]);
+        // A mapped trace file is backed by the page cache, copy it to apply the policy
+        if (tracePolicy != PagePolicy::SMALL && packets.isMapped()) {
+            PacketBatch copy;
+            copy.append(packets);
+            packets = std::move(copy);
+        }
+        HugePages::setPolicy(PagePolicy::SMALL);
     } catch (std::invalid_argument &e) {
         std::cerr << "Error reading packet file: " << e.what() << std::endl;
         return 1;
     }
 
     std::map<identifier_t, analyzer_builder> analyzerBuilders;
+    std::map<identifier_t, analyzer_builder> arenaAnalyzerBuilders;
+    auto arena = std::make_shared<AnalyzerArena>();
     try {
         analyzerBuilders = InputReader::readAnalyzerFile(argv[2]);
+        if (useArena) {
+            arenaAnalyzerBuilders = InputReader::readAnalyzerFile(argv[2], *arena);
+        }
     } catch (std::invalid_argument &e) {
         std::cerr << "Error reading analyzer file: " << e.what() << std::endl;
         return 1;
@@ -82,25 +671,50 @@ int main(int argc, char** argv) {
 
     uint32_t repetitionCount = std::stoi(argv[3]);
 
-    registerBenchmark(Array, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(Vector, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(TreeMap, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(UnorderedMap, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(Cuckoo, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(Hanov, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(Universal, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-    registerBenchmark(SparseUpper, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
+    std::vector<std::pair<std::string, benchmark_function>> variants = {{"", benchmarkFunction}};
+    std::vector<std::pair<std::string, benchmark_function>> storedKindVariants;
+    if (devirtualized) {
+        storedKindVariants.emplace_back("+switch", BM_invokeRef<invokeSwitch>);
+        storedKindVariants.emplace_back("+table", BM_invokeRef<invokeTable>);
+    }
+    if (branchless) {
+        variants.emplace_back("+branchless", BM_branchless);
+    }
+    if (interleaved) {
+        variants.emplace_back("+group1", BM_interleaved<1>);
+        variants.emplace_back("+group2", BM_interleaved<2>);
+        variants.emplace_back("+group4", BM_interleaved<4>);
+        variants.emplace_back("+group8", BM_interleaved<8>);
+        variants.emplace_back("+group16", BM_interleaved<16>);
+        variants.emplace_back("+group32", BM_interleaved<32>);
+    }
 
-    // Fragmented tests
-    if (std::string(argv[2]).find("fragmented") != std::string::npos) {
-        registerBenchmark(GeneratedSwitchFragmented, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-        registerBenchmark(GeneratedIfFragmented, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
+    for (const auto &variant : variants) {
+        registerDispatcherBenchmarks(variant.first, variant.second, packets, analyzerBuilders, nullptr, repetitionCount, argv[2]);
+    }
+    for (const auto &variant : storedKindVariants) {
+        registerStoredKindBenchmarks(variant.first, variant.second, packets, analyzerBuilders, nullptr, repetitionCount);
+    }
+    if (hugePages) {
+        // Array places its table when the object is created, i.e. when it is registered
+        HugePages::setPolicy(PagePolicy::TRANSPARENT);
+        registerDispatcherBenchmarks("+thp", BM_hugePages<PagePolicy::TRANSPARENT>, packets, analyzerBuilders, nullptr, repetitionCount, argv[2]);
+        HugePages::setPolicy(PagePolicy::EXPLICIT);
+        registerDispatcherBenchmarks("+hugetlb", BM_hugePages<PagePolicy::EXPLICIT>, packets, analyzerBuilders, nullptr, repetitionCount, argv[2]);
+        HugePages::setPolicy(PagePolicy::SMALL);
+    }
+    if (useArena) {
+        for (const auto &variant : variants) {
+            registerDispatcherBenchmarks("+arena" + variant.first, variant.second, packets, arenaAnalyzerBuilders, arena, repetitionCount, argv[2]);
+        }
+        for (const auto &variant : storedKindVariants) {
+            registerStoredKindBenchmarks("+arena" + variant.first, variant.second, packets, arenaAnalyzerBuilders, arena, repetitionCount);
+        }
     }
 
-    // Zeek default mapping tests
-    if (std::string(argv[2]).find("zeek") != std::string::npos) {
-        registerBenchmark(GeneratedSwitchZeek, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
-        registerBenchmark(GeneratedIfZeek, benchmarkFunction, packets, analyzerBuilders, repetitionCount);
+    // The tables of the dispatchers are reported by BM_hugePages, they only exist while it runs
+    if (tracePolicy != PagePolicy::SMALL) {
+        HugePages::report(std::cerr);
     }
 
     benchmark::Initialize(&argc, argv);
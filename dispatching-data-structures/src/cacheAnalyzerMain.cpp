@@ -1,73 +1,196 @@
 #include <iostream>
 #include "dispatchers/All.h"
+#include "CacheSimulator.h"
 #include "InputReader.h"
-#include "papi.h"
+#include "PerfCounters.h"
 
-#define PMU_EVENT_COUNT 3
-
-#define PAPI_error_check(x) if (x < PAPI_OK) throw std::runtime_error("Error in PAPI call: " + std::to_string(x))
-#define runAnalysis(dispatcher, packets, analyzerBuilders) measure(#dispatcher, std::make_unique<dispatcher>(), packets, analyzerBuilders)
-
-int pmu_events[PMU_EVENT_COUNT] = {
-	PAPI_L1_DCM,
-	PAPI_L2_DCM,
-	PAPI_L3_TCM
-};
+#define runAnalysis(dispatcher, suffix, packets, analyzerBuilders, arena, invoke) \
+    if (memory) reportMemory(std::string(#dispatcher) + suffix, std::make_unique<dispatcher>(), analyzerBuilders, arena); \
+    else if (simulate) simulateCaches(simulatorConfig, std::string(#dispatcher) + suffix, std::make_unique<dispatcher>(), packets, analyzerBuilders, arena); \
+    else measure(*perfCounters, std::string(#dispatcher) + suffix, std::make_unique<dispatcher>(), packets, analyzerBuilders, arena, invoke)
 
 void measure(
+	PerfCounters& counters,
 	const std::string& name,
 	std::unique_ptr<IDispatcher>&& dispatcher,
-	const std::vector<MyPacket>& packets,
-	const std::map<identifier_t, analyzer_builder>& analyzerBuilders
+	const PacketBatch& packets,
+	const std::map<identifier_t, analyzer_builder>& analyzerBuilders,
+	AnalyzerArena* arena,
+	bool invoke
 ) {
 	dispatcher->registerAnalyzers(analyzerBuilders);
 
-	long_long results[PMU_EVENT_COUNT];
-	PAPI_error_check(PAPI_start_counters(pmu_events, PMU_EVENT_COUNT));
-	for (const auto &packet : packets) {
-		for (const auto &identifier : packet.getIdentifiers()) {
+	counters.start();
+	if (invoke) {
+		// Follow the returned pointer into the analyzer, so its placement shows up in the cache misses
+		for (const auto &packet : packets) {
+			for (const auto &identifier : packet.getIdentifiers()) {
+				IAnalyzer *analyzer = dispatcher->lookup(identifier);
+				if (analyzer != nullptr) {
+					analyzer->analyze(packet);
+				}
+			}
+		}
+	} else {
+		for (const auto &identifier : packets.getIdentifiers()) {
 			dispatcher->lookup(identifier);
 		}
 	}
-	PAPI_error_check(PAPI_stop_counters(results, PMU_EVENT_COUNT));
+	counters.stop();
 
-	// Print results
-	std::cout << name;
-	for (const auto& current : results) {
+	// Print results, the lookups allow to normalize the counters
+	std::cout << name << "," << packets.identifierCount();
+	for (const auto& current : counters.getValues()) {
 		std::cout << "," << current;
 	}
 	std::cout << std::endl;
 
 	dispatcher->clear();
+	if (arena != nullptr) {
+		arena->clear();
+	}
 }
 
-int main(int argc, char** argv) {
-	if (PAPI_library_init(PAPI_VER_CURRENT) != PAPI_VER_CURRENT) {
-		exit(1);
+// Prints the memory breakdown of the dispatcher with all analyzers registered instead of measuring lookups
+void reportMemory(
+	const std::string& name,
+	std::unique_ptr<IDispatcher>&& dispatcher,
+	const std::map<identifier_t, analyzer_builder>& analyzerBuilders,
+	AnalyzerArena* arena
+) {
+	dispatcher->registerAnalyzers(analyzerBuilders);
+
+	MemoryUsage usage = dispatcher->memoryUsage();
+	std::cout << name << "," << usage.table << "," << usage.metadata << "," << usage.nodes << ","
+	          << usage.allocatorOverhead << "," << usage.analyzers << "," << usage.total() << ","
+	          << usage.allocations << "," << usage.cacheLines << "," << usage.pages << ","
+	          << dispatcher->real_size() << std::endl;
+
+	dispatcher->clear();
+	if (arena != nullptr) {
+		arena->clear();
+	}
+}
+
+// Replays the loads of all lookups through the cache simulator instead of counting hardware events. The trace is
+// replayed twice and only the second pass is reported, like the counters run with caches warmed by the registration.
+void simulateCaches(
+	const CacheSimulatorConfig& config,
+	const std::string& name,
+	std::unique_ptr<IDispatcher>&& dispatcher,
+	const PacketBatch& packets,
+	const std::map<identifier_t, analyzer_builder>& analyzerBuilders,
+	AnalyzerArena* arena
+) {
+	dispatcher->registerAnalyzers(analyzerBuilders);
+
+	CacheSimulator simulator(config);
+	LookupTrace trace;
+	for (int pass = 0; pass < 2; pass++) {
+		simulator.resetStatistics();
+		for (const auto &identifier : packets.getIdentifiers()) {
+			trace.clear();
+			dispatcher->traceLookup(identifier, trace);
+			simulator.simulate(trace);
+		}
+	}
+
+	std::cout << name << "," << simulator.getLookups();
+	for (const auto& current : simulator.getValues()) {
+		std::cout << "," << current;
+	}
+	std::cout << std::endl;
+
+	dispatcher->clear();
+	if (arena != nullptr) {
+		arena->clear();
 	}
+}
+
+int main(int argc, char** argv) {
+    // The memory report and the cache simulation run without performance counters
+    bool memory = false;
+    bool simulate = false;
+    for (int i = 3; i < argc; i++) {
+        memory |= std::string(argv[i]) == "memory";
+        simulate |= std::string(argv[i]) == "simulate";
+    }
+
+    // Both need the allocations of the dispatchers, UnorderedMap finds its bucket array through them for the simulation
+    MemoryTracker::setEnabled(memory || simulate);
+
+    std::unique_ptr<PerfCounters> perfCounters;
+    if (!memory && !simulate) {
+        try {
+            perfCounters = std::make_unique<PerfCounters>();
+        } catch (std::runtime_error &e) {
+            std::cerr << e.what() << std::endl;
+            return 2;
+        }
+    }
 
     if (argc < 2) {
         std::cerr << "Path to packet file missing." << std::endl;
         return 1;
     } else if (argc < 3) {
-    	// Check if all papi counters exist.
-    	if (std::string(argv[1]) == "papi_check") {
-    		for (int pmu_event : pmu_events) {
-				PAPI_event_info_t info;
-				PAPI_get_event_info(pmu_event, &info);
-				// Counter is available if "count" is not 0 (see papi_avail.c:524)
-				if (info.count == 0) {
-					exit(2);
-				}
-    		}
-
-			exit(0);
-    	}
+        // Print the available counters, fails if they are only software events
+        if (std::string(argv[1]) == "perf_check") {
+            for (const auto &name : perfCounters->getNames()) {
+                std::cout << name << std::endl;
+            }
+            return perfCounters->hasHardwareEvents() ? 0 : 2;
+        }
 
         std::cerr << "Path to analyzer file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keywords: "invoke" also calls the analyzers, "arena" additionally measures arena placed analyzers,
+    // "work=<counter|header|bytes:N>" sets the work every analyzer does per PDU, "memory" prints the memory breakdown
+    // of every dispatcher instead of the counters, "simulate" replays the lookups through a cache simulator instead,
+    // whose levels are set with "l1=<KiB>:<ways>", "l2=", "l3=", "dtlb=<entries>:<ways>" and "stlb=", "slots" adds the
+    // split and packed slot layouts of Hanov and Universal
+    bool invoke = false;
+    bool useArena = false;
+    bool slotLayouts = false;
+    CacheSimulatorConfig simulatorConfig;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option == "invoke") {
+            invoke = true;
+        } else if (option == "arena") {
+            useArena = true;
+        } else if (option == "slots") {
+            slotLayouts = true;
+        } else if (option == "memory" || option == "simulate") {
+            continue;
+        } else if (option.find('=') != std::string::npos && (option[0] == 'l' || option.substr(1, 4) == "tlb=")) {
+            std::string level = option.substr(0, option.find('='));
+            std::string geometry = option.substr(option.find('=') + 1);
+            try {
+                if (level == "l1" || level == "l2" || level == "l3") {
+                    simulatorConfig.caches[level[1] - '1'] = CacheLevelConfig::parse(level, geometry, 1024 / MEMORY_CACHE_LINE_SIZE);
+                } else if (level == "dtlb" || level == "stlb") {
+                    simulatorConfig.tlbs[level == "stlb"] = CacheLevelConfig::parse(level, geometry, 1);
+                } else {
+                    std::cerr << "Unknown cache level " << level << "." << std::endl;
+                    return 1;
+                }
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        } else if (option.substr(0, 5) == "work=") {
+            try {
+                IAnalyzer::setWorkload(AnalyzerWorkload::parse(option.substr(5)));
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
     }
 
-    std::vector<MyPacket> packets;
+    PacketBatch packets;
     try {
         packets = InputReader::readPacketFile(argv[1]);
     } catch (std::invalid_argument &e) {
@@ -76,33 +199,79 @@ int main(int argc, char** argv) {
     }
 
     std::map<identifier_t, analyzer_builder> analyzerBuilders;
+    std::map<identifier_t, analyzer_builder> arenaAnalyzerBuilders;
+    AnalyzerArena arena;
     try {
         analyzerBuilders = InputReader::readAnalyzerFile(argv[2]);
+        if (useArena) {
+            arenaAnalyzerBuilders = InputReader::readAnalyzerFile(argv[2], arena);
+        }
     } catch (std::invalid_argument &e) {
         std::cerr << "Error reading analyzer file: " << e.what() << std::endl;
         return 1;
     }
 
-    std::cout << "name,l1_data_misses,l2_data_misses,l3_total_misses" << std::endl;
+    if (memory) {
+        std::cout << "name,table,metadata,nodes,allocator_overhead,analyzers,total,allocations,cache_lines,pages,real_size"
+                  << std::endl;
+    } else if (simulate) {
+        std::cout << "name,lookups";
+        for (const auto &name : CacheSimulator(simulatorConfig).getNames()) {
+            std::cout << "," << name;
+        }
+        std::cout << std::endl;
+    } else {
+        if (!perfCounters->hasHardwareEvents()) {
+            std::cerr << "No hardware performance counters available, counting software events instead." << std::endl;
+        }
+        std::cout << "name,lookups";
+        for (const auto &name : perfCounters->getNames()) {
+            std::cout << "," << name;
+        }
+        std::cout << std::endl;
+    }
 
-    runAnalysis(Array, packets, analyzerBuilders);
-    runAnalysis(Vector, packets, analyzerBuilders);
-    runAnalysis(TreeMap, packets, analyzerBuilders);
-    runAnalysis(UnorderedMap, packets, analyzerBuilders);
-    runAnalysis(Cuckoo, packets, analyzerBuilders);
-    runAnalysis(Hanov, packets, analyzerBuilders);
-    runAnalysis(Universal, packets, analyzerBuilders);
-    runAnalysis(SparseUpper, packets, analyzerBuilders);
+    runAnalysis(Array, "", packets, analyzerBuilders, nullptr, invoke);
+    runAnalysis(Vector, "", packets, analyzerBuilders, nullptr, invoke);
+    runAnalysis(TreeMap, "", packets, analyzerBuilders, nullptr, invoke);
+    runAnalysis(UnorderedMap, "", packets, analyzerBuilders, nullptr, invoke);
+    // The hash function of the library is internal, so Cuckoo cannot trace its lookups for the simulation
+    if (!simulate) {
+        runAnalysis(Cuckoo, "", packets, analyzerBuilders, nullptr, invoke);
+    }
+    runAnalysis(Hanov, "", packets, analyzerBuilders, nullptr, invoke);
+    runAnalysis(Universal, "", packets, analyzerBuilders, nullptr, invoke);
+    runAnalysis(SparseUpper, "", packets, analyzerBuilders, nullptr, invoke);
+    if (slotLayouts) {
+        runAnalysis(HanovSplit, "", packets, analyzerBuilders, nullptr, invoke);
+        runAnalysis(HanovPacked, "", packets, analyzerBuilders, nullptr, invoke);
+        runAnalysis(UniversalSplit, "", packets, analyzerBuilders, nullptr, invoke);
+        runAnalysis(UniversalPacked, "", packets, analyzerBuilders, nullptr, invoke);
+    }
 
     // Fragmented tests
     if (std::string(argv[2]).find("fragmented") != std::string::npos) {
-        runAnalysis(GeneratedSwitchFragmented, packets, analyzerBuilders);
-        runAnalysis(GeneratedIfFragmented, packets, analyzerBuilders);
+        runAnalysis(GeneratedSwitchFragmented, "", packets, analyzerBuilders, nullptr, invoke);
+        runAnalysis(GeneratedIfFragmented, "", packets, analyzerBuilders, nullptr, invoke);
     }
 
     // Zeek default mapping tests
     if (std::string(argv[2]).find("zeek") != std::string::npos) {
-        runAnalysis(GeneratedSwitchZeek, packets, analyzerBuilders);
-        runAnalysis(GeneratedIfZeek, packets, analyzerBuilders);
+        runAnalysis(GeneratedSwitchZeek, "", packets, analyzerBuilders, nullptr, invoke);
+        runAnalysis(GeneratedIfZeek, "", packets, analyzerBuilders, nullptr, invoke);
+    }
+
+    // Arena placed analyzers
+    if (useArena) {
+        runAnalysis(Array, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        runAnalysis(Vector, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        runAnalysis(TreeMap, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        runAnalysis(UnorderedMap, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        if (!simulate) {
+            runAnalysis(Cuckoo, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        }
+        runAnalysis(Hanov, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        runAnalysis(Universal, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
+        runAnalysis(SparseUpper, "+arena", packets, arenaAnalyzerBuilders, &arena, invoke);
     }
 }
@@ -5,7 +5,7 @@ TreeMap::~TreeMap() {
 }
 
 bool TreeMap::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
-    return table.emplace(identifier, make_analyzer()).second;
+    return table.emplace(identifier, buildAnalyzer(make_analyzer)).second;
 }
 
 IAnalyzer * TreeMap::lookup(identifier_t identifier) {
@@ -16,6 +16,15 @@ IAnalyzer * TreeMap::lookup(identifier_t identifier) {
     }
 }
 
+// Like lookup(), count() and at() of a registered identifier each search the tree
+IAnalyzer *TreeMap::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    auto found = traceBound(table, identifier, trace);
+    if (found == table.end() || found->first != identifier) {
+        return nullptr;
+    }
+    return traceBound(table, identifier, trace)->second;
+}
+
 size_t TreeMap::size() {
     return table.size();
 }
@@ -33,7 +42,7 @@ void TreeMap::stringifyAnalyzersState(std::ostream &os) const {
 
 void TreeMap::freeAnalyzers() {
     for (auto &current : table) {
-        delete current.second;
+        freeAnalyzer(current.second);
         current.second = nullptr;
     }
 }
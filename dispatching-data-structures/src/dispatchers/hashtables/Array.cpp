@@ -12,7 +12,8 @@ Array::~Array() {
 
 bool Array::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     if (table[identifier] == nullptr) {
-        table[identifier] = make_analyzer();
+        table[identifier] = buildAnalyzer(make_analyzer);
+        kinds[identifier] = AnalyzerRef::kindOf(table[identifier]);
         return true;
     }
     return false;
@@ -25,6 +26,11 @@ IAnalyzer * Array::lookup(identifier_t identifier) {
     return nullptr;
 }
 
+// Empty slots hold nullptr, so the slot is the result
+IAnalyzer *Array::lookupBranchless(identifier_t identifier) {
+    return table[identifier];
+}
+
 size_t Array::size() {
     size_t result = 0;
     for (const auto& current : table) {
@@ -51,7 +57,7 @@ void Array::stringifyAnalyzersState(std::ostream &os) const {
 
 void Array::freeAnalyzers() {
     for (auto &current : table) {
-        delete current;
+        freeAnalyzer(current);
         current = nullptr;
     }
 }
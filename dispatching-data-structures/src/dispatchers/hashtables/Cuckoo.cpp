@@ -1,18 +1,24 @@
 #include "dispatchers/hashtables/Cuckoo.h"
 #include "cuckoo_hash.h"
 
+#include <stdexcept>
+
 Cuckoo::Cuckoo() {
     cuckoo_hash_init(&table, 1);
 }
 
 Cuckoo::~Cuckoo() {
     freeAnalyzers();
+    freeKeys();
     cuckoo_hash_destroy(&table);
 }
 
 bool Cuckoo::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     keys.push_back(std::make_unique<identifier_t>(identifier));
-    return cuckoo_hash_insert(&table, keys[keys.size() - 1].get(), sizeof(identifier), make_analyzer()) == nullptr;
+    if (tracker != nullptr) {
+        tracker->allocate(MemoryCategory::METADATA, keys.back().get(), sizeof(identifier_t));
+    }
+    return cuckoo_hash_insert(&table, keys[keys.size() - 1].get(), sizeof(identifier), buildAnalyzer(make_analyzer)) == nullptr;
 }
 
 IAnalyzer * Cuckoo::lookup(identifier_t identifier) {
@@ -24,6 +30,14 @@ IAnalyzer * Cuckoo::lookup(identifier_t identifier) {
     }
 }
 
+/**
+ * Not supported: the library computes its hashes internally (the bins of a miss depend on them) and does not expose
+ * them, so the loads of a lookup cannot be reconstructed exactly. cache_analyzer leaves Cuckoo out of simulate.
+ */
+IAnalyzer *Cuckoo::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    throw std::runtime_error("Cuckoo cannot trace its lookups, the hash function of the library is internal");
+}
+
 size_t Cuckoo::size() {
     return cuckoo_hash_count(&table);
 }
@@ -31,6 +45,7 @@ size_t Cuckoo::size() {
 
 void Cuckoo::clear() {
     freeAnalyzers();
+    freeKeys();
 }
 
 
@@ -44,11 +59,26 @@ void Cuckoo::stringifyAnalyzersState(std::ostream &os) const {
 void Cuckoo::freeAnalyzers() {
     cuckoo_hash_item* current = nullptr;
     for (cuckoo_hash_each(current, &table)) {
-        delete static_cast<IAnalyzer*>(current->value);
+        freeAnalyzer(static_cast<IAnalyzer*>(current->value));
         cuckoo_hash_remove(&table, current);
     }
 }
 
+void Cuckoo::freeKeys() {
+    if (tracker != nullptr) {
+        for (const auto &key : keys) {
+            tracker->deallocate(key.get());
+        }
+    }
+    keys.clear();
+}
+
+std::vector<MemoryRegion> Cuckoo::inlineRegions() const {
+    // The table of the library is a single calloc of all bins
+    size_t slots = (1u << table.power) * table.bin_size;
+    return {MemoryRegion{MemoryCategory::TABLE, table.table, slots * sizeof(*table.table), true}};
+}
+
 size_t Cuckoo::real_size() {
     return (1u << table.power) * table.bin_size * (sizeof(cuckoo_hash_item) + 8);
 }
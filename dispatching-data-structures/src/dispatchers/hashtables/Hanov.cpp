@@ -3,35 +3,35 @@
 #include "analyzers/All.h"
 #include "dispatchers/hashtables/Hanov.h"
 
-Hanov::~Hanov() {
+template<class Layout>
+BasicHanov<Layout>::~BasicHanov() {
     freeAnalyzers();
 }
 
-bool Hanov::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
+template<class Layout>
+bool BasicHanov<Layout>::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     // Analyzer already registered
     if (lookup(identifier) != nullptr) {
         return false;
     }
 
     // Merge new analyzer with existing ones and rehash
+    // Dummy elements have no analyzer and are not copied over
     std::unordered_map<identifier_t, IAnalyzer*> newAnalyzerList;
-    for (auto &&current : values) {
-        // Do not copy over dummy elements
-        if (current.second != nullptr) {
-            newAnalyzerList.emplace(std::move(current));
-        }
-    }
-    // values now contains empty analyzer pointers, do not use until after createMPH ran!
+    table.forEach([&newAnalyzerList](identifier_t key, IAnalyzer *analyzer) {
+        newAnalyzerList.emplace(key, analyzer);
+    });
 
     // Will definitely insert a new one because we checked if the identifier already exists in the hashtable
     // Also, we need to use [] to overwrite existing dummy elements
-    newAnalyzerList[identifier] = make_analyzer();
+    newAnalyzerList[identifier] = buildAnalyzer(make_analyzer);
 
     createMPH(std::move(newAnalyzerList));
     return true;
 }
 
-void Hanov::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
+template<class Layout>
+void BasicHanov<Layout>::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
     // Analyzer already registered
     for (const auto &current : analyzer_builders) {
         if (lookup(current.first) != nullptr) {
@@ -39,57 +39,73 @@ void Hanov::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &an
         }
     }
 
+    // The layout holds a limited number of analyzers, fail before any of them is built
+    if (size() + analyzer_builders.size() > Layout::MAX_ANALYZERS) {
+        throw std::invalid_argument("The slot layout holds at most " + std::to_string(Layout::MAX_ANALYZERS) +
+                                    " analyzers.");
+    }
+
     // Merge new analyzer with existing ones and rehash
+    // Dummy elements have no analyzer and are not copied over
     std::unordered_map<identifier_t, IAnalyzer*> newAnalyzerList;
-    for (auto &&current : values) {
-        // Do not copy over dummy elements
-        if (current.second != nullptr) {
-            newAnalyzerList.emplace(std::move(current));
-        }
-    }
-    // values now contains empty analyzer pointers, do not use until after createMPH ran!
+    table.forEach([&newAnalyzerList](identifier_t key, IAnalyzer *analyzer) {
+        newAnalyzerList.emplace(key, analyzer);
+    });
 
     // Will definitely insert a new one because we checked if the identifier already exists in the hashtable
     // Also, we need to use [] to overwrite existing dummy elements
     for (auto &current : analyzer_builders) {
-        newAnalyzerList[current.first] = current.second();
+        newAnalyzerList[current.first] = buildAnalyzer(current.second);
     }
 
     createMPH(std::move(newAnalyzerList));
 }
 
 
-IAnalyzer * Hanov::lookup(identifier_t identifier) {
+template<class Layout>
+IAnalyzer * BasicHanov<Layout>::lookup(identifier_t identifier) {
     if (empty) {
         return nullptr;
     }
 
     // No .at() needed because it automatically gets modded into range
     uint32_t d = intermediate[hash(first_d, identifier) % _size];
-    const Value &result = values[hash(d, identifier) % _size];
+    return table.find(hash(d, identifier) % _size, identifier);
+}
 
-    return result.first == identifier ? result.second : nullptr;
+template<class Layout>
+IAnalyzer *BasicHanov<Layout>::lookupBranchless(identifier_t identifier) {
+    // Only empty before the first registration, this branch does not depend on the identifier
+    if (empty) {
+        return nullptr;
+    }
+
+    uint32_t d = intermediate[hash(first_d, identifier) % _size];
+    return table.findBranchless(hash(d, identifier) % _size, identifier);
 }
 
-size_t Hanov::size() {
+template<class Layout>
+size_t BasicHanov<Layout>::size() {
     return _size;
 }
 
-void Hanov::clear() {
+template<class Layout>
+void BasicHanov<Layout>::clear() {
     // Free analyzers
     freeAnalyzers();
 
     empty = true;
     first_d = 0;
     intermediate.clear();
-    values.clear();
+    table.assign(0);
 }
 
 //*********************************
 //*********** PRIVATE *************
 //*********************************
 
-void Hanov::createMPH(std::unordered_map<identifier_t, IAnalyzer*> &&analyzers) {
+template<class Layout>
+void BasicHanov<Layout>::createMPH(std::unordered_map<identifier_t, IAnalyzer*> &&analyzers) {
     size_t numAnalyzers = analyzers.size();
     if (numAnalyzers == 0) {
         throw std::invalid_argument("No analyzers given.");
@@ -106,10 +122,10 @@ void Hanov::createMPH(std::unordered_map<identifier_t, IAnalyzer*> &&analyzers)
     }
 
     // Initialize intermediate with N zeros
-    intermediate = std::vector<uint32_t>(numAnalyzers);
+    intermediate.assign(numAnalyzers, 0);
 
-    // Initialize values with N nullptr
-    values = std::vector<Value>(numAnalyzers);
+    // Initialize values with N nullptr, they are copied to the table once all keys are placed
+    std::vector<Value> values(numAnalyzers, Value());
 
     // Places keys into buckets according to hash table
     for (const auto &current : analyzers) {
@@ -216,41 +232,41 @@ void Hanov::createMPH(std::unordered_map<identifier_t, IAnalyzer*> &&analyzers)
         }
     }
 
+    table.assign(values);
     _size = values.size();
     empty = false;
 }
 
-void Hanov::stringifyAnalyzersState(std::ostream &os) const {
-    for (size_t i = 0; i < values.size(); i++) {
-        // Skip dummy keys
-        if (values[i].second == nullptr) {
-            continue;
+template<class Layout>
+void BasicHanov<Layout>::stringifyAnalyzersState(std::ostream &os) const {
+    // Skips dummy keys
+    bool first = true;
+    table.forEach([&os, &first](identifier_t key, IAnalyzer *analyzer) {
+        if (!first) {
+            os << "\n";
         }
+        first = false;
 
         os << "[KEY ";
-        PRINT_UINT_HEX(os, values[i].first, 8);
+        PRINT_UINT_HEX(os, key, 8);
         os << "] ";
-        os << *values[i].second;
-        if (i != values.size() - 1) {
-            os << "\n";
-        }
-    }
+        os << *analyzer;
+    });
 }
 
-void Hanov::freeAnalyzers() {
-    for (auto &current : values) {
-        delete current.second;
-        current.second = nullptr;
-    }
+template<class Layout>
+void BasicHanov<Layout>::freeAnalyzers() {
+    table.release([this](IAnalyzer *analyzer) {
+        freeAnalyzer(analyzer);
+    });
 }
 
-size_t Hanov::real_size() {
-    // Ignore dummies
-    size_t counter = 0;
-    for (const auto& current : values) {
-//        if (current.second != nullptr) {
-        counter += 4 + 2 + 8; // 4 byte intermediate + the "Value" of 2 byte id and 8 byte analyzer pointer
-//        }
-    }
-    return counter;
+template<class Layout>
+size_t BasicHanov<Layout>::real_size() {
+    // 4 byte intermediate per slot + the slots, e.g. the "Value" of 2 byte id and 8 byte analyzer pointer
+    return table.size() * 4 + table.realSize();
 }
+
+template class BasicHanov<PairSlots>;
+template class BasicHanov<SplitSlots>;
+template class BasicHanov<PackedSlots>;
@@ -38,7 +38,7 @@ bool Sparse::registerAnalyzer(identifier_t identifier, const analyzer_builder &m
         } else {
             // Gap is small enough, resize and add
             table.resize(identifier - lowerBound + 1, nullptr);
-            table[identifier - lowerBound] = make_analyzer();
+            table[identifier - lowerBound] = buildAnalyzer(make_analyzer);
 
             // Merge fragments if the gap between them got too small now.
             // Only compress if the current fragment isn't the last one (std::next is invalid, i.e. end(), in this case).
@@ -52,7 +52,7 @@ bool Sparse::registerAnalyzer(identifier_t identifier, const analyzer_builder &m
         return false;
     } else {
         // There is already a "hole" in a fragment, insert it there
-        table[identifier - lowerBound] = make_analyzer();
+        table[identifier - lowerBound] = buildAnalyzer(make_analyzer);
 
         // Merge fragments if the gap between them got too small now
         compress(ptr, std::next(ptr));
@@ -74,6 +74,20 @@ IAnalyzer * Sparse::lookup(identifier_t identifier) {
     return table[identifier - lowerBound];
 }
 
+// The step back from the upper bound is recorded as one load of the node it ends on, the fragment follows
+IAnalyzer *Sparse::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    auto ptr = std::prev(traceBound(map, identifier, trace, true));
+    trace.load(&ptr->first, sizeof(ptr->first), trace.nextDepth());
+    identifier_t lowerBound = ptr->first;
+    const table_t &table = ptr->second;
+
+    if (identifier < lowerBound || identifier >= lowerBound + table.size()) {
+        return nullptr;
+    }
+    trace.load(&table[identifier - lowerBound], sizeof(IAnalyzer *), trace.nextDepth());
+    return table[identifier - lowerBound];
+}
+
 size_t Sparse::size() {
     size_t size = 0;
     for (const auto &fragment : map) {
@@ -125,7 +139,7 @@ void Sparse::stringifyAnalyzersState(std::ostream &os) const {
 void Sparse::freeAnalyzers() {
     for (auto &fragment : map) {
         for (auto &current : fragment.second) {
-            delete current;
+            freeAnalyzer(current);
             current = nullptr;
         }
     }
@@ -35,7 +35,7 @@ bool SparseUpper::registerAnalyzer(identifier_t identifier, const analyzer_build
         } else {
             // Gap is small enough, resize and add
             table.resize(upperBound - identifier + 1, nullptr);
-            table[upperBound - identifier] = make_analyzer();
+            table[upperBound - identifier] = buildAnalyzer(make_analyzer);
 
             // Merge fragments if the gap between them got too small now
             // Only compress if the current fragment isn't the first one (std::prev is invalid in this case).
@@ -49,7 +49,7 @@ bool SparseUpper::registerAnalyzer(identifier_t identifier, const analyzer_build
         return false;
     } else {
         // There is already a "hole" in a fragment, insert it there
-        table[upperBound - identifier] = make_analyzer();
+        table[upperBound - identifier] = buildAnalyzer(make_analyzer);
 
         // Merge fragments if the gap between them got too small now
         compress(std::prev(ptr), ptr);
@@ -76,6 +76,35 @@ IAnalyzer * SparseUpper::lookup(identifier_t identifier) {
     return table[upperBound - identifier];
 }
 
+IAnalyzer *SparseUpper::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    auto ptr = traceBound(map, identifier, trace);
+    if (ptr == map.end()) {
+        return nullptr;
+    }
+    identifier_t upperBound = ptr->first;
+    const table_t &table = ptr->second;
+
+    if (identifier < upperBound - table.size() + 1) {
+        return nullptr;
+    }
+    trace.load(&table[upperBound - identifier], sizeof(IAnalyzer *), trace.nextDepth());
+    return table[upperBound - identifier];
+}
+
+// The search for the fragment stays a tree walk, only the bound check of the fragment is masked
+IAnalyzer *SparseUpper::lookupBranchless(identifier_t identifier) {
+    auto ptr = map.lower_bound(identifier);
+    if (ptr == map.end()) {
+        return nullptr;
+    }
+    const table_t &table = ptr->second;
+
+    // The fragment ends at its upper bound, identifiers below its lower bound read the first slot and are masked
+    uint64_t index = ptr->first - identifier;
+    bool inRange = index < table.size();
+    return maskAnalyzer(inRange, table[index & -static_cast<uint64_t>(inRange)]);
+}
+
 void SparseUpper::stringifyAnalyzersState(std::ostream &os) const {
 #if DEBUG
     int64_t prevUpper = -1;
@@ -1,9 +1,10 @@
 #include "dispatchers/hashtables/Universal.h"
 
-Universal::Universal() : a(0), b(0), wMinusM(0), generator(rd()) {
+template<class Layout>
+BasicUniversal<Layout>::BasicUniversal() : a(0), b(0), wMinusM(0), generator(rd()) {
     setBins(2);
 
-    table = std::vector<Value>(ONE << M, Value(0, nullptr));
+    table.assign(ONE << M);
 
     // Initialize random engine
     distributionA = std::uniform_int_distribution<uint64_t>(1, ~static_cast<uint64_t>(0));
@@ -20,7 +21,8 @@ Universal::Universal() : a(0), b(0), wMinusM(0), generator(rd()) {
     #endif
 }
 
-Universal::~Universal() {
+template<class Layout>
+BasicUniversal<Layout>::~BasicUniversal() {
     freeAnalyzers();
 
     #if DEBUG > 1
@@ -30,22 +32,23 @@ Universal::~Universal() {
     #endif
 }
 
-bool Universal::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
+template<class Layout>
+bool BasicUniversal<Layout>::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     #if DEBUG > 1
     std::shared_ptr<void> deferred(nullptr, [=](...){ std::cout << "Inserted " << identifier << std::endl; });
     #endif
 
     uint64_t hashedID = hash(identifier);
-    if (table[hashedID].second == nullptr) {
+    if (table.analyzer(hashedID) == nullptr) {
         // Free bin, insert the value
-        table[hashedID] = Value(identifier, make_analyzer());
+        table.set(hashedID, identifier, buildAnalyzer(make_analyzer));
         return true;
-    } else if (table[hashedID].first != identifier) {
+    } else if (table.key(hashedID) != identifier) {
         // The bin is not empty, but the content isn't the to-be-inserted identifier --> resolve collision
 
         // Create intermediate representation with the new element in it, then rehash with that data
         std::vector<Value> intermediate = createIntermediate();
-        intermediate.emplace_back(identifier, make_analyzer());
+        intermediate.emplace_back(identifier, buildAnalyzer(make_analyzer));
 
         // Try increasing the #bins until it works or it can't get any larger.
         rehash(intermediate);
@@ -56,72 +59,82 @@ bool Universal::registerAnalyzer(identifier_t identifier, const analyzer_builder
     return false;
 }
 
-void Universal::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
+template<class Layout>
+void BasicUniversal<Layout>::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
     // Analyzer already registered
     for (const auto &current : analyzer_builders) {
-        if (table[hash(current.first)].second != nullptr) {
+        if (table.analyzer(hash(current.first)) != nullptr) {
             throw std::invalid_argument("Analyzer " + std::to_string(current.first) + " already registered!");
         }
     }
 
+    // The layout holds a limited number of analyzers, fail before any of them is built
+    if (size() + analyzer_builders.size() > Layout::MAX_ANALYZERS) {
+        throw std::invalid_argument("The slot layout holds at most " + std::to_string(Layout::MAX_ANALYZERS) +
+                                    " analyzers.");
+    }
+
     // Create intermediate representation of current analyzer set, then add all new ones
     std::vector<Value> intermediate = createIntermediate();
     for (const auto& current : analyzer_builders) {
-        intermediate.emplace_back(current.first, current.second());
+        intermediate.emplace_back(current.first, buildAnalyzer(current.second));
     }
 
     rehash(intermediate);
 }
 
-IAnalyzer * Universal::lookup(identifier_t identifier) {
+template<class Layout>
+IAnalyzer * BasicUniversal<Layout>::lookup(identifier_t identifier) {
     uint64_t hashedID = hash(identifier);
 
     // The hashedID can't be larger than the number of bins
     assert(hashedID < table.size() && "Hashed ID is outside of the hash table range!");
 
-    Value entry = table[hashedID];
-
     #if DEBUG > 1
     std::cout << identifier << " -> " << hashedID << std::endl;
-    if (entry.second == nullptr) {
+    if (table.analyzer(hashedID) == nullptr) {
         nptrCounter++;
-    } else if (entry.first != identifier) {
+    } else if (table.key(hashedID) != identifier) {
         mismatchCounter++;
     }
     allCounter++;
     #endif
 
-    if (entry.second != nullptr && entry.first == identifier) {
-        return entry.second;
-    }
-    return nullptr;
+    return table.find(hashedID, identifier);
+}
 
+// Empty buckets hold nullptr, so only the key has to match
+template<class Layout>
+IAnalyzer *BasicUniversal<Layout>::lookupBranchless(identifier_t identifier) {
+    return table.findBranchless(hash(identifier), identifier);
 }
 
-size_t Universal::size() {
+template<class Layout>
+size_t BasicUniversal<Layout>::size() {
     size_t result = 0;
-    for (const auto& current : table) {
-        if (current.second != nullptr) {
-            result++;
-        }
-    }
+    table.forEach([&result](identifier_t, IAnalyzer *) {
+        result++;
+    });
     return result;
 }
 
-void Universal::clear() {
+template<class Layout>
+void BasicUniversal<Layout>::clear() {
     // Free all analyzers
     freeAnalyzers();
 
     setBins(2);
-    table = std::vector<Value>(ONE << M, Value(0, nullptr));
+    table.assign(ONE << M);
     randomizeAB();
 }
 
-size_t Universal::bucketCount() {
+template<class Layout>
+size_t BasicUniversal<Layout>::bucketCount() {
     return table.size();
 }
 
-void Universal::rehash() {
+template<class Layout>
+void BasicUniversal<Layout>::rehash() {
     // Intermediate representation is just the current table without nulls
     rehash(createIntermediate());
 }
@@ -130,22 +143,22 @@ void Universal::rehash() {
 // ####### PRIVATE #######
 // #######################
 
-void Universal::stringifyAnalyzersState(std::ostream &os) const {
-    for (const auto &current : table) {
-        if (current.second != nullptr) {
-            os << *current.second << "\n";
-        }
-    }
+template<class Layout>
+void BasicUniversal<Layout>::stringifyAnalyzersState(std::ostream &os) const {
+    table.forEach([&os](identifier_t, IAnalyzer *analyzer) {
+        os << *analyzer << "\n";
+    });
 }
 
-void Universal::freeAnalyzers() {
-    for (auto& current : table) {
-        delete current.second;
-        current.second = nullptr;
-    }
+template<class Layout>
+void BasicUniversal<Layout>::freeAnalyzers() {
+    table.release([this](IAnalyzer *analyzer) {
+        freeAnalyzer(analyzer);
+    });
 }
 
-void Universal::rehash(const std::vector<Value>& intermediate) {
+template<class Layout>
+void BasicUniversal<Layout>::rehash(const std::vector<Value>& intermediate) {
     while (!findCollisionFreeHashFunction(intermediate)) {
         #if DEBUG > 0
         std::cout << "Rehashing did not work. Increasing #bins to " << (uint64_t) std::pow(2, M + 1) << " (" << M + 1 << "bit)." << std::endl;
@@ -155,7 +168,8 @@ void Universal::rehash(const std::vector<Value>& intermediate) {
     }
 }
 
-bool Universal::findCollisionFreeHashFunction(const std::vector<Value>& intermediate) {
+template<class Layout>
+bool BasicUniversal<Layout>::findCollisionFreeHashFunction(const std::vector<Value>& intermediate) {
     // Don't even try if the number of values is larger than the number of buckets
     if (ONE << M < intermediate.size()) {
         return false;
@@ -202,7 +216,7 @@ bool Universal::findCollisionFreeHashFunction(const std::vector<Value>& intermed
             #if DEBUG > 0
             std::cout << "Took " << i << " rehash(es) to resolve." << std::endl;
             #endif
-            table = newTable;
+            table.assign(newTable);
             return true;
         }
     }
@@ -213,7 +227,12 @@ bool Universal::findCollisionFreeHashFunction(const std::vector<Value>& intermed
     return false;
 }
 
-size_t Universal::real_size() {
-    // every value has 2 byte id + 8 byte analyzer pointer
-    return table.size() * 10;
+template<class Layout>
+size_t BasicUniversal<Layout>::real_size() {
+    // every value has 2 byte id + 8 byte analyzer pointer, the packed layout 4 byte per slot + 8 byte per analyzer
+    return table.realSize();
 }
+
+template class BasicUniversal<PairSlots>;
+template class BasicUniversal<SplitSlots>;
+template class BasicUniversal<PackedSlots>;
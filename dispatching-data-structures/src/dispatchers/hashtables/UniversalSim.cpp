@@ -1,9 +1,10 @@
 #include "dispatchers/hashtables/UniversalSim.h"
 
-UniversalSim::UniversalSim() : a(0), b(0), wMinusM(0), generator(rd()) {
+template<class Layout>
+BasicUniversalSim<Layout>::BasicUniversalSim() : a(0), b(0), wMinusM(0), generator(rd()) {
     setBins(2);
 
-    table = std::vector<Value>(ONE << M, Value(0, nullptr));
+    table.assign(ONE << M);
 
     // Initialize random engine
     distributionA = std::uniform_int_distribution<uint64_t>(1, static_cast<word_t>(~static_cast<word_t>(0)));
@@ -23,7 +24,8 @@ UniversalSim::UniversalSim() : a(0), b(0), wMinusM(0), generator(rd()) {
     didntWork = 0;
 }
 
-UniversalSim::~UniversalSim() {
+template<class Layout>
+BasicUniversalSim<Layout>::~BasicUniversalSim() {
     freeAnalyzers();
 
     #if DEBUG > 0
@@ -33,22 +35,23 @@ UniversalSim::~UniversalSim() {
     #endif
 }
 
-bool UniversalSim::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
+template<class Layout>
+bool BasicUniversalSim<Layout>::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     #if DEBUG > 1
     std::shared_ptr<void> deferred(nullptr, [=](...){ std::cout << "Inserted " << identifier << std::endl; });
     #endif
 
     uint64_t hashedID = hash(identifier);
-    if (table[hashedID].second == nullptr) {
+    if (table.analyzer(hashedID) == nullptr) {
         // Free bin, insert the value
-        table[hashedID] = Value(identifier, make_analyzer());
+        table.set(hashedID, identifier, buildAnalyzer(make_analyzer));
         return true;
-    } else if (table[hashedID].first != identifier) {
+    } else if (table.key(hashedID) != identifier) {
         // The bin is not empty, but the content isn't the to-be-inserted identifier --> resolve collision
 
         // Create intermediate representation with the new element in it, then rehash with that data
         std::vector<Value> intermediate = createIntermediate();
-        intermediate.emplace_back(identifier, make_analyzer());
+        intermediate.emplace_back(identifier, buildAnalyzer(make_analyzer));
 
         // Try increasing the #bins until it works or it can't get any larger.
         rehash(intermediate);
@@ -59,70 +62,80 @@ bool UniversalSim::registerAnalyzer(identifier_t identifier, const analyzer_buil
     return false;
 }
 
-void UniversalSim::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
+template<class Layout>
+void BasicUniversalSim<Layout>::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
     // Analyzer already registered
     for (const auto &current : analyzer_builders) {
-        if (table[hash(current.first)].second != nullptr) {
+        if (table.analyzer(hash(current.first)) != nullptr) {
             throw std::invalid_argument("Analyzer " + std::to_string(current.first) + " already registered!");
         }
     }
 
+    // The layout holds a limited number of analyzers, fail before any of them is built
+    if (size() + analyzer_builders.size() > Layout::MAX_ANALYZERS) {
+        throw std::invalid_argument("The slot layout holds at most " + std::to_string(Layout::MAX_ANALYZERS) +
+                                    " analyzers.");
+    }
+
     // Create intermediate representation of current analyzer set, then add all new ones
     std::vector<Value> intermediate = createIntermediate();
     for (const auto& current : analyzer_builders) {
-        intermediate.emplace_back(current.first, current.second());
+        intermediate.emplace_back(current.first, buildAnalyzer(current.second));
     }
 
     rehash(intermediate);
 }
 
-IAnalyzer * UniversalSim::lookup(identifier_t identifier) {
+template<class Layout>
+IAnalyzer * BasicUniversalSim<Layout>::lookup(identifier_t identifier) {
     uint64_t hashedID = hash(identifier);
 
     // The hashedID can't be larger than the number of bins
     assert(hashedID < table.size() && "Hashed ID is outside of the hash table range!");
 
-    Value entry = table[hashedID];
-
     #if DEBUG > 0
-    if (entry.second == nullptr) {
+    if (table.analyzer(hashedID) == nullptr) {
         nptrCounter++;
-    } else if (entry.first != identifier) {
+    } else if (table.key(hashedID) != identifier) {
         mismatchCounter++;
     }
     allCounter++;
     #endif
 
-    if (entry.second != nullptr && entry.first == identifier) {
-        return entry.second;
-    }
-    return nullptr;
+    return table.find(hashedID, identifier);
+}
+
+template<class Layout>
+IAnalyzer *BasicUniversalSim<Layout>::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    return table.trace(hash(identifier), identifier, trace, 0);
 }
 
-size_t UniversalSim::size() {
+template<class Layout>
+size_t BasicUniversalSim<Layout>::size() {
     size_t result = 0;
-    for (const auto& current : table) {
-        if (current.second != nullptr) {
-            result++;
-        }
-    }
+    table.forEach([&result](identifier_t, IAnalyzer *) {
+        result++;
+    });
     return result;
 }
 
-void UniversalSim::clear() {
+template<class Layout>
+void BasicUniversalSim<Layout>::clear() {
     // Clear analyzer pointers
     freeAnalyzers();
 
     setBins(2);
-    table = std::vector<Value>(ONE << M, Value(0, nullptr));
+    table.assign(ONE << M);
     randomizeAB();
 }
 
-size_t UniversalSim::bucketCount() {
+template<class Layout>
+size_t BasicUniversalSim<Layout>::bucketCount() {
     return table.size();
 }
 
-void UniversalSim::rehash() {
+template<class Layout>
+void BasicUniversalSim<Layout>::rehash() {
     // Intermediate representation is just the current table without nulls
     rehash(createIntermediate());
 }
@@ -131,22 +144,22 @@ void UniversalSim::rehash() {
 // ####### PRIVATE #######
 // #######################
 
-void UniversalSim::stringifyAnalyzersState(std::ostream &os) const {
-    for (const auto &current : table) {
-        if (current.second != nullptr) {
-            os << *current.second << "\n";
-        }
-    }
+template<class Layout>
+void BasicUniversalSim<Layout>::stringifyAnalyzersState(std::ostream &os) const {
+    table.forEach([&os](identifier_t, IAnalyzer *analyzer) {
+        os << *analyzer << "\n";
+    });
 }
 
-void UniversalSim::freeAnalyzers() {
-    for (auto& current : table) {
-        delete current.second;
-        current.second = nullptr;
-    }
+template<class Layout>
+void BasicUniversalSim<Layout>::freeAnalyzers() {
+    table.release([this](IAnalyzer *analyzer) {
+        freeAnalyzer(analyzer);
+    });
 }
 
-void UniversalSim::rehash(const std::vector<Value>& intermediate) {
+template<class Layout>
+void BasicUniversalSim<Layout>::rehash(const std::vector<Value>& intermediate) {
     while (!findCollisionFreeHashFunction(intermediate)) {
         #if DEBUG > 0
         std::cout << "Rehashing did not work. Increasing #bins to " << static_cast<uint64_t>(std::pow(2, M + 1));
@@ -157,7 +170,8 @@ void UniversalSim::rehash(const std::vector<Value>& intermediate) {
     }
 }
 
-bool UniversalSim::findCollisionFreeHashFunction(const std::vector<Value>& intermediate) {
+template<class Layout>
+bool BasicUniversalSim<Layout>::findCollisionFreeHashFunction(const std::vector<Value>& intermediate) {
     // Don't even try if the number of values is larger than the number of buckets
     if (ONE << M < intermediate.size()) {
         return false;
@@ -207,7 +221,7 @@ bool UniversalSim::findCollisionFreeHashFunction(const std::vector<Value>& inter
 
         // Step 4: If the inserting finished without collisions, overwrite the previous table and exit
         if (finished) {
-            table = newTable;
+            table.assign(newTable);
             worked++;
         } else {
             didntWork++;
@@ -224,6 +238,11 @@ bool UniversalSim::findCollisionFreeHashFunction(const std::vector<Value>& inter
     return false;
 }
 
-size_t UniversalSim::real_size() {
+template<class Layout>
+size_t BasicUniversalSim<Layout>::real_size() {
     return table.size() * 2;
 }
+
+template class BasicUniversalSim<PairSlots>;
+template class BasicUniversalSim<SplitSlots>;
+template class BasicUniversalSim<PackedSlots>;
@@ -5,7 +5,7 @@ UnorderedMap::~UnorderedMap() {
 }
 
 bool UnorderedMap::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
-    if(!table.emplace(identifier, make_analyzer()).second) {
+    if(!table.emplace(identifier, buildAnalyzer(make_analyzer)).second) {
         return false;
     }
 
@@ -31,7 +31,7 @@ bool UnorderedMap::registerAnalyzer(identifier_t identifier, const analyzer_buil
 
 void UnorderedMap::registerAnalyzers(const std::map<identifier_t, analyzer_builder> &analyzer_builders) {
     for (auto &current : analyzer_builders) {
-        if (!table.emplace(current.first, current.second()).second) {
+        if (!table.emplace(current.first, buildAnalyzer(current.second)).second) {
             throw std::invalid_argument("Analyzer already registered!");
         }
 
@@ -62,6 +62,28 @@ IAnalyzer* UnorderedMap::lookup(identifier_t identifier) {
     }
 }
 
+// Like lookup(), count() and at() of a registered identifier each walk the bucket. The bucket array is the table the
+// tracking allocator recorded, so it is only traced with tracking enabled. A single bucket lives in the map object.
+IAnalyzer *UnorderedMap::traceLookup(identifier_t identifier, LookupTrace &trace) {
+    const MemoryRegion *buckets = memoryTracker.find(MemoryCategory::TABLE);
+    size_t bucket = table.bucket(identifier);
+    IAnalyzer *result = nullptr;
+    for (size_t walk = 0; walk < 2 && (walk == 0 || result != nullptr); walk++) {
+        uint32_t depth = 0;
+        if (buckets != nullptr) {
+            trace.load(static_cast<const char *>(buckets->address) + bucket * sizeof(void *), sizeof(void *), depth++);
+        }
+        for (auto node = table.cbegin(bucket); node != table.cend(bucket); ++node) {
+            trace.load(&*node, sizeof(*node), depth++);
+            if (node->first == identifier) {
+                result = node->second;
+                break;
+            }
+        }
+    }
+    return result;
+}
+
 size_t UnorderedMap::size() {
     return table.size();
 }
@@ -79,7 +101,7 @@ void UnorderedMap::stringifyAnalyzersState(std::ostream &os) const {
 
 void UnorderedMap::freeAnalyzers() {
     for (auto &current : table) {
-        delete current.second;
+        freeAnalyzer(current.second);
         current.second = nullptr;
     }
 }
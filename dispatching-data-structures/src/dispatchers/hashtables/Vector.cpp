@@ -7,7 +7,8 @@ Vector::~Vector() {
 bool Vector::registerAnalyzer(identifier_t identifier, const analyzer_builder &make_analyzer) {
     // If the table has size 1 and the entry is nullptr, there was nothing added yet. Just add it.
     if (table.size() == 1 && table[0] == nullptr) {
-        table[0] = make_analyzer();
+        table[0] = buildAnalyzer(make_analyzer);
+        kinds[0] = AnalyzerRef::kindOf(table[0]);
         lowestIdentifier = identifier;
         return true;
     }
@@ -15,16 +16,19 @@ bool Vector::registerAnalyzer(identifier_t identifier, const analyzer_builder &m
     // If highestIdentifier == identifier, overwrite would happen -> no check needed, will return false
     if (getHighestIdentifier() < identifier) {
         table.resize(table.size() + (identifier - getHighestIdentifier()), nullptr);
+        kinds.resize(table.size(), AnalyzerKind::UNKNOWN);
     } else if (identifier < lowestIdentifier) {
         // Lower than the lowest registered identifier. Shift up by lowerBound - identifier
         identifier_t distance = lowestIdentifier - identifier;
         table.resize(table.size() + distance, nullptr);
+        kinds.resize(table.size(), AnalyzerKind::UNKNOWN);
 
         // Shift values
         for (ssize_t i = table.size() - 1; i >= 0; i--) {
             if (table[i] != nullptr) {
                 table.at(i + distance) = table.at(i);
                 table.at(i) = nullptr;
+                kinds.at(i + distance) = kinds.at(i);
             }
         }
 
@@ -33,7 +37,8 @@ bool Vector::registerAnalyzer(identifier_t identifier, const analyzer_builder &m
 
     int64_t index = identifier - lowestIdentifier;
     if (table[index] == nullptr) {
-        table[index] = make_analyzer();
+        table[index] = buildAnalyzer(make_analyzer);
+        kinds[index] = AnalyzerRef::kindOf(table[index]);
         return true;
     }
     return false;
@@ -70,6 +75,23 @@ IAnalyzer * Vector::lookup(identifier_t identifier) {
     }
 }
 
+IAnalyzer *Vector::lookupBranchless(identifier_t identifier) {
+    // Identifiers below the table wrap around to large indices, so one comparison checks both bounds. Out of range
+    // identifiers read the first slot instead and mask the result.
+    uint64_t index = static_cast<uint64_t>(identifier) - lowestIdentifier;
+    bool inRange = index < table.size();
+    return maskAnalyzer(inRange, table[index & -static_cast<uint64_t>(inRange)]);
+}
+
+// Same checks as lookup(), the tag comes from the parallel table
+AnalyzerRef Vector::lookupRef(identifier_t identifier) {
+    int64_t index = identifier - lowestIdentifier;
+    if (index >= 0 && static_cast<size_t>(index) < table.size()) {
+        return AnalyzerRef(kinds[index], table[index]);
+    }
+    return AnalyzerRef();
+}
+
 size_t Vector::size() {
     size_t result = 0;
     for (const auto& current : table) {
@@ -82,7 +104,10 @@ size_t Vector::size() {
 
 void Vector::clear() {
     freeAnalyzers();
-    table.clear();
+    // Back to the state of the constructor, registerAnalyzer relies on the single empty slot
+    table.assign(1, nullptr);
+    kinds.assign(1, AnalyzerKind::UNKNOWN);
+    lowestIdentifier = 0;
 }
 
 void Vector::stringifyAnalyzersState(std::ostream &os) const {
@@ -95,7 +120,7 @@ void Vector::stringifyAnalyzersState(std::ostream &os) const {
 
 void Vector::freeAnalyzers() {
     for (auto &current : table) {
-        delete current;
+        freeAnalyzer(current);
         current = nullptr;
     }
 }
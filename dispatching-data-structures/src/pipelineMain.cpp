@@ -0,0 +1,156 @@
+#include <iostream>
+#include <thread>
+
+#include "dispatchers/All.h"
+#include "InputReader.h"
+#include "Pipeline.h"
+#include "Timing.h"
+
+#define addDispatcher(dispatcher, target) target.emplace_back(#dispatcher, Pipeline::dispatcher_factory([] { return std::make_unique<dispatcher>(); }))
+
+using named_factories = std::vector<std::pair<std::string, Pipeline::dispatcher_factory>>;
+
+double framesPerSecond(uint64_t frames, uint64_t time) {
+    return time == 0 ? 0 : frames * 1e9 / time;
+}
+
+void printStage(const std::string &name, const std::string &stage, const StageStatistics &statistics) {
+    double meanOccupancy = statistics.occupancySamples == 0 ? 0 :
+                           static_cast<double>(statistics.occupancySum) / statistics.occupancySamples;
+    std::cout << name << "," << stage << "," << statistics.frames << "," << statistics.lookups << ","
+              << statistics.time << "," << statistics.busyTime << ","
+              << framesPerSecond(statistics.frames, statistics.busyTime) << "," << meanOccupancy << ","
+              << statistics.maxOccupancy << "," << statistics.drops << "," << statistics.stallTime << ","
+              << statistics.stolen << "\n";
+}
+
+void runPipeline(const std::string &name, const PipelineConfig &config, const Pipeline::dispatcher_factory &factory,
+                 const std::map<identifier_t, analyzer_builder> &analyzerBuilders, const PacketBatch &frames,
+                 bool timers) {
+    Pipeline pipeline(config, factory, analyzerBuilders);
+    Timing::reset();
+    uint64_t time = pipeline.run(frames);
+    if (timers) {
+        Timing::toCSV(name);
+        Timing::toJSON(name);
+    }
+
+    const StageStatistics &reader = pipeline.getReaderStatistics();
+    printStage(name, "reader", reader);
+
+    StageStatistics total;
+    total.drops = reader.drops;
+    total.stallTime = reader.stallTime;
+    for (size_t i = 0; i < pipeline.getWorkerStatistics().size(); i++) {
+        const StageStatistics &worker = pipeline.getWorkerStatistics()[i];
+        printStage(name, "worker" + std::to_string(i), worker);
+        total.frames += worker.frames;
+        total.lookups += worker.lookups;
+        total.stolen += worker.stolen;
+        total.occupancySum += worker.occupancySum;
+        total.occupancySamples += worker.occupancySamples;
+        total.maxOccupancy = std::max(total.maxOccupancy, worker.maxOccupancy);
+    }
+    total.time = time;
+    total.busyTime = time;
+    printStage(name, "pipeline", total);
+}
+
+// Runs the frames of a trace through a pipeline of one reader and N workers for every dispatcher (see Pipeline).
+// A worker that is busy most of the time while the reader stalls shows that dispatching is the bottleneck, a reader
+// that is busy while the workers idle with empty rings shows that distributing the frames is.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Path to packet file missing." << std::endl;
+        return 1;
+    } else if (argc < 3) {
+        std::cerr << "Path to analyzer file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keywords: "workers=<N>" sets the number of workers, "ring=<N>" the frames per ring, "batch=<N>" the
+    // frames per enqueue and dequeue, "drop" drops frames when a ring is full and "pin" pins every stage to a core.
+    // "steal" adds a run with work stealing for every dispatcher, "unordered" lets it reorder the frames of a flow.
+    // "timers" enables the instrumentation timers and writes them for every run to benchmark_<name>.csv and
+    // benchmark_<name>.json, without it the dispatch of a frame is not timed.
+    PipelineConfig config;
+    bool steal = false;
+    bool timers = false;
+    config.workerCount = std::max(2u, std::thread::hardware_concurrency()) - 1;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option.substr(0, 8) == "workers=") {
+            config.workerCount = std::stoul(option.substr(8));
+        } else if (option.substr(0, 5) == "ring=") {
+            config.ringSize = std::stoul(option.substr(5));
+        } else if (option.substr(0, 6) == "batch=") {
+            config.batchSize = std::stoul(option.substr(6));
+        } else if (option == "drop") {
+            config.drop = true;
+        } else if (option == "pin") {
+            config.pin = true;
+        } else if (option == "steal") {
+            steal = true;
+        } else if (option == "unordered") {
+            config.ordered = false;
+        } else if (option == "timers") {
+            timers = true;
+        }
+    }
+    Timing::setEnabled(timers);
+
+    PacketBatch frames;
+    std::map<identifier_t, analyzer_builder> analyzerBuilders;
+    try {
+        frames = InputReader::readFrames(argv[1]);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error reading packet file: " << e.what() << std::endl;
+        return 1;
+    }
+    try {
+        analyzerBuilders = InputReader::readAnalyzerFile(argv[2]);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error reading analyzer file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    named_factories dispatchers;
+    addDispatcher(Array, dispatchers);
+    addDispatcher(Vector, dispatchers);
+    addDispatcher(TreeMap, dispatchers);
+    addDispatcher(UnorderedMap, dispatchers);
+    addDispatcher(Cuckoo, dispatchers);
+    addDispatcher(Hanov, dispatchers);
+    addDispatcher(Universal, dispatchers);
+    addDispatcher(SparseUpper, dispatchers);
+
+    // Fragmented tests
+    if (std::string(argv[2]).find("fragmented") != std::string::npos) {
+        addDispatcher(GeneratedSwitchFragmented, dispatchers);
+        addDispatcher(GeneratedIfFragmented, dispatchers);
+    }
+
+    // Zeek default mapping tests
+    if (std::string(argv[2]).find("zeek") != std::string::npos) {
+        addDispatcher(GeneratedSwitchZeek, dispatchers);
+        addDispatcher(GeneratedIfZeek, dispatchers);
+    }
+
+    // One row per stage and one for the whole pipeline per dispatcher. The throughput of a stage is relative to the
+    // time it was busy, that of the pipeline relative to the time until the last worker finished.
+    std::cout << "name,stage,frames,lookups,ns,busy_ns,frames_per_s,mean_occupancy,max_occupancy,drops,stall_ns,stolen" << std::endl;
+    PipelineConfig stealConfig = config;
+    stealConfig.steal = true;
+    for (const auto &dispatcher : dispatchers) {
+        try {
+            runPipeline(dispatcher.first, config, dispatcher.second, analyzerBuilders, frames, timers);
+            if (steal) {
+                runPipeline(dispatcher.first + "+stealing", stealConfig, dispatcher.second, analyzerBuilders, frames, timers);
+            }
+        } catch (std::invalid_argument &e) {
+            std::cerr << e.what() << std::endl;
+            return 1;
+        }
+    }
+    std::cout << std::flush;
+}
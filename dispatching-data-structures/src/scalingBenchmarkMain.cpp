@@ -0,0 +1,333 @@
+#include <atomic>
+#include <chrono>
+#include <iostream>
+#include <pthread.h>
+#include <set>
+#include <thread>
+
+#include "analyzers/AnalyzerReplicas.h"
+#include "dispatchers/All.h"
+#include "InputReader.h"
+
+#define addDispatcher(dispatcher, target) target.emplace_back(#dispatcher, std::make_unique<dispatcher>())
+
+#define CACHE_LINE_SIZE 64
+
+using named_dispatchers = std::vector<std::pair<std::string, std::unique_ptr<IDispatcher>>>;
+
+// Result of one thread, aligned so the threads do not write to the same cache line
+struct alignas(CACHE_LINE_SIZE) ThreadResult {
+    uint64_t lookups = 0;
+    uint64_t hits = 0;
+    uint64_t time = 0;
+};
+
+// Dispatches the packets [begin, end) and counts the lookups that found an analyzer. With replicas, the thread invokes
+// its own replica of every analyzer instead of the shared one.
+void dispatchPartition(IDispatcher &dispatcher, const PacketBatch &packets, size_t begin, size_t end, bool invoke,
+                       const AnalyzerReplicas *replicas, size_t thread, ThreadResult &result) {
+    uint64_t hits = 0;
+    if (invoke && replicas != nullptr) {
+        for (size_t i = begin; i < end; i++) {
+            PacketView packet = packets[i];
+            for (const auto &identifier : packet.getIdentifiers()) {
+                IAnalyzer *analyzer = dispatcher.lookup(identifier);
+                if (analyzer != nullptr) {
+                    replicas->get(thread, analyzer)->analyze(packet);
+                    hits++;
+                }
+            }
+        }
+    } else if (invoke) {
+        for (size_t i = begin; i < end; i++) {
+            PacketView packet = packets[i];
+            for (const auto &identifier : packet.getIdentifiers()) {
+                IAnalyzer *analyzer = dispatcher.lookup(identifier);
+                if (analyzer != nullptr) {
+                    analyzer->analyze(packet);
+                    hits++;
+                }
+            }
+        }
+    } else if (begin < end) {
+        // Walk the flat identifier array of the partition
+        const identifier_t *identifier = packets[begin].getIdentifiers().begin();
+        const identifier_t *last = packets[end - 1].getIdentifiers().end();
+        for (; identifier != last; identifier++) {
+            hits += dispatcher.lookup(*identifier) != nullptr;
+        }
+    }
+
+    result.hits = hits;
+    result.lookups = packets[end - 1].getIdentifiers().end() - packets[begin].getIdentifiers().begin();
+}
+
+// Distinct analyzers registered in the dispatcher
+std::set<IAnalyzer *> collectAnalyzers(IDispatcher &dispatcher, const std::map<identifier_t, analyzer_builder> &analyzerBuilders) {
+    std::set<IAnalyzer *> analyzers;
+    for (const auto &builder : analyzerBuilders) {
+        IAnalyzer *analyzer = dispatcher.lookup(builder.first);
+        if (analyzer != nullptr) {
+            analyzers.insert(analyzer);
+        }
+    }
+    return analyzers;
+}
+
+// Sum of the counters of the shared analyzers, or with replicas of the snapshot of all replicas
+uint64_t sumCounters(const std::set<IAnalyzer *> &analyzers, const AnalyzerReplicas *replicas) {
+    uint64_t sum = 0;
+    if (replicas != nullptr) {
+        for (const auto &analyzer : replicas->snapshot()) {
+            sum += analyzer->getCounter();
+        }
+        return sum;
+    }
+
+    for (const auto &analyzer : analyzers) {
+        sum += analyzer->getCounter();
+    }
+    return sum;
+}
+
+/**
+ * Counts the analyzers that start in the same cache line as another analyzer. Threads updating the counters of such
+ * analyzers contend for the line even if they never use the same analyzer (false sharing).
+ */
+size_t countSharedLines(const std::set<IAnalyzer *> &analyzers) {
+    std::map<uintptr_t, size_t> lines;
+    for (const auto &analyzer : analyzers) {
+        lines[reinterpret_cast<uintptr_t>(analyzer) / CACHE_LINE_SIZE]++;
+    }
+
+    size_t shared = 0;
+    for (const auto &line : lines) {
+        if (line.second > 1) {
+            shared += line.second;
+        }
+    }
+    return shared;
+}
+
+/**
+ * Counts the replicas that start in the same cache line as a replica of another worker, the replicas of one worker
+ * may share lines without contention.
+ */
+size_t countSharedLines(const AnalyzerReplicas &replicas) {
+    std::map<uintptr_t, std::set<size_t>> lines;
+    for (size_t worker = 0; worker < replicas.workerCount(); worker++) {
+        for (const auto &prototype : replicas.getPrototypes()) {
+            lines[reinterpret_cast<uintptr_t>(replicas.get(worker, prototype)) / CACHE_LINE_SIZE].insert(worker);
+        }
+    }
+
+    size_t shared = 0;
+    for (const auto &line : lines) {
+        if (line.second.size() > 1) {
+            shared++;
+        }
+    }
+    return shared;
+}
+
+/**
+ * Runs the threads on equally sized partitions of the trace against the same dispatcher. All threads wait for a
+ * common start signal, so they dispatch concurrently.
+ */
+std::vector<ThreadResult> run(IDispatcher &dispatcher, const PacketBatch &packets, size_t threadCount, bool invoke,
+                              const AnalyzerReplicas *replicas, bool pin) {
+    std::vector<ThreadResult> results(threadCount);
+    std::atomic<size_t> waiting(0);
+    std::atomic<bool> start(false);
+
+    std::vector<std::thread> threads;
+    for (size_t i = 0; i < threadCount; i++) {
+        size_t begin = packets.size() * i / threadCount;
+        size_t end = packets.size() * (i + 1) / threadCount;
+        threads.emplace_back([&, i, begin, end] {
+            waiting++;
+            while (!start.load(std::memory_order_acquire)) {
+            }
+
+            auto startTime = std::chrono::steady_clock::now();
+            dispatchPartition(dispatcher, packets, begin, end, invoke, replicas, i, results[i]);
+            results[i].time = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - startTime).count();
+        });
+
+        if (pin) {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            CPU_SET(i % std::thread::hardware_concurrency(), &cpus);
+            pthread_setaffinity_np(threads.back().native_handle(), sizeof(cpus), &cpus);
+        }
+    }
+
+    while (waiting.load() < threadCount) {
+        std::this_thread::yield();
+    }
+    start.store(true, std::memory_order_release);
+
+    for (auto &thread : threads) {
+        thread.join();
+    }
+    return results;
+}
+
+double lookupsPerSecond(uint64_t lookups, uint64_t time) {
+    return time == 0 ? 0 : lookups * 1e9 / time;
+}
+
+// Measures every thread count from 1 to maxThreads and prints the rows of the dispatcher
+void measure(const std::string &name, IDispatcher &dispatcher, const PacketBatch &packets,
+             const std::set<IAnalyzer *> &analyzers, const AnalyzerReplicas *replicas, size_t maxThreads,
+             size_t repeatCount, bool invoke, bool pin) {
+    size_t sharedLines = replicas == nullptr ? countSharedLines(analyzers) : countSharedLines(*replicas);
+
+    double baseline = 0;
+    for (size_t threadCount = 1; threadCount <= maxThreads; threadCount++) {
+        std::vector<ThreadResult> best;
+        uint64_t bestTime = 0;
+        uint64_t lostUpdates = 0;
+        for (size_t repeat = 0; repeat < repeatCount; repeat++) {
+            uint64_t countersBefore = sumCounters(analyzers, replicas);
+            std::vector<ThreadResult> results = run(dispatcher, packets, threadCount, invoke, replicas, pin);
+            uint64_t counted = sumCounters(analyzers, replicas) - countersBefore;
+
+            // The slowest thread determines the time of the run
+            uint64_t time = 0;
+            uint64_t hits = 0;
+            for (const auto &result : results) {
+                time = std::max(time, result.time);
+                hits += result.hits;
+            }
+            if (invoke) {
+                lostUpdates += hits - counted;
+            }
+            if (best.empty() || time < bestTime) {
+                best = results;
+                bestTime = time;
+            }
+        }
+
+        double aggregate = lookupsPerSecond(packets.identifierCount(), bestTime);
+        if (threadCount == 1) {
+            baseline = aggregate;
+        }
+        for (size_t i = 0; i < best.size(); i++) {
+            std::cout << name << "," << threadCount << "," << i << "," << best[i].lookups << ","
+                      << best[i].time << "," << lookupsPerSecond(best[i].lookups, best[i].time) << ",,,\n";
+        }
+        std::cout << name << "," << threadCount << ",all," << packets.identifierCount() << ","
+                  << bestTime << "," << aggregate << "," << aggregate / (baseline * threadCount) << ","
+                  << lostUpdates << "," << sharedLines << std::endl;
+    }
+}
+
+// Dispatches the trace with 1 to N threads that share one dispatcher, to measure how well every structure scales.
+// The dispatchers are filled before the threads start and are only read by them. With "invoke", the threads also
+// update the counters of the shared analyzers without synchronization, the lost updates show the resulting races.
+// "replicated" additionally runs every dispatcher with per thread replicas of the analyzers (see AnalyzerReplicas).
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Path to packet file missing." << std::endl;
+        return 1;
+    } else if (argc < 3) {
+        std::cerr << "Path to analyzer file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keywords: "threads=<N>" sets the maximum thread count, "repeats=<N>" the runs per thread count (the
+    // fastest is reported), "pin" pins thread i to core i, "invoke" also calls the analyzers, "replicated" adds runs
+    // with per thread analyzers and "work=<counter|header|bytes:N>" sets the work every analyzer does per PDU
+    size_t maxThreads = std::max(1u, std::thread::hardware_concurrency());
+    size_t repeatCount = 3;
+    bool pin = false;
+    bool invoke = false;
+    bool replicated = false;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option.substr(0, 8) == "threads=") {
+            maxThreads = std::max(1ul, std::stoul(option.substr(8)));
+        } else if (option.substr(0, 8) == "repeats=") {
+            repeatCount = std::max(1ul, std::stoul(option.substr(8)));
+        } else if (option == "pin") {
+            pin = true;
+        } else if (option == "invoke") {
+            invoke = true;
+        } else if (option == "replicated") {
+            replicated = true;
+        } else if (option.substr(0, 5) == "work=") {
+            try {
+                IAnalyzer::setWorkload(AnalyzerWorkload::parse(option.substr(5)));
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    PacketBatch packets;
+    std::map<identifier_t, analyzer_builder> analyzerBuilders;
+    try {
+        packets = InputReader::readPacketFile(argv[1]);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error reading packet file: " << e.what() << std::endl;
+        return 1;
+    }
+    try {
+        analyzerBuilders = InputReader::readAnalyzerFile(argv[2]);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error reading analyzer file: " << e.what() << std::endl;
+        return 1;
+    }
+    if (replicated && !invoke) {
+        std::cerr << "The replicated keyword requires invoke." << std::endl;
+        return 1;
+    } else if (packets.empty()) {
+        std::cerr << "Packet file contains no packets." << std::endl;
+        return 1;
+    }
+    maxThreads = std::min(maxThreads, packets.size());
+
+    named_dispatchers dispatchers;
+    addDispatcher(Array, dispatchers);
+    addDispatcher(Vector, dispatchers);
+    addDispatcher(TreeMap, dispatchers);
+    addDispatcher(UnorderedMap, dispatchers);
+    addDispatcher(Cuckoo, dispatchers);
+    addDispatcher(Hanov, dispatchers);
+    addDispatcher(Universal, dispatchers);
+    addDispatcher(SparseUpper, dispatchers);
+
+    // Fragmented tests
+    if (std::string(argv[2]).find("fragmented") != std::string::npos) {
+        addDispatcher(GeneratedSwitchFragmented, dispatchers);
+        addDispatcher(GeneratedIfFragmented, dispatchers);
+    }
+
+    // Zeek default mapping tests
+    if (std::string(argv[2]).find("zeek") != std::string::npos) {
+        addDispatcher(GeneratedSwitchZeek, dispatchers);
+        addDispatcher(GeneratedIfZeek, dispatchers);
+    }
+
+    // One row per thread and one aggregate row ("all") per dispatcher and thread count. The efficiency is the
+    // throughput relative to the single threaded run times the thread count, lost updates are analyzer counter
+    // increments that disappeared because threads raced on the same analyzer.
+    std::cout << "name,threads,thread,lookups,ns,lookups_per_s,efficiency,lost_updates,shared_lines" << std::endl;
+    for (auto &dispatcher : dispatchers) {
+        dispatcher.second->registerAnalyzers(analyzerBuilders);
+        std::set<IAnalyzer *> analyzers = collectAnalyzers(*dispatcher.second, analyzerBuilders);
+        measure(dispatcher.first, *dispatcher.second, packets, analyzers, nullptr, maxThreads, repeatCount, invoke, pin);
+
+        // Replicas for the maximum thread count, runs with fewer threads leave the rest untouched
+        if (replicated) {
+            AnalyzerReplicas replicas(*dispatcher.second, analyzerBuilders, maxThreads);
+            measure(dispatcher.first + "+replicated", *dispatcher.second, packets, analyzers, &replicas, maxThreads,
+                    repeatCount, invoke, pin);
+        }
+
+        dispatcher.second->clear();
+    }
+}
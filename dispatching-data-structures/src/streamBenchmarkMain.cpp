@@ -0,0 +1,117 @@
+#include <chrono>
+#include <iostream>
+
+#include "dispatchers/All.h"
+#include "InputReader.h"
+#include "TraceStream.h"
+
+#define addDispatcher(dispatcher, target) target.emplace_back(#dispatcher, std::make_unique<dispatcher>())
+
+using named_dispatchers = std::vector<std::pair<std::string, std::unique_ptr<IDispatcher>>>;
+
+uint64_t dispatch(IDispatcher &dispatcher, const PacketBatch &packets, bool invoke) {
+    auto start = std::chrono::steady_clock::now();
+    if (invoke) {
+        for (const auto &packet : packets) {
+            for (const auto &identifier : packet.getIdentifiers()) {
+                IAnalyzer *analyzer = dispatcher.lookup(identifier);
+                if (analyzer != nullptr) {
+                    analyzer->analyze(packet);
+                }
+            }
+        }
+    } else {
+        for (const auto &identifier : packets.getIdentifiers()) {
+            dispatcher.lookup(identifier);
+        }
+    }
+
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Streams a packet file through all dispatchers chunk by chunk, so traces larger than the memory can be measured.
+// Every chunk is dispatched by each dispatcher in turn while the next chunk is read in the background.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Path to packet file missing." << std::endl;
+        return 1;
+    } else if (argc < 3) {
+        std::cerr << "Path to analyzer file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keywords: "invoke" also calls the analyzers, "chunk=<N>" sets the packets per chunk,
+    // "work=<counter|header|bytes:N>" sets the work every analyzer does per PDU
+    bool invoke = false;
+    size_t chunkSize = TRACE_STREAM_DEFAULT_CHUNK_SIZE;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option == "invoke") {
+            invoke = true;
+        } else if (option.substr(0, 6) == "chunk=") {
+            chunkSize = std::stoul(option.substr(6));
+        } else if (option.substr(0, 5) == "work=") {
+            try {
+                IAnalyzer::setWorkload(AnalyzerWorkload::parse(option.substr(5)));
+            } catch (std::exception &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+        }
+    }
+
+    std::map<identifier_t, analyzer_builder> analyzerBuilders;
+    try {
+        analyzerBuilders = InputReader::readAnalyzerFile(argv[2]);
+    } catch (std::exception &e) {
+        std::cerr << "Error reading analyzer file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    named_dispatchers dispatchers;
+    addDispatcher(Array, dispatchers);
+    addDispatcher(Vector, dispatchers);
+    addDispatcher(TreeMap, dispatchers);
+    addDispatcher(UnorderedMap, dispatchers);
+    addDispatcher(Cuckoo, dispatchers);
+    addDispatcher(Hanov, dispatchers);
+    addDispatcher(Universal, dispatchers);
+    addDispatcher(SparseUpper, dispatchers);
+
+    // Fragmented tests
+    if (std::string(argv[2]).find("fragmented") != std::string::npos) {
+        addDispatcher(GeneratedSwitchFragmented, dispatchers);
+        addDispatcher(GeneratedIfFragmented, dispatchers);
+    }
+
+    // Zeek default mapping tests
+    if (std::string(argv[2]).find("zeek") != std::string::npos) {
+        addDispatcher(GeneratedSwitchZeek, dispatchers);
+        addDispatcher(GeneratedIfZeek, dispatchers);
+    }
+
+    for (auto &dispatcher : dispatchers) {
+        dispatcher.second->registerAnalyzers(analyzerBuilders);
+    }
+
+    std::cout << "name,chunk,packets,identifiers,read_ns,wait_ns,dispatch_ns" << std::endl;
+    try {
+        TraceStream stream(argv[1], chunkSize);
+        size_t chunk = 0;
+        while (const PacketBatch *packets = stream.next()) {
+            for (auto &dispatcher : dispatchers) {
+                uint64_t time = dispatch(*dispatcher.second, *packets, invoke);
+                std::cout << dispatcher.first << "," << chunk << "," << packets->size() << "," << packets->identifierCount()
+                          << "," << stream.getReadTime() << "," << stream.getWaitTime() << "," << time << "\n";
+            }
+            chunk++;
+        }
+    } catch (std::exception &e) {
+        std::cerr << "Error reading packet file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    for (auto &dispatcher : dispatchers) {
+        dispatcher.second->clear();
+    }
+}
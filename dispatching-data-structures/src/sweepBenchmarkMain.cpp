@@ -0,0 +1,253 @@
+#include <algorithm>
+#include <chrono>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <random>
+
+#include "dispatchers/All.h"
+#include "TraceGenerator.h"
+
+#define addDispatcher(dispatcher, target) target.emplace_back(#dispatcher, dispatcher_factory([] { return std::make_unique<dispatcher>(); }))
+
+// Consecutive identifiers per cluster of the clustered layout
+#define SWEEP_CLUSTER_SIZE 16
+
+// Seed of the fragmented and clustered layouts, so every run sweeps the same mappings
+#define SWEEP_SEED 0x5eed5eed5eed5eedull
+
+using dispatcher_factory = std::function<std::unique_ptr<IDispatcher>()>;
+using named_factories = std::vector<std::pair<std::string, dispatcher_factory>>;
+
+// Comma separated list of values, e.g. "1,16,256"
+template<class T>
+std::vector<T> parseList(const std::string &list, T (*parse)(const std::string &)) {
+    std::vector<T> values;
+    size_t position = 0;
+    while (position <= list.size()) {
+        size_t end = std::min(list.find(',', position), list.size());
+        values.push_back(parse(list.substr(position, end - position)));
+        position = end + 1;
+    }
+    return values;
+}
+
+size_t parseCount(const std::string &value) {
+    return std::stoul(value, nullptr, 0);
+}
+
+double parseFraction(const std::string &value) {
+    return std::stod(value);
+}
+
+std::string parseName(const std::string &value) {
+    return value;
+}
+
+// First count identifiers of a random permutation of [0, space)
+std::vector<identifier_t> sample(size_t count, size_t space, std::mt19937_64 &random) {
+    std::vector<identifier_t> values(space);
+    std::iota(values.begin(), values.end(), 0);
+    for (size_t i = 0; i < count; i++) {
+        std::swap(values[i], values[i + random() % (space - i)]);
+    }
+    values.resize(count);
+    return values;
+}
+
+/**
+ * Identifiers of a mapping with the given layout, like the mappings of gen_analyzer.py: "dense" takes [0, count),
+ * "chunked" spreads them evenly over the identifier space, "fragmented" samples them randomly from it and "clustered"
+ * places runs of SWEEP_CLUSTER_SIZE consecutive identifiers at random positions.
+ */
+std::vector<identifier_t> generateMapping(const std::string &layout, size_t count) {
+    std::mt19937_64 random(SWEEP_SEED);
+    std::vector<identifier_t> identifiers;
+    if (layout == "dense") {
+        identifiers.resize(count);
+        std::iota(identifiers.begin(), identifiers.end(), 0);
+    } else if (layout == "chunked") {
+        // Centered in count equal chunks of the identifier space, distinct for every count up to MAX_IDENTIFIERS
+        for (size_t i = 0; i < count; i++) {
+            identifiers.push_back(static_cast<identifier_t>(i * MAX_IDENTIFIERS / count + MAX_IDENTIFIERS / (2 * count)));
+        }
+    } else if (layout == "fragmented") {
+        identifiers = sample(count, MAX_IDENTIFIERS, random);
+    } else if (layout == "clustered") {
+        size_t clusterCount = (count + SWEEP_CLUSTER_SIZE - 1) / SWEEP_CLUSTER_SIZE;
+        for (const auto &cluster : sample(clusterCount, MAX_IDENTIFIERS / SWEEP_CLUSTER_SIZE, random)) {
+            for (size_t i = 0; i < SWEEP_CLUSTER_SIZE && identifiers.size() < count; i++) {
+                identifiers.push_back(static_cast<identifier_t>(cluster * SWEEP_CLUSTER_SIZE + i));
+            }
+        }
+    } else {
+        throw std::invalid_argument("Invalid layout " + layout + " (expected dense, chunked, fragmented or clustered).");
+    }
+    std::sort(identifiers.begin(), identifiers.end());
+    return identifiers;
+}
+
+uint64_t nanosecondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+// Startup, lookup time and size of one dispatcher at one point of the sweep, the times are the minimum of all repeats
+struct SweepResult {
+    uint64_t startup = std::numeric_limits<uint64_t>::max();
+    uint64_t lookups = std::numeric_limits<uint64_t>::max();
+    size_t bytes = 0;
+    size_t hits = 0;
+};
+
+SweepResult measure(IDispatcher &dispatcher, const std::map<identifier_t, analyzer_builder> &analyzerBuilders,
+                    const PacketBatch &trace, size_t repeats) {
+    SweepResult result;
+    for (size_t i = 0; i < repeats; i++) {
+        auto start = std::chrono::steady_clock::now();
+        dispatcher.registerAnalyzers(analyzerBuilders);
+        result.startup = std::min(result.startup, nanosecondsSince(start));
+        if (i + 1 < repeats) {
+            dispatcher.clear();
+        }
+    }
+    result.bytes = dispatcher.real_size();
+
+    ArrayView<identifier_t> identifiers = trace.getIdentifiers();
+    for (size_t i = 0; i < repeats; i++) {
+        size_t hits = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (const auto &identifier : identifiers) {
+            hits += dispatcher.lookup(identifier) != nullptr;
+        }
+        result.lookups = std::min(result.lookups, nanosecondsSince(start));
+        result.hits = hits;
+    }
+    dispatcher.clear();
+    return result;
+}
+
+// Sweeps every dispatcher over the number of analyzers, the layout of their identifiers, the fraction of lookups that
+// find an analyzer and the skew of the trace. Prints one CSV row per dispatcher and point, the surfaces of time per
+// lookup, memory and startup time show where the structures cross over.
+int main(int argc, char** argv) {
+    // Optional keywords, lists are comma separated: "analyzers=<N,...>" the mapping sizes (1 to 65536), "layouts=<L,...>"
+    // the key layouts, "hits=<p,...>" the hit ratios, "skew=<s,...>" the Zipf exponents of the trace (0 is uniform),
+    // "lookups=<N>" the lookups per trace, "repeats=<N>" the repetitions of every measurement and "slots" adds the split
+    // and packed slot layouts of Hanov and Universal.
+    std::vector<size_t> analyzerCounts = {1, 4, 16, 64, 256, 1024, 4096, 16384, 65536};
+    std::vector<std::string> layouts = {"dense", "chunked", "fragmented", "clustered"};
+    std::vector<double> hitRatios = {1.0, 0.5};
+    std::vector<double> exponents = {0.0, 1.1};
+    size_t lookupCount = 1000000;
+    size_t repeats = 3;
+    bool slotLayouts = false;
+    try {
+        for (int i = 1; i < argc; i++) {
+            std::string option(argv[i]);
+            if (option.substr(0, 10) == "analyzers=") {
+                analyzerCounts = parseList(option.substr(10), parseCount);
+            } else if (option.substr(0, 8) == "layouts=") {
+                layouts = parseList(option.substr(8), parseName);
+            } else if (option.substr(0, 5) == "hits=") {
+                hitRatios = parseList(option.substr(5), parseFraction);
+            } else if (option.substr(0, 5) == "skew=") {
+                exponents = parseList(option.substr(5), parseFraction);
+            } else if (option.substr(0, 8) == "lookups=") {
+                lookupCount = std::stoul(option.substr(8));
+            } else if (option.substr(0, 8) == "repeats=") {
+                repeats = std::stoul(option.substr(8));
+            } else if (option == "slots") {
+                slotLayouts = true;
+            } else {
+                std::cerr << "Unknown option " << option << "." << std::endl;
+                return 1;
+            }
+        }
+    } catch (std::logic_error &e) {
+        std::cerr << "Invalid option value: " << e.what() << std::endl;
+        return 1;
+    }
+    if (lookupCount == 0 || repeats == 0) {
+        std::cerr << "lookups and repeats have to be positive." << std::endl;
+        return 1;
+    }
+    for (const auto &count : analyzerCounts) {
+        if (count == 0 || count > MAX_IDENTIFIERS) {
+            std::cerr << "The number of analyzers has to be between 1 and " << MAX_IDENTIFIERS << "." << std::endl;
+            return 1;
+        }
+    }
+
+    // The generated dispatchers are built for fixed mappings and cannot be swept
+    named_factories dispatchers;
+    addDispatcher(Array, dispatchers);
+    addDispatcher(Vector, dispatchers);
+    addDispatcher(TreeMap, dispatchers);
+    addDispatcher(UnorderedMap, dispatchers);
+    addDispatcher(Cuckoo, dispatchers);
+    addDispatcher(Hanov, dispatchers);
+    addDispatcher(Universal, dispatchers);
+    addDispatcher(SparseUpper, dispatchers);
+    if (slotLayouts) {
+        addDispatcher(HanovSplit, dispatchers);
+        addDispatcher(HanovPacked, dispatchers);
+        addDispatcher(UniversalSplit, dispatchers);
+        addDispatcher(UniversalPacked, dispatchers);
+    }
+
+    std::cout << "name,analyzers,layout,hits,skew,startup_ns,ns_per_lookup,bytes,observed_hits" << std::endl;
+    for (const auto &count : analyzerCounts) {
+        for (const auto &layout : layouts) {
+            std::vector<identifier_t> identifiers;
+            try {
+                identifiers = generateMapping(layout, count);
+            } catch (std::invalid_argument &e) {
+                std::cerr << e.what() << std::endl;
+                return 1;
+            }
+            std::map<identifier_t, analyzer_builder> analyzerBuilders;
+            for (const auto &identifier : identifiers) {
+                analyzerBuilders.emplace(identifier, MAKE_ANALYZER_BUILDER(UnknownAnalyzer));
+            }
+
+            for (const auto &hitRatio : hitRatios) {
+                for (const auto &exponent : exponents) {
+                    TraceGeneratorConfig config;
+                    config.model = TraceModel::ZIPF;
+                    config.pduCount = lookupCount;
+                    config.layerCount = 1;
+                    config.fromIdentifiers = identifiers;
+                    config.hitRatio = hitRatio;
+                    config.exponent = exponent;
+
+                    PacketBatch trace;
+                    try {
+                        trace = TraceGenerator(config).generate();
+                    } catch (std::invalid_argument &e) {
+                        // A mapping of the whole identifier space leaves nothing to miss, whatever the skew
+                        std::cerr << "Skipping " << count << " " << layout << " analyzers with hits=" << hitRatio
+                                  << ": " << e.what() << std::endl;
+                        break;
+                    }
+
+                    for (const auto &dispatcher : dispatchers) {
+                        SweepResult result;
+                        try {
+                            std::unique_ptr<IDispatcher> instance = dispatcher.second();
+                            result = measure(*instance, analyzerBuilders, trace, repeats);
+                        } catch (std::exception &e) {
+                            std::cerr << dispatcher.first << " failed for " << count << " " << layout
+                                      << " analyzers: " << e.what() << std::endl;
+                            continue;
+                        }
+                        std::cout << dispatcher.first << "," << count << "," << layout << "," << hitRatio << ","
+                                  << exponent << "," << result.startup << ","
+                                  << static_cast<double>(result.lookups) / trace.identifierCount() << ","
+                                  << result.bytes << ","
+                                  << static_cast<double>(result.hits) / trace.identifierCount() << std::endl;
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,40 @@
+#include <iostream>
+
+#include "InputReader.h"
+#include "TraceFile.h"
+
+// Converts a packet file into the binary trace format, which the applications map instead of parsing it.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Path to packet file missing." << std::endl;
+        return 1;
+    } else if (argc < 3) {
+        std::cerr << "Path to target file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keyword "stacks" adds the dictionary of distinct protocol stacks
+    bool withStacks = false;
+    for (int i = 3; i < argc; i++) {
+        if (std::string(argv[i]) == "stacks") {
+            withStacks = true;
+        }
+    }
+
+    PacketBatch packets;
+    try {
+        packets = InputReader::readPacketFile(argv[1]);
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error reading packet file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        TraceFile::write(argv[2], packets, withStacks);
+    } catch (std::exception &e) {
+        std::cerr << "Error writing trace file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Converted " << packets.size() << " packets with " << packets.identifierCount() << " identifiers." << std::endl;
+}
@@ -0,0 +1,87 @@
+#include <fstream>
+#include <iostream>
+
+#include "TraceFile.h"
+#include "TraceGenerator.h"
+
+static const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Writes the trace in the text format of gen_packet.py, identifiers and payload in hex
+void writeText(const std::string &path, const PacketBatch &packets) {
+    std::ofstream file(path, std::ofstream::out | std::ofstream::trunc);
+    if (!file.is_open()) {
+        throw std::invalid_argument("Could not open " + path + " for writing.");
+    }
+
+    file << "# PACKETS\n";
+    std::string line;
+    for (const auto &packet : packets) {
+        line.clear();
+        for (const auto &identifier : packet.getIdentifiers()) {
+            // Without leading zeros, like hex() in python
+            bool started = false;
+            for (int shift = sizeof(identifier_t) * 8 - 4; shift >= 0; shift -= 4) {
+                unsigned digit = (identifier >> shift) & 0xFu;
+                if (started || digit != 0 || shift == 0) {
+                    line.push_back(HEX_DIGITS[digit]);
+                    started = true;
+                }
+            }
+            line.push_back(' ');
+        }
+        for (const auto &byte : packet.getPayload()) {
+            line.push_back(HEX_DIGITS[byte >> 4u]);
+            line.push_back(HEX_DIGITS[byte & 0xFu]);
+        }
+        line.push_back('\n');
+        file.write(line.data(), line.size());
+    }
+
+    if (!file) {
+        throw std::runtime_error("Error while writing " + path + ".");
+    }
+}
+
+// Generates a synthetic trace (see TraceGeneratorConfig) and writes it as binary trace, or with "text" as text trace.
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        std::cerr << "Trace description missing (e.g. zipf:pdus=1000000,s=1.2)." << std::endl;
+        return 1;
+    } else if (argc < 3) {
+        std::cerr << "Path to target file missing." << std::endl;
+        return 1;
+    }
+
+    // Optional keywords: "text" writes the text format, "stacks" adds the stack dictionary to a binary trace
+    bool text = false;
+    bool withStacks = false;
+    for (int i = 3; i < argc; i++) {
+        std::string option(argv[i]);
+        if (option == "text") {
+            text = true;
+        } else if (option == "stacks") {
+            withStacks = true;
+        }
+    }
+
+    PacketBatch packets;
+    try {
+        packets = TraceGenerator(TraceGeneratorConfig::parse(argv[1])).generate();
+    } catch (std::invalid_argument &e) {
+        std::cerr << "Error generating trace: " << e.what() << std::endl;
+        return 1;
+    }
+
+    try {
+        if (text) {
+            writeText(argv[2], packets);
+        } else {
+            TraceFile::write(argv[2], packets, withStacks);
+        }
+    } catch (std::exception &e) {
+        std::cerr << "Error writing trace file: " << e.what() << std::endl;
+        return 1;
+    }
+
+    std::cout << "Generated " << packets.size() << " packets with " << packets.identifierCount() << " identifiers." << std::endl;
+}